@@ -9,6 +9,7 @@
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
+	serial_tx_flush();
 	printf("Put your restart handler here\n");
 
 #ifdef DEBUG
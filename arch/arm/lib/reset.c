@@ -29,6 +29,7 @@ __weak void reset_misc(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	puts ("resetting ...\n");
 
 	udelay (50000);				/* wait 50 ms */
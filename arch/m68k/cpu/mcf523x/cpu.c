@@ -23,6 +23,7 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	ccm_t *ccm = (ccm_t *) MMAP_CCM;
 
+	serial_tx_flush();
 	out_8(&ccm->rcr, CCM_RCR_SOFTRST);
 	/* we don't return! */
 	return 0;
@@ -29,6 +29,7 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	rcm_t *rcm = (rcm_t *)(MMAP_RCM);
 
+	serial_tx_flush();
 	udelay(1000);
 
 	out_8(&rcm->rcr, RCM_RCR_SOFTRST);
@@ -136,6 +137,8 @@ int checkcpu(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
+
 	/* Call the board specific reset actions first. */
 	if(board_reset) {
 		board_reset();
@@ -173,6 +176,7 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	wdog_t *wdp = (wdog_t *) (MMAP_WDOG);
 
+	serial_tx_flush();
 	out_be16(&wdp->wdog_wrrr, 0);
 	udelay(1000);
 
@@ -260,6 +264,7 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	rcm_t *rcm = (rcm_t *)(MMAP_RCM);
 
+	serial_tx_flush();
 	udelay(1000);
 
 	out_8(&rcm->rcr, RCM_RCR_SOFTRST);
@@ -345,6 +350,7 @@ int checkcpu(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	MCFRESET_RCR = MCFRESET_RCR_SOFTRST;
 	return 0;
 };
@@ -362,6 +368,8 @@ int checkcpu(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
+
 	/* enable watchdog, set timeout to 0 and wait */
 	mbar_writeByte(MCFSIM_SYPCR, 0xc0);
 	while (1) ;
@@ -392,6 +400,8 @@ int checkcpu(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
+
 	/* enable watchdog, set timeout to 0 and wait */
 	mbar_writeByte(SIM_SYPCR, 0xc0);
 	while (1) ;
@@ -14,6 +14,8 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	sim_t *sim = (sim_t *)(MMAP_SIM);
 
+	serial_tx_flush();
+
 	/* enable watchdog/reset, set timeout to 0 and wait */
 	out_8(&sim->sypcr, SYPCR_SWE | SYPCR_SWRI);
 
@@ -23,6 +23,7 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	rcm_t *rcm = (rcm_t *) (MMAP_RCM);
 
+	serial_tx_flush();
 	udelay(1000);
 	setbits_8(&rcm->rcr, RCM_RCR_SOFTRST);
 
@@ -22,6 +22,8 @@ DECLARE_GLOBAL_DATA_PTR;
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	rcm_t *rcm = (rcm_t *) (MMAP_RCM);
+
+	serial_tx_flush();
 	udelay(1000);
 	out_8(&rcm->rcr, RCM_RCR_FRCRSTOUT);
 	udelay(10000);
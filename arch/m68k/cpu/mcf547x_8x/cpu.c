@@ -23,6 +23,7 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	gptmr_t *gptmr = (gptmr_t *) (MMAP_GPTMR);
 
+	serial_tx_flush();
 	out_be16(&gptmr->pre, 10);
 	out_be16(&gptmr->cnt, 1);
 
@@ -22,6 +22,7 @@ void __weak _machine_restart(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	_machine_restart();
 
 	return 0;
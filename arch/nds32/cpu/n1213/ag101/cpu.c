@@ -46,6 +46,7 @@ int cleanup_before_linux(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	disable_interrupts();
 
 	/*
@@ -297,6 +297,8 @@ int do_reset (cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	defined(CONFIG_ARCH_MPC8555) || defined(CONFIG_ARCH_MPC8560)
 	unsigned long val, msr;
 
+	serial_tx_flush();
+
 	/*
 	 * Initiate hard reset in debug control register DBCR0
 	 * Make sure MSR[DE] = 1.  This only resets the core.
@@ -311,6 +313,8 @@ int do_reset (cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 #else
 	volatile ccsr_gur_t *gur = (void *)(CONFIG_SYS_MPC85xx_GUTS_ADDR);
 
+	serial_tx_flush();
+
 	/* Attempt board-specific reset */
 	board_reset();
 
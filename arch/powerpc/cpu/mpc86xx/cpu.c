@@ -109,6 +109,8 @@ int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	volatile immap_t *immap = (immap_t *)CONFIG_SYS_IMMR;
 	volatile ccsr_gur_t *gur = &immap->im_gur;
 
+	serial_tx_flush();
+
 	/* Attempt board-specific reset */
 	board_reset();
 
@@ -7,6 +7,7 @@
 #include <errno.h>
 #include <libfdt.h>
 #include <os.h>
+#include <profile.h>
 #include <asm/io.h>
 #include <asm/state.h>
 #include <dm/root.h>
@@ -138,3 +139,15 @@ done:
 
 	return 0;
 }
+
+#ifdef CONFIG_PROFILE
+int arch_profile_start(uint rate)
+{
+	return os_profile_start(rate, profile_sample);
+}
+
+void arch_profile_stop(void)
+{
+	os_profile_stop();
+}
+#endif
@@ -3,16 +3,21 @@
  * SPDX-License-Identifier:	GPL-2.0+
  */
 
+/* Needed for the register names in ucontext_t */
+#define _GNU_SOURCE
+
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <termios.h>
 #include <time.h>
+#include <ucontext.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -620,3 +625,61 @@ void os_localtime(struct rtc_time *rt)
 	rt->tm_yday = tm->tm_yday;
 	rt->tm_isdst = tm->tm_isdst;
 }
+
+/* Get the program counter from the context passed to a signal handler */
+#if defined(__x86_64__)
+#define OS_PROFILE_PC(uc)	((uc)->uc_mcontext.gregs[REG_RIP])
+#elif defined(__i386__)
+#define OS_PROFILE_PC(uc)	((uc)->uc_mcontext.gregs[REG_EIP])
+#elif defined(__aarch64__)
+#define OS_PROFILE_PC(uc)	((uc)->uc_mcontext.pc)
+#elif defined(__arm__)
+#define OS_PROFILE_PC(uc)	((uc)->uc_mcontext.arm_pc)
+#endif
+
+#ifdef OS_PROFILE_PC
+static void (*os_profile_func)(unsigned long pc);
+
+static void os_profile_handler(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+
+	os_profile_func(OS_PROFILE_PC(uc));
+}
+
+int os_profile_start(unsigned int rate, void (*func)(unsigned long pc))
+{
+	struct itimerval timer;
+	struct sigaction act;
+
+	os_profile_func = func;
+	memset(&act, '\0', sizeof(act));
+	act.sa_sigaction = os_profile_handler;
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGPROF, &act, NULL))
+		return -errno;
+
+	memset(&timer, '\0', sizeof(timer));
+	timer.it_interval.tv_usec = rate > 1000000 ? 1 : 1000000 / rate;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL))
+		return -errno;
+
+	return 0;
+}
+#else
+int os_profile_start(unsigned int rate, void (*func)(unsigned long pc))
+{
+	return -ENOSYS;
+}
+#endif
+
+void os_profile_stop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	signal(SIGPROF, SIG_IGN);
+}
@@ -97,8 +97,10 @@ int sandbox_main_loop_init(void)
 			retval = cli_simple_run_command("run distro_bootcmd",
 							0);
 #endif
-		if (!state->interactive)
+		if (!state->interactive) {
+			serial_tx_flush();
 			os_exit(retval);
+		}
 	}
 
 	return 0;
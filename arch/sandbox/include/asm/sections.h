@@ -13,6 +13,9 @@
 
 struct sandbox_cmdline_option;
 
+/* Start of the executable, provided by the host linker script */
+extern char __executable_start[];
+
 extern struct sandbox_cmdline_option *__u_boot_sandbox_option_start[],
 	*__u_boot_sandbox_option_end[];
 
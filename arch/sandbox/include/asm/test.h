@@ -48,6 +48,25 @@ void sandbox_i2c_eeprom_set_test_mode(struct udevice *dev,
 
 void sandbox_i2c_eeprom_set_offset_len(struct udevice *dev, int offset_len);
 
+/**
+ * sandbox_serial_set_busy() - make the uart refuse output, as if it is full
+ *
+ * @dev:	sandbox serial device to adjust
+ * @count:	number of following putc() calls which return -EAGAIN, or -1
+ *		to refuse all output
+ */
+void sandbox_serial_set_busy(struct udevice *dev, int count);
+
+/**
+ * sandbox_serial_capture() - collect the uart output instead of printing it
+ *
+ * @dev:	sandbox serial device to adjust
+ * @buf:	buffer to hold the output as a nul-terminated string, or NULL
+ *		to print the output again
+ * @size:	size of @buf in bytes
+ */
+void sandbox_serial_capture(struct udevice *dev, char *buf, int size);
+
 /*
  * sandbox_timer_add_offset()
  *
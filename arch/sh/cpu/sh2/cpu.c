@@ -48,6 +48,7 @@ int cleanup_before_linux(void)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	disable_interrupts();
 	reset_cpu(0);
 	return 0;
@@ -76,6 +76,7 @@ int init_cache(void) __attribute__((weak, alias("x86_init_cache")));
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	printf("resetting ...\n");
 
 	/* wait 50 ms */
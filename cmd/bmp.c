@@ -58,7 +58,7 @@ struct bmp_image *gunzip_bmp(unsigned long addr, unsigned long *lenp,
 	bmp = dst;
 
 	/* align to 32-bit-aligned-address + 2 */
-	bmp = (struct bmp_image *)((((unsigned int)dst + 1) & ~3) + 2);
+	bmp = (struct bmp_image *)((((uintptr_t)dst + 1) & ~3) + 2);
 
 	if (gunzip(bmp, CONFIG_SYS_VIDEO_LOGO_MAX_SIZE, map_sysmem(addr, 0),
 		   &len) != 0) {
@@ -234,14 +234,22 @@ int bmp_display(ulong addr, int x, int y)
 	struct bmp_image *bmp = map_sysmem(addr, 0);
 	void *bmp_alloc_addr = NULL;
 	unsigned long len;
+#if defined(CONFIG_DM_VIDEO) && defined(CONFIG_VIDEO_BMP_GZIP)
+	/* The video uclass decompresses gzipped images as it draws them */
+	bool use_gunzip = false;
+#else
+	bool use_gunzip = true;
+#endif
 
-	if (!((bmp->header.signature[0]=='B') &&
-	      (bmp->header.signature[1]=='M')))
+	bootstage_start(BOOTSTAGE_ID_ACCUM_SPLASH, "splash");
+	if (use_gunzip && !(bmp->header.signature[0] == 'B' &&
+			    bmp->header.signature[1] == 'M'))
 		bmp = gunzip_bmp(addr, &len, &bmp_alloc_addr);
 
 	if (!bmp) {
 		printf("There is no valid bmp file at the given address\n");
-		return 1;
+		ret = -EINVAL;
+		goto out;
 	}
 	addr = map_to_sysmem(bmp);
 
@@ -263,8 +271,10 @@ int bmp_display(ulong addr, int x, int y)
 # error bmp_display() requires CONFIG_LCD or CONFIG_VIDEO
 #endif
 
+out:
 	if (bmp_alloc_addr)
 		free(bmp_alloc_addr);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_SPLASH);
 
 	return ret ? CMD_RET_FAILURE : 0;
 }
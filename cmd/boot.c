@@ -33,6 +33,7 @@ static int do_go(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	addr = simple_strtoul(argv[1], NULL, 16);
 
 	printf ("## Starting application at 0x%08lX ...\n", addr);
+	serial_tx_flush();
 
 	/*
 	 * pass address parameter as argv[0] (aka command name),
@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <mapmem.h>
 
 static int do_bootstage_report(cmd_tbl_t *cmdtp, int flag, int argc,
 			       char * const argv[])
@@ -58,10 +59,51 @@ static int do_bootstage_stash(cmd_tbl_t *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_BOOTSTAGE_SPANS
+static int do_bootstage_spans(cmd_tbl_t *cmdtp, int flag, int argc,
+			      char * const argv[])
+{
+	bootstage_span_report();
+
+	return 0;
+}
+
+static int do_bootstage_json(cmd_tbl_t *cmdtp, int flag, int argc,
+			     char * const argv[])
+{
+	ulong base, size;
+	void *buf;
+	int len;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	base = simple_strtoul(argv[1], NULL, 16);
+	size = argc > 2 ? simple_strtoul(argv[2], NULL, 16) :
+		bootstage_span_json(NULL, 0) + 1;
+
+	buf = map_sysmem(base, size);
+	len = bootstage_span_json(buf, size);
+	unmap_sysmem(buf);
+	if (len >= size) {
+		printf("Trace needs %#x bytes, only %#lx available\n", len + 1,
+		       size);
+		return 1;
+	}
+	printf("%#x bytes written to %#lx\n", len, base);
+	setenv_hex("filesize", len);
+
+	return 0;
+}
+#endif
+
 static cmd_tbl_t cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+#ifdef CONFIG_BOOTSTAGE_SPANS
+	U_BOOT_CMD_MKENT(spans, 2, 1, do_bootstage_spans, "", ""),
+	U_BOOT_CMD_MKENT(json, 4, 0, do_bootstage_json, "", ""),
+#endif
 };
 
 /*
@@ -92,4 +134,8 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory"
+#ifdef CONFIG_BOOTSTAGE_SPANS
+	"\nspans                       - Print timed spans (probe, initcall, cmd)\n"
+	"json <addr> [<size>]        - Write spans in Chrome trace JSON format"
+#endif
 );
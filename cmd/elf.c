@@ -180,6 +180,7 @@ int do_bootelf(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		return rcode;
 
 	printf("## Starting application at 0x%08lx ...\n", addr);
+	serial_tx_flush();
 
 	/*
 	 * pass address parameter as argv[0] (aka command name),
@@ -370,6 +371,7 @@ int do_bootvx(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		puts("## Not an ELF image, assuming binary\n");
 
 	printf("## Starting vxWorks at 0x%08lx ...\n", addr);
+	serial_tx_flush();
 
 	dcache_disable();
 #ifdef CONFIG_X86
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <malloc_trace.h>
+
+/* Get the size of the free space which sbrk() has not handed out yet */
+static ulong malloc_unclaimed(void)
+{
+	return mem_malloc_end - mem_malloc_brk;
+}
+
+static int do_malloc_info(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	struct malloc_frag_info frag;
+	ulong claimed;
+
+	malloc_get_frag_info(&frag);
+	claimed = mem_malloc_brk - mem_malloc_start;
+	printf("Heap:     %#lx bytes at %08lx\n",
+	       mem_malloc_end - mem_malloc_start, mem_malloc_start);
+	printf("In use:   %#lx bytes\n", claimed - frag.free_bytes);
+	printf("Free:     %#lx bytes in %u chunks, %#lx at top, %#lx unclaimed\n",
+	       frag.free_bytes - frag.top_size, frag.free_chunks, frag.top_size,
+	       malloc_unclaimed());
+
+#ifdef CONFIG_SYS_MALLOC_SLAB
+	struct malloc_slab_info slab;
+	int i;
+
+	malloc_slab_get_info(&slab);
+	printf("Slabs:    %u of %u pages of %#x bytes in use, %lu fallbacks\n",
+	       slab.pages - slab.free_pages, slab.pages, slab.page_size,
+	       slab.fallbacks);
+	if (!slab.pages)
+		return 0;
+	printf("%8s %8s %8s %10s\n", "Size", "Pages", "In use", "Allocs");
+	for (i = 0; i < MALLOC_SLAB_CLASSES; i++) {
+		struct malloc_slab_class *cls = &slab.cls[i];
+
+		printf("%8u %8u %8u %10lu\n", cls->size, cls->pages,
+		       cls->inuse, cls->allocs);
+	}
+#endif
+
+	return 0;
+}
+
+static int do_malloc_frag(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	struct malloc_frag_info frag;
+	ulong total, largest;
+	int i;
+
+	malloc_get_frag_info(&frag);
+
+	/* The top chunk can grow into the unclaimed space */
+	total = frag.free_bytes + malloc_unclaimed();
+	largest = max(frag.largest, frag.top_size + malloc_unclaimed());
+	printf("Free:     %#lx bytes\n", total);
+	printf("Largest:  %#lx bytes", largest);
+	if (total)
+		printf(" (%lu%% fragmented)",
+		       (ulong)((u64)(total - largest) * 100 / total));
+	printf("\n");
+
+	if (!frag.free_chunks)
+		return 0;
+	printf("Free chunks by size:\n");
+	for (i = 0; i < MALLOC_FRAG_BUCKETS; i++) {
+		if (!frag.hist[i])
+			continue;
+		if (i == MALLOC_FRAG_BUCKETS - 1)
+			printf("%#10lx +           ", 16UL << i);
+		else
+			printf("%#10lx - %#-10lx", 16UL << i, (32UL << i) - 1);
+		printf(" %u\n", frag.hist[i]);
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_MALLOC_TRACE
+static int do_malloc_trace(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	ulong bytes;
+	int count;
+
+	count = malloc_trace_outstanding(0, argc > 1 ? argv[1] : NULL, true,
+					 &bytes);
+	if (count < 0) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	}
+	printf("%d allocations outstanding, %#lx bytes\n", count, bytes);
+
+	return 0;
+}
+
+static int do_malloc_scopes(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	const struct malloc_trace_scope *scope;
+	struct malloc_trace_stats stats;
+	int i;
+
+	printf("%-12s %10s %8s %10s %10s\n", "Scope", "Allocs", "Count",
+	       "Bytes", "Peak");
+	for (i = 0; (scope = malloc_trace_get_scope(i)); i++) {
+		printf("%-12s %10lu %8u %#10lx %#10lx\n", scope->name,
+		       scope->allocs, scope->count, scope->bytes, scope->peak);
+	}
+	malloc_trace_get_stats(&stats);
+	printf("%-12s %10lu %8u %#10lx %#10lx\n", "total", stats.allocs,
+	       stats.count, stats.bytes, stats.peak);
+	printf("devres: %u allocations, %#lx bytes\n", stats.devres_count,
+	       stats.devres_bytes);
+	if (stats.dropped)
+		printf("%lu allocations not tracked as the table was full\n",
+		       stats.dropped);
+
+	return 0;
+}
+
+static int do_malloc_check(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	struct malloc_trace_stats before, after;
+	ulong bytes;
+	uint mark;
+	int count;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/*
+	 * The first run may set up state which is kept on purpose, such as
+	 * a probed device or a cached parse, so only check the second
+	 */
+	if (run_command(argv[1], flag))
+		goto err_cmd;
+	mark = malloc_trace_mark();
+	malloc_trace_get_stats(&before);
+	if (run_command(argv[1], flag))
+		goto err_cmd;
+	malloc_trace_get_stats(&after);
+
+	/* An allocation which was not traced may be a leak we cannot see */
+	if (after.dropped != before.dropped) {
+		printf("%lu allocations not tracked as the table was full\n",
+		       after.dropped - before.dropped);
+		return CMD_RET_FAILURE;
+	}
+
+	count = malloc_trace_outstanding(mark, NULL, true, &bytes);
+	if (count < 0) {
+		printf("Out of memory\n");
+		return CMD_RET_FAILURE;
+	} else if (count) {
+		printf("Leaked %d allocations, %#lx bytes\n", count, bytes);
+		return CMD_RET_FAILURE;
+	}
+	printf("No leaks\n");
+
+	return 0;
+
+err_cmd:
+	printf("Command failed\n");
+	return CMD_RET_FAILURE;
+}
+#endif
+
+static cmd_tbl_t cmd_malloc_sub[] = {
+	U_BOOT_CMD_MKENT(info, 1, 1, do_malloc_info, "", ""),
+	U_BOOT_CMD_MKENT(frag, 1, 1, do_malloc_frag, "", ""),
+#ifdef CONFIG_MALLOC_TRACE
+	U_BOOT_CMD_MKENT(trace, 2, 1, do_malloc_trace, "", ""),
+	U_BOOT_CMD_MKENT(scopes, 1, 1, do_malloc_scopes, "", ""),
+	U_BOOT_CMD_MKENT(check, 2, 0, do_malloc_check, "", ""),
+#endif
+};
+
+static int do_malloc(cmd_tbl_t *cmdtp, int flag, int argc,
+		     char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading 'malloc' command argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_malloc_sub, ARRAY_SIZE(cmd_malloc_sub));
+	if (!c)
+		return CMD_RET_USAGE;
+
+	return c->cmd(cmdtp, flag, argc, argv);
+}
+
+U_BOOT_CMD(malloc, 3, 1, do_malloc,
+	"Show information about the malloc() heap",
+	"info              - Show how much of the heap is in use\n"
+	"malloc frag              - Show how the free space is split up"
+#ifdef CONFIG_MALLOC_TRACE
+	"\nmalloc trace [<scope>]   - Show outstanding allocations\n"
+	"malloc scopes            - Show heap use by each command\n"
+	"malloc check <command>   - Run a command twice, check the second\n"
+	"                           run frees everything it allocates"
+#endif
+);
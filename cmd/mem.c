@@ -20,6 +20,7 @@
 #ifdef CONFIG_HAS_DATAFLASH
 #include <dataflash.h>
 #endif
+#include <div64.h>
 #include <hash.h>
 #include <inttypes.h>
 #include <mapmem.h>
@@ -933,6 +934,241 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+#ifdef CONFIG_CMD_MEMTEST_SUITES
+/*
+ * Block-wise test suites. The area is handled in blocks of MTEST_BLOCK
+ * bytes: each block is written with plain word stores, then flushed from
+ * the data cache, so that reading it back checks the memory rather than
+ * the cache. The watchdog and ctrl-c are only looked at between blocks.
+ */
+#define MTEST_BLOCK	(1 << 20)
+
+/* Value generators */
+enum {
+	MTEST_WALK,		/* a single bit, moving with the address */
+	MTEST_ADDR,		/* the address of the word itself */
+	MTEST_PATTERN,		/* the pattern given to mtest */
+};
+
+/* Pass flags */
+#define MTEST_READ	BIT(0)	/* check each word against the generator */
+#define MTEST_WRITE	BIT(1)	/* then write the generator to it */
+#define MTEST_RINV	BIT(2)	/* the checked value is inverted */
+#define MTEST_WINV	BIT(3)	/* the written value is inverted */
+#define MTEST_DOWN	BIT(4)	/* walk the area from the top down */
+
+struct mtest_pass {
+	u8 gen;
+	u8 flags;
+};
+
+struct mtest_suite {
+	char name;
+	const char *desc;
+	int num_passes;
+	const struct mtest_pass *passes;
+};
+
+static const struct mtest_pass mtest_walk_passes[] = {
+	{ MTEST_WALK, MTEST_WRITE },
+	{ MTEST_WALK, MTEST_READ | MTEST_WRITE | MTEST_WINV },
+	{ MTEST_WALK, MTEST_READ | MTEST_RINV },
+};
+
+static const struct mtest_pass mtest_addr_passes[] = {
+	{ MTEST_ADDR, MTEST_WRITE },
+	{ MTEST_ADDR, MTEST_READ | MTEST_WRITE | MTEST_WINV },
+	{ MTEST_ADDR, MTEST_READ | MTEST_RINV },
+};
+
+/* MATS+ with a final read: up(w0); up(r0,w1); down(r1,w0); up(r0) */
+static const struct mtest_pass mtest_march_passes[] = {
+	{ MTEST_PATTERN, MTEST_WRITE },
+	{ MTEST_PATTERN, MTEST_READ | MTEST_WRITE | MTEST_WINV },
+	{ MTEST_PATTERN, MTEST_READ | MTEST_RINV | MTEST_WRITE | MTEST_DOWN },
+	{ MTEST_PATTERN, MTEST_READ },
+};
+
+static const struct mtest_suite mtest_suites[] = {
+	{ 'w', "walking bits", ARRAY_SIZE(mtest_walk_passes),
+		mtest_walk_passes },
+	{ 'a', "address in address", ARRAY_SIZE(mtest_addr_passes),
+		mtest_addr_passes },
+	{ 'm', "moving inversions", ARRAY_SIZE(mtest_march_passes),
+		mtest_march_passes },
+};
+
+struct mtest {
+	ulong *buf;		/* mapped start of the area */
+	ulong start;		/* bus address of the area */
+	ulong words;		/* size of the area */
+	ulong pattern;
+	ulong errs;
+	u64 bytes;		/* bytes read and written */
+};
+
+/* Value for the word @word words into the area */
+static ulong mtest_value(struct mtest *mt, int gen, ulong word)
+{
+	switch (gen) {
+	case MTEST_WALK:
+		return 1UL << (word % BITS_PER_LONG);
+	case MTEST_ADDR:
+		return mt->start + word * sizeof(ulong);
+	default:
+		return mt->pattern;
+	}
+}
+
+/* Value for the next word up, or down */
+static inline ulong mtest_next(ulong val, int gen, int down)
+{
+	switch (gen) {
+	case MTEST_WALK:
+		return down ? val >> 1 | val << (BITS_PER_LONG - 1) :
+			val << 1 | val >> (BITS_PER_LONG - 1);
+	case MTEST_ADDR:
+		return down ? val - sizeof(ulong) : val + sizeof(ulong);
+	default:
+		return val;
+	}
+}
+
+static void mtest_error(struct mtest *mt, ulong *p, ulong readback,
+			ulong expected)
+{
+	printf("\nMem error @ 0x%08lx: found %08lx, expected %08lx (bits %08lx)\n",
+	       mt->start + (p - mt->buf) * sizeof(ulong), readback, expected,
+	       readback ^ expected);
+	mt->errs++;
+}
+
+static int mtest_block(struct mtest *mt, const struct mtest_pass *pass,
+		       ulong first, ulong count)
+{
+	const int step = pass->flags & MTEST_DOWN ? -1 : 1;
+	ulong rinv = pass->flags & MTEST_RINV ? ~0UL : 0;
+	ulong winv = pass->flags & MTEST_WINV ? ~0UL : 0;
+	ulong *p, *end, val, readback;
+	int down = pass->flags & MTEST_DOWN;
+
+	p = mt->buf + first;
+	end = p + count;
+	if (down) {
+		swap(p, end);
+		p--;
+		end--;
+	}
+	val = mtest_value(mt, pass->gen, p - mt->buf);
+
+	/* Keep the loops free of tests which do not change per word */
+	switch (pass->flags & (MTEST_READ | MTEST_WRITE)) {
+	case MTEST_WRITE:
+		for (; p != end; p += step) {
+			*p = val ^ winv;
+			val = mtest_next(val, pass->gen, down);
+		}
+		break;
+	case MTEST_READ:
+		for (; p != end; p += step) {
+			readback = *p;
+			if (readback != (val ^ rinv)) {
+				mtest_error(mt, p, readback, val ^ rinv);
+				if (ctrlc())
+					return -1;
+			}
+			val = mtest_next(val, pass->gen, down);
+		}
+		break;
+	default:
+		for (; p != end; p += step) {
+			readback = *p;
+			if (readback != (val ^ rinv)) {
+				mtest_error(mt, p, readback, val ^ rinv);
+				if (ctrlc())
+					return -1;
+			}
+			*p = val ^ winv;
+			val = mtest_next(val, pass->gen, down);
+		}
+		break;
+	}
+
+	p = mt->buf + first;
+	if (pass->flags & MTEST_WRITE)
+		flush_dcache_range(round_down((ulong)p, ARCH_DMA_MINALIGN),
+				   ALIGN((ulong)(p + count), ARCH_DMA_MINALIGN));
+	mt->bytes += count * sizeof(ulong) *
+		(!!(pass->flags & MTEST_READ) + !!(pass->flags & MTEST_WRITE));
+
+	return 0;
+}
+
+static int mtest_pass(struct mtest *mt, const struct mtest_pass *pass)
+{
+	const ulong block = MTEST_BLOCK / sizeof(ulong);
+	ulong nblocks = DIV_ROUND_UP(mt->words, block);
+	ulong n, first;
+
+	for (n = 0; n < nblocks; n++) {
+		first = (pass->flags & MTEST_DOWN ? nblocks - 1 - n : n) *
+			block;
+		if (mtest_block(mt, pass, first,
+				min(block, mt->words - first)))
+			return -1;
+		WATCHDOG_RESET();
+		if (ctrlc())
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Run the suites named by the letters in @names, returning the number of
+ * errors or -1 if interrupted.
+ */
+static ulong mem_test_suites(vu_long *buf, ulong start_addr, ulong end_addr,
+			     ulong pattern, int iteration, const char *names)
+{
+	const struct mtest_suite *suite;
+	struct mtest mt = {
+		.buf = (ulong *)buf,
+		.start = start_addr,
+		.words = (end_addr - start_addr) / sizeof(ulong),
+		/* like the quick test, invert the pattern on odd iterations */
+		.pattern = iteration & 1 ? ~pattern : pattern,
+	};
+	char rate[24];
+	ulong start, ms;
+	int i;
+
+	start = get_timer(0);
+	for (; *names; names++) {
+		for (suite = mtest_suites;
+		     suite < mtest_suites + ARRAY_SIZE(mtest_suites); suite++)
+			if (suite->name == *names)
+				break;
+		if (suite == mtest_suites + ARRAY_SIZE(mtest_suites))
+			continue;
+
+		printf("\rIteration: %6d  %-20s", iteration + 1, suite->desc);
+		for (i = 0; i < suite->num_passes; i++)
+			if (mtest_pass(&mt, &suite->passes[i]))
+				return -1;
+	}
+
+	ms = get_timer(start);
+	if (ms) {
+		snprintf(rate, sizeof(rate), "%lu MB/s",
+			 (ulong)lldiv(mt.bytes, ms * 1000));
+		printf("\rIteration: %6d  %-20s", iteration + 1, rate);
+	}
+
+	return mt.errs;
+}
+#endif
+
 /*
  * Perform a memory test. A more complete alternative test can be
  * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
@@ -947,6 +1183,7 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 	int ret;
 	ulong errs = 0;	/* number of errors, or -1 if interrupted */
 	ulong pattern = 0;
+	const char *suites = NULL;
 	int iteration;
 #if defined(CONFIG_SYS_ALT_MEMTEST)
 	const int alt_test = 1;
@@ -973,6 +1210,14 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 		if (strict_strtoul(argv[4], 16, &iteration_limit) < 0)
 			return CMD_RET_USAGE;
 
+#ifdef CONFIG_CMD_MEMTEST_SUITES
+	if (argc > 5) {
+		suites = argv[5];
+		if (strspn(suites, "wam") != strlen(suites))
+			return CMD_RET_USAGE;
+	}
+#endif
+
 	if (end < start) {
 		printf("Refusing to do empty test\n");
 		return -1;
@@ -994,6 +1239,12 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
+#ifdef CONFIG_CMD_MEMTEST_SUITES
+		if (suites) {
+			errs = mem_test_suites(buf, start, end, pattern,
+					       iteration, suites);
+		} else
+#endif
 		if (alt_test) {
 			errs = mem_test_alt(buf, start, end, dummy);
 		} else {
@@ -1306,9 +1557,15 @@ U_BOOT_CMD(
 
 #ifdef CONFIG_CMD_MEMTEST
 U_BOOT_CMD(
-	mtest,	5,	1,	do_mem_mtest,
+	mtest,	6,	1,	do_mem_mtest,
 	"simple RAM read/write test",
+#ifdef CONFIG_CMD_MEMTEST_SUITES
+	"[start [end [pattern [iterations [suites]]]]]\n"
+	"    - suites: any of w (walking bits), a (address in address),\n"
+	"      m (moving inversions of pattern), run in the given order"
+#else
 	"[start [end [pattern [iterations]]]]"
+#endif
 );
 #endif	/* CONFIG_CMD_MEMTEST */
 
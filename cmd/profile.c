@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <errno.h>
+#include <mapmem.h>
+#include <profile.h>
+
+enum {
+	PROFILE_DEF_RATE	= 1000,		/* Hz */
+	PROFILE_DEF_SAMPLES	= 0x4000,
+	PROFILE_DEF_LINES	= 20,
+};
+
+static int do_profile_start(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	uint rate = PROFILE_DEF_RATE;
+	uint size = PROFILE_DEF_SAMPLES;
+	int ret;
+
+	if (argc > 1)
+		rate = simple_strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		size = simple_strtoul(argv[2], NULL, 16);
+	if (!rate || !size)
+		return CMD_RET_USAGE;
+
+	ret = profile_start(rate, size);
+	if (ret == -ENOSYS) {
+		printf("Sampling is not supported on this board\n");
+		return CMD_RET_FAILURE;
+	} else if (ret) {
+		printf("Cannot start profiler (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	profile_stop();
+
+	return 0;
+}
+
+static int do_profile_report(cmd_tbl_t *cmdtp, int flag, int argc,
+			     char * const argv[])
+{
+	int lines = PROFILE_DEF_LINES;
+
+	if (argc > 1)
+		lines = simple_strtoul(argv[1], NULL, 10);
+	profile_report(lines);
+
+	return 0;
+}
+
+static int do_profile_dump(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	ulong base, size;
+	void *buf;
+	int needed;
+	int ret;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	base = simple_strtoul(argv[1], NULL, 16);
+	size = simple_strtoul(argv[2], NULL, 16);
+
+	buf = map_sysmem(base, size);
+	ret = profile_dump(buf, size, &needed);
+	unmap_sysmem(buf);
+	if (ret) {
+		printf("Error: truncated (%#x bytes needed)\n", needed);
+		return CMD_RET_FAILURE;
+	}
+	printf("Samples dumped to %08lx, size %#x\n", base, needed);
+	setenv_hex("filesize", needed);
+
+	return 0;
+}
+
+static cmd_tbl_t cmd_profile_sub[] = {
+	U_BOOT_CMD_MKENT(start, 3, 0, do_profile_start, "", ""),
+	U_BOOT_CMD_MKENT(stop, 1, 0, do_profile_stop, "", ""),
+	U_BOOT_CMD_MKENT(report, 2, 1, do_profile_report, "", ""),
+	U_BOOT_CMD_MKENT(dump, 3, 0, do_profile_dump, "", ""),
+};
+
+static int do_profile(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	/* Strip off leading 'profile' command argument */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_profile_sub,
+			 ARRAY_SIZE(cmd_profile_sub));
+	if (!c)
+		return CMD_RET_USAGE;
+
+	return c->cmd(cmdtp, flag, argc, argv);
+}
+
+U_BOOT_CMD(profile, 4, 1, do_profile,
+	"Sampling profiler",
+	"start [<rate> [<samples>]] - Start taking samples (rate in Hz)\n"
+	"profile stop                       - Stop taking samples\n"
+	"profile report [<lines>]           - Show the busiest addresses\n"
+	"profile dump <addr> <size>         - Write samples for proftool"
+);
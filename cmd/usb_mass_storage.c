@@ -12,26 +12,226 @@
 #include <command.h>
 #include <console.h>
 #include <g_dnl.h>
+#include <malloc.h>
 #include <part.h>
 #include <usb.h>
 #include <usb_mass_storage.h>
 
+#ifndef CONFIG_CMD_USB_MASS_STORAGE_CACHE_SIZE
+#define CONFIG_CMD_USB_MASS_STORAGE_CACHE_SIZE	0x100000
+#endif
+
+/*
+ * The host reads and writes in chunks of FSG_BUFLEN at most, which is far
+ * too small to keep the medium busy. Each LUN therefore has a cache which
+ * holds either data read ahead of a sequential reader or data written by
+ * the host but not yet on the medium (write-back).
+ */
+struct ums_cache {
+	void *buf;
+	lbaint_t size;		/* capacity in sectors */
+	ulong start;		/* first sector held */
+	lbaint_t count;		/* number of sectors held */
+	bool dirty;		/* holds data not written to the medium */
+	ulong ra_next;		/* sector following the last read */
+	lbaint_t ra_count;	/* current read-ahead window */
+
+	/* Statistics, reported when ums exits */
+	u64 read_bytes;
+	u64 hit_bytes;
+	u64 write_bytes;
+	ulong medium_time;	/* in ms */
+	unsigned int flushes;
+};
+
+static lbaint_t ums_medium_read(struct ums *ums_dev, ulong start,
+				lbaint_t blkcnt, void *buf)
+{
+	struct ums_cache *cache = ums_dev->cache;
+	ulong time = get_timer(0);
+	lbaint_t n;
+
+	n = blk_dread(&ums_dev->block_dev, start + ums_dev->start_sector,
+		      blkcnt, buf);
+	if (cache)
+		cache->medium_time += get_timer(time);
+
+	return n;
+}
+
+static lbaint_t ums_medium_write(struct ums *ums_dev, ulong start,
+				 lbaint_t blkcnt, const void *buf)
+{
+	struct ums_cache *cache = ums_dev->cache;
+	ulong time = get_timer(0);
+	lbaint_t n;
+
+	n = blk_dwrite(&ums_dev->block_dev, start + ums_dev->start_sector,
+		       blkcnt, buf);
+	if (cache)
+		cache->medium_time += get_timer(time);
+
+	return n;
+}
+
+static int ums_flush(struct ums *ums_dev)
+{
+	struct ums_cache *cache = ums_dev->cache;
+	lbaint_t n;
+
+	if (!cache || !cache->dirty)
+		return 0;
+
+	n = ums_medium_write(ums_dev, cache->start, cache->count, cache->buf);
+	cache->dirty = false;
+	cache->flushes++;
+	if (n != cache->count) {
+		printf("UMS: write back of %#lx+" LBAF " failed\n",
+		       cache->start, cache->count);
+		cache->count = 0;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static bool ums_cache_holds(struct ums_cache *cache, ulong start,
+			    lbaint_t blkcnt)
+{
+	return cache->count && start >= cache->start &&
+	       start + blkcnt <= cache->start + cache->count;
+}
+
 static int ums_read_sector(struct ums *ums_dev,
 			   ulong start, lbaint_t blkcnt, void *buf)
 {
-	struct blk_desc *block_dev = &ums_dev->block_dev;
-	lbaint_t blkstart = start + ums_dev->start_sector;
+	struct ums_cache *cache = ums_dev->cache;
+	lbaint_t count;
+	lbaint_t n;
+
+	if (!cache)
+		return ums_medium_read(ums_dev, start, blkcnt, buf);
+
+	cache->read_bytes += blkcnt * SECTOR_SIZE;
+	if (ums_cache_holds(cache, start, blkcnt)) {
+		memcpy(buf, cache->buf + (start - cache->start) * SECTOR_SIZE,
+		       blkcnt * SECTOR_SIZE);
+		cache->hit_bytes += blkcnt * SECTOR_SIZE;
+		cache->ra_next = start + blkcnt;
+		return blkcnt;
+	}
 
-	return blk_dread(block_dev, blkstart, blkcnt, buf);
+	/* The medium must be up to date before it is read */
+	if (cache->dirty && start < cache->start + cache->count &&
+	    start + blkcnt > cache->start && ums_flush(ums_dev))
+		return 0;
+
+	/* Double the read-ahead window for as long as the reads are linear */
+	if (start == cache->ra_next)
+		count = min(max(cache->ra_count * 2, blkcnt), cache->size);
+	else
+		count = blkcnt;
+	cache->ra_count = count;
+	cache->ra_next = start + blkcnt;
+	count = min(count, (lbaint_t)(ums_dev->num_sectors - start));
+
+	if (count <= blkcnt || cache->dirty)
+		return ums_medium_read(ums_dev, start, blkcnt, buf);
+
+	cache->count = 0;
+	n = ums_medium_read(ums_dev, start, count, cache->buf);
+	if (n != count)
+		return ums_medium_read(ums_dev, start, blkcnt, buf);
+
+	cache->start = start;
+	cache->count = count;
+	memcpy(buf, cache->buf, blkcnt * SECTOR_SIZE);
+
+	return blkcnt;
 }
 
 static int ums_write_sector(struct ums *ums_dev,
 			    ulong start, lbaint_t blkcnt, const void *buf)
 {
-	struct blk_desc *block_dev = &ums_dev->block_dev;
-	lbaint_t blkstart = start + ums_dev->start_sector;
+	struct ums_cache *cache = ums_dev->cache;
+	lbaint_t end;
+
+	if (!cache)
+		return ums_medium_write(ums_dev, start, blkcnt, buf);
+
+	cache->write_bytes += blkcnt * SECTOR_SIZE;
+
+	if (cache->dirty) {
+		/* Extend or overwrite the pending data if it stays contiguous */
+		if (start >= cache->start &&
+		    start <= cache->start + cache->count &&
+		    start + blkcnt <= cache->start + cache->size) {
+			memcpy(cache->buf + (start - cache->start) * SECTOR_SIZE,
+			       buf, blkcnt * SECTOR_SIZE);
+			end = start + blkcnt - cache->start;
+			cache->count = max(cache->count, end);
+			return blkcnt;
+		}
+
+		if (ums_flush(ums_dev))
+			return 0;
+	}
+
+	if (blkcnt >= cache->size) {
+		/* Read-ahead data is stale once the same sectors are written */
+		if (start < cache->start + cache->count &&
+		    start + blkcnt > cache->start)
+			cache->count = 0;
+		return ums_medium_write(ums_dev, start, blkcnt, buf);
+	}
+
+	memcpy(cache->buf, buf, blkcnt * SECTOR_SIZE);
+	cache->start = start;
+	cache->count = blkcnt;
+	cache->dirty = true;
+
+	return blkcnt;
+}
+
+static void ums_cache_init(struct ums *ums_dev)
+{
+	struct ums_cache *cache;
+	lbaint_t size = CONFIG_CMD_USB_MASS_STORAGE_CACHE_SIZE / SECTOR_SIZE;
+
+	ums_dev->cache = NULL;
+	if (!size)
+		return;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return;
+	cache->buf = memalign(ARCH_DMA_MINALIGN, size * SECTOR_SIZE);
+	if (!cache->buf) {
+		free(cache);
+		debug("UMS: no memory for the cache, running without\n");
+		return;
+	}
+	cache->size = size;
+	ums_dev->cache = cache;
+}
 
-	return blk_dwrite(block_dev, blkstart, blkcnt, buf);
+static void ums_cache_fini(struct ums *ums_dev, int lun)
+{
+	struct ums_cache *cache = ums_dev->cache;
+
+	if (!cache)
+		return;
+
+	ums_flush(ums_dev);
+	if (cache->read_bytes || cache->write_bytes)
+		printf("UMS: LUN %d, read %llu KiB (%llu KiB from cache), "
+		       "wrote %llu KiB in %u flushes, medium busy %lu ms\n",
+		       lun, cache->read_bytes >> 10, cache->hit_bytes >> 10,
+		       cache->write_bytes >> 10, cache->flushes,
+		       cache->medium_time);
+	free(cache->buf);
+	free(cache);
+	ums_dev->cache = NULL;
 }
 
 static struct ums *ums;
@@ -41,8 +241,10 @@ static void ums_fini(void)
 {
 	int i;
 
-	for (i = 0; i < ums_count; i++)
+	for (i = 0; i < ums_count; i++) {
+		ums_cache_fini(&ums[i], i);
 		free((void *)ums[i].name);
+	}
 	free(ums);
 	ums = 0;
 	ums_count = 0;
@@ -104,6 +306,7 @@ static int ums_init(const char *devtype, const char *devnums_part_str)
 
 		ums[ums_count].read_sector = ums_read_sector;
 		ums[ums_count].write_sector = ums_write_sector;
+		ums[ums_count].flush = ums_flush;
 
 		name = malloc(UMS_NAME_LEN);
 		if (!name)
@@ -111,6 +314,7 @@ static int ums_init(const char *devtype, const char *devnums_part_str)
 		snprintf(name, UMS_NAME_LEN, "UMS disk %d", ums_count);
 		ums[ums_count].name = name;
 		ums[ums_count].block_dev = *block_dev;
+		ums_cache_init(&ums[ums_count]);
 
 		printf("UMS: LUN %d, dev %d, hwpart %d, sector %#x, count %#x\n",
 		       ums_count, ums[ums_count].block_dev.devnum,
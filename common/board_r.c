@@ -699,6 +699,8 @@ static int initr_kbd(void)
 
 static int run_main_loop(void)
 {
+	/* This initcall never returns, so commands are not part of its span */
+	bootstage_span_end_all(BOOTSTAGE_SPAN_INITCALL);
 #ifdef CONFIG_SANDBOX
 	sandbox_main_loop_init();
 #endif
@@ -944,6 +946,8 @@ void board_init_r(gd_t *new_gd, ulong dest_addr)
 		init_sequence_r[i] += gd->reloc_off;
 #endif
 
+	/* The initcall which jumped here, if any, did not return */
+	bootstage_span_end_all(BOOTSTAGE_SPAN_INITCALL);
 	if (initcall_run_list(init_sequence_r))
 		hang();
 
@@ -65,12 +65,15 @@ static void boot_start_lmb(bootm_headers_t *images)
 }
 #else
 #define lmb_reserve(lmb, base, size)
+#define lmb_release(lmb)
 static inline void boot_start_lmb(bootm_headers_t *images) { }
 #endif
 
 static int bootm_start(cmd_tbl_t *cmdtp, int flag, int argc,
 		       char * const argv[])
 {
+	/* Drop any region tables left over from a previous bootm */
+	lmb_release(&images.lmb);
 	memset((void *)&images, 0, sizeof(images));
 	images.verify = getenv_yesno("verify");
 
@@ -492,6 +495,7 @@ ulong bootm_disable_interrupts(void)
 	 * recover from any failures any more...
 	 */
 	iflag = disable_interrupts();
+	serial_tx_flush();
 #ifdef CONFIG_NETCONSOLE
 	/* Stop the ethernet stack if NetConsole could have left it up */
 	eth_halt();
@@ -707,9 +711,10 @@ int do_bootm_states(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	}
 
 	/* Now run the OS! We hope this doesn't return */
-	if (!ret && (states & BOOTM_STATE_OS_GO))
+	if (!ret && (states & BOOTM_STATE_OS_GO)) {
 		ret = boot_selected_os(argc, argv, BOOTM_STATE_OS_GO,
 				images, boot_fn);
+	}
 
 	/* Deal with any fallout */
 err:
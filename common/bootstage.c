@@ -292,6 +292,188 @@ void bootstage_report(void)
 	}
 }
 
+#ifdef CONFIG_BOOTSTAGE_SPANS
+enum {
+	SPAN_NAME_LEN	= 24,
+};
+
+/**
+ * struct bootstage_span - A timed span, such as a device probe
+ *
+ * @start_us:	Start time in microseconds
+ * @end_us:	End time in microseconds, valid once @open is clear
+ * @parent:	Span which was open when this one started, or -1
+ * @type:	Kind of span (enum bootstage_span_type)
+ * @open:	1 until the span ends
+ * @name:	Name of the span
+ */
+struct bootstage_span {
+	uint32_t start_us;
+	uint32_t end_us;
+	short parent;
+	u8 type;
+	u8 open;
+	char name[SPAN_NAME_LEN];
+};
+
+/* These are used before relocation, so must not be in BSS */
+static struct bootstage_span span[CONFIG_BOOTSTAGE_SPAN_COUNT] = { {1} };
+static int span_count __attribute__((section(".data")));
+static int span_cur = -1;
+static int span_dropped __attribute__((section(".data")));
+static bool span_busy __attribute__((section(".data")));
+
+static const char *const span_type_name[BOOTSTAGE_SPAN_TYPE_COUNT] = {
+	"other", "dm", "initcall", "cmd",
+};
+
+int bootstage_span_start(enum bootstage_span_type type, const char *name)
+{
+	struct bootstage_span *sp;
+	int i;
+
+	/*
+	 * Reading the time may probe the timer device, which would start
+	 * another span here. Leave that one out.
+	 */
+	if (span_busy)
+		return -1;
+	if (span_count == CONFIG_BOOTSTAGE_SPAN_COUNT) {
+		span_dropped++;
+		return -1;
+	}
+	sp = &span[span_count];
+	sp->parent = span_cur;
+	sp->type = type;
+	sp->open = 1;
+
+	/* Keep the name safe to put in a JSON string */
+	for (i = 0; i < SPAN_NAME_LEN - 1 && name && name[i]; i++) {
+		char ch = name[i];
+
+		sp->name[i] = ch < ' ' || ch == '"' || ch == '\\' ? '?' : ch;
+	}
+	sp->name[i] = '\0';
+	span_busy = true;
+	sp->start_us = timer_get_boot_us();
+	span_busy = false;
+	span_cur = span_count++;
+
+	return span_cur;
+}
+
+void bootstage_span_end(int id)
+{
+	struct bootstage_span *sp;
+
+	/* The span may have been thrown away by bootstage_span_reset() */
+	if (id < 0 || id >= span_count || !span[id].open)
+		return;
+	sp = &span[id];
+	sp->end_us = timer_get_boot_us();
+	sp->open = 0;
+	span_cur = sp->parent;
+}
+
+void bootstage_span_end_all(enum bootstage_span_type type)
+{
+	while (span_cur != -1 && span[span_cur].type == type)
+		bootstage_span_end(span_cur);
+}
+
+void bootstage_span_reset(void)
+{
+	span_count = 0;
+	span_cur = -1;
+	span_dropped = 0;
+}
+
+static uint32_t span_duration(struct bootstage_span *sp)
+{
+	return (sp->open ? (uint32_t)timer_get_boot_us() : sp->end_us) -
+		sp->start_us;
+}
+
+void bootstage_span_report(void)
+{
+	struct bootstage_span *sp;
+	int depth, parent;
+	int i;
+
+	puts("Spans in microseconds:\n");
+	printf("%11s%11s  %s\n", "Start", "Duration", "Span");
+	for (i = 0, sp = span; i < span_count; i++, sp++) {
+		for (depth = 0, parent = sp->parent; parent != -1;
+		     parent = span[parent].parent)
+			depth++;
+		print_grouped_ull(sp->start_us, BOOTSTAGE_DIGITS);
+		print_grouped_ull(span_duration(sp), BOOTSTAGE_DIGITS);
+		printf("  %*s%s %s%s\n", depth * 2, "",
+		       span_type_name[sp->type], sp->name,
+		       sp->open ? " (open)" : "");
+	}
+	if (span_dropped)
+		printf("(%d spans not recorded - please increase CONFIG_BOOTSTAGE_SPAN_COUNT)\n",
+		       span_dropped);
+}
+
+/**
+ * struct json_buf - Output buffer for the JSON writer
+ *
+ * @ptr:	Start of buffer
+ * @size:	Size of buffer
+ * @len:	Number of bytes written so far, or that would have been
+ */
+struct json_buf {
+	char *ptr;
+	int size;
+	int len;
+};
+
+static void json_printf(struct json_buf *jb, const char *fmt, ...)
+{
+	int space = max(jb->size - jb->len, 0);
+	va_list args;
+
+	va_start(args, fmt);
+	jb->len += vsnprintf(jb->ptr + min(jb->len, jb->size), space, fmt,
+			     args);
+	va_end(args);
+}
+
+int bootstage_span_json(char *buf, int size)
+{
+	struct json_buf jb = { .ptr = buf, .size = size };
+	struct bootstage_record *rec;
+	struct bootstage_span *sp;
+	const char *sep = "";
+	char name[20];
+	int i;
+
+	json_printf(&jb, "{\"traceEvents\":[");
+	for (i = 0, sp = span; i < span_count; i++, sp++) {
+		json_printf(&jb, "%s\n{\"name\":\"%s\",\"cat\":\"%s\","
+			    "\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%u,\"dur\":%u}",
+			    sep, sp->name, span_type_name[sp->type],
+			    sp->start_us, span_duration(sp));
+		sep = ",";
+	}
+	for (i = 0, rec = record; i < BOOTSTAGE_ID_COUNT; i++, rec++) {
+		if (rec->id == BOOTSTAGE_ID_AWAKE || !rec->time_us ||
+		    rec->start_us)
+			continue;
+		json_printf(&jb, "%s\n{\"name\":\"%s\",\"cat\":\"mark\","
+			    "\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%lu}",
+			    sep, get_record_name(name, sizeof(name), rec),
+			    rec->time_us);
+		sep = ",";
+	}
+	json_printf(&jb, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return jb.len;
+}
+#endif /* CONFIG_BOOTSTAGE_SPANS */
+
 ulong __timer_get_boot_us(void)
 {
 	static ulong base_time;
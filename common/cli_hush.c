@@ -1553,6 +1553,7 @@ static int run_pipe_real(struct pipe *pi)
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1619,6 +1620,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* the pipe may be run again, so leave child->sp alone */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1627,11 +1630,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1759,12 +1762,33 @@ static int run_pipe_real(struct pipe *pi)
 	return -1;
 }
 
+#ifdef __U_BOOT__
+/*
+ * Put back the variable name of a "for" loop which is left before its list
+ * of values is used up, so that the pipe can be run again
+ */
+static void restore_for_loop(struct pipe *for_pipe, char *save_name,
+			     char **list, char **save_list)
+{
+	if (!list)
+		return;
+	while (*list)
+		free(*list++);
+	free(save_list);
+	free(for_pipe->progs->argv[0]);
+	for_pipe->progs->argv[0] = save_name;
+}
+#endif
+
 static int run_list_real(struct pipe *pi)
 {
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
 	struct pipe *rpipe;
+#ifdef __U_BOOT__
+	struct pipe *for_pipe = NULL;
+#endif
 	int flag_rep = 0;
 #ifndef __U_BOOT__
 	int save_num_progs;
@@ -1803,6 +1827,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
+					restore_for_loop(for_pipe, save_name,
+							 list, save_list);
 					return 1;
 				}
 #endif
@@ -1835,6 +1861,9 @@ static int run_list_real(struct pipe *pi)
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
+#ifdef __U_BOOT__
+				for_pipe = pi;
+#endif
 			}
 			if (!(*list)) {
 				free(pi->progs->argv[0]);
@@ -1903,6 +1932,7 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
+			restore_for_loop(for_pipe, save_name, list, save_list);
 			return -2;	/* exit */
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
@@ -3284,6 +3314,157 @@ int parse_string_outer(const char *s, int flag)
 #endif
 }
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/*
+ * Parsed form of the scripts executed with "run", so that running the same
+ * variable again, e.g. from a retry loop, does not parse its text again. An
+ * entry is only used while the variable still holds exactly the same text.
+ */
+struct parse_cache_entry {
+	char *name;		/* name of the env variable */
+	char *text;		/* text which was parsed */
+	uint hash;		/* hash of the text, for a quick mismatch check */
+	struct pipe *list;	/* parsed form of the text */
+	int busy;		/* number of runs of the list in progress */
+	ulong last_used;	/* for least-recently-used replacement */
+};
+
+static struct parse_cache_entry parse_cache[CONFIG_HUSH_PARSE_CACHE_SIZE];
+static ulong parse_cache_seq;
+
+static uint parse_cache_hash(const char *s)
+{
+	uint hash = 5381;
+
+	while (*s)
+		hash = hash * 33 + *s++;
+
+	return hash;
+}
+
+static void parse_cache_free(struct parse_cache_entry *ent)
+{
+	free_pipe_list(ent->list, 0);
+	free(ent->name);
+	free(ent->text);
+	memset(ent, '\0', sizeof(*ent));
+}
+
+/* Parse a whole script into a pipe list without running it */
+static struct pipe *parse_cache_parse(const char *s, int flag)
+{
+	struct in_str input;
+	struct p_context ctx;
+	o_string temp = NULL_O_STRING;
+	char *p;
+	int rcode;
+
+	p = xmalloc(strlen(s) + 2);
+	strcpy(p, s);
+	strcat(p, "\n");
+	setup_string_in_str(&input, p);
+
+	bootstage_start(BOOTSTAGE_ID_ACCUM_HUSH, "hush_parse");
+	ctx.type = flag;
+	initialize_context(&ctx);
+	update_ifs_map();
+	input.promptmode = 1;
+	rcode = parse_stream(&temp, &ctx, &input, -1);
+	if (rcode != 1 && ctx.old_flag == 0) {
+		done_word(&temp, &ctx);
+		done_pipe(&ctx, PIPE_SEQ);
+	} else {
+		/* let the caller go the normal way to report the error */
+		if (ctx.old_flag != 0)
+			free(ctx.stack);
+		free_pipe_list(ctx.list_head, 0);
+		ctx.list_head = NULL;
+	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_HUSH);
+	b_free(&temp);
+	free(p);
+
+	return ctx.list_head;
+}
+
+/* Find the entry for a variable, or a free or old one to put it in */
+static struct parse_cache_entry *parse_cache_lookup(const char *name,
+						    const char *s, uint hash)
+{
+	struct parse_cache_entry *ent, *victim = NULL;
+
+	for (ent = parse_cache; ent < parse_cache + ARRAY_SIZE(parse_cache);
+	     ent++) {
+		if (ent->name && !strcmp(ent->name, name)) {
+			if (ent->hash == hash && !strcmp(ent->text, s))
+				return ent;
+			/* the variable has changed since it was parsed */
+			if (ent->busy)
+				return NULL;
+			parse_cache_free(ent);
+			return ent;
+		}
+		if (ent->busy)
+			continue;
+		if (!victim || !ent->name ||
+		    (victim->name && ent->last_used < victim->last_used))
+			victim = ent;
+	}
+	if (victim && victim->name)
+		parse_cache_free(victim);
+
+	return victim;
+}
+
+/*
+ * Run the script "s" held by the env variable "name", like
+ * parse_string_outer(), reusing the parsed form from an earlier run of the
+ * same text if there is one.
+ */
+int parse_cached_string_outer(const char *name, const char *s, int flag)
+{
+	struct parse_cache_entry *ent;
+	uint hash;
+	int code;
+
+	if (!s)
+		return 1;
+	if (!*s)
+		return 0;
+
+	hash = parse_cache_hash(s);
+	ent = parse_cache_lookup(name, s, hash);
+	/*
+	 * A script which runs itself cannot share the list with the run in
+	 * progress, as running a list updates the words in it
+	 */
+	if (!ent || ent->busy)
+		return parse_string_outer(s, flag);
+
+	if (!ent->name) {
+		ent->list = parse_cache_parse(s, flag);
+		if (!ent->list)
+			return parse_string_outer(s, flag);
+		ent->name = xmalloc(strlen(name) + 1);
+		strcpy(ent->name, name);
+		ent->text = xmalloc(strlen(s) + 1);
+		strcpy(ent->text, s);
+		ent->hash = hash;
+	}
+	ent->last_used = ++parse_cache_seq;
+
+	ent->busy++;
+	code = run_list_real(ent->list);
+	ent->busy--;
+	if (code == -2)		/* exit */
+		code = 0;
+	if (code == -1)
+		flag_repeat = 0;
+
+	return (code != 0) ? 1 : 0;
+}
+#endif
+
 #ifndef __U_BOOT__
 static int parse_file_outer(FILE *f)
 #else
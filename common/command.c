@@ -12,6 +12,7 @@
 #include <common.h>
 #include <command.h>
 #include <console.h>
+#include <malloc_trace.h>
 #include <linux/ctype.h>
 
 /*
@@ -496,8 +497,16 @@ void fixup_cmdtable(cmd_tbl_t *cmdtp, int size)
 static int cmd_call(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	int result;
+	int scope;
+	int span;
 
+	scope = malloc_trace_enter(cmdtp->name);
+	span = bootstage_span_start(BOOTSTAGE_SPAN_CMD, cmdtp->name);
 	result = (cmdtp->cmd)(cmdtp, flag, argc, argv);
+	bootstage_span_end(span);
+	malloc_trace_leave(scope);
+	/* Buffer the console again if the command handed over and came back */
+	serial_tx_resume();
 	if (result)
 		debug("Command failed, result=%d\n", result);
 	return result;
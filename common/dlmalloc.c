@@ -5,8 +5,37 @@
 #endif
 
 #include <malloc.h>
+#include <errno.h>
+#include <linux/log2.h>
 #include <asm/io.h>
 
+#if defined(CONFIG_MALLOC_TRACE) && !defined(CONFIG_SPL_BUILD)
+#include <malloc_trace.h>
+
+/*
+ * Build the allocator under other names, so that the calls it makes to
+ * itself are not traced. The public functions, near the end of this file,
+ * record each allocation and call these.
+ */
+#define MALLOC_TRACE
+#undef mALLOc
+#undef fREe
+#undef rEALLOc
+#undef cALLOc
+#undef mEMALIGn
+#define mALLOc		untraced_malloc
+#define fREe		untraced_free
+#define rEALLOc		untraced_realloc
+#define cALLOc		untraced_calloc
+#define mEMALIGn	untraced_memalign
+
+Void_t *mALLOc(size_t bytes);
+void fREe(Void_t *mem);
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes);
+Void_t *cALLOc(size_t n, size_t elem_size);
+Void_t *mEMALIGn(size_t alignment, size_t bytes);
+#endif
+
 #ifdef DEBUG
 #if __STD_C
 static void malloc_update_mallinfo (void);
@@ -1234,9 +1263,9 @@ static void malloc_extend_top(nb) INTERNAL_SIZE_T nb;
 */
 
 #if __STD_C
-Void_t* mALLOc(size_t bytes)
+static Void_t* dl_malloc(size_t bytes)
 #else
-Void_t* mALLOc(bytes) size_t bytes;
+static Void_t* dl_malloc(bytes) size_t bytes;
 #endif
 {
   mchunkptr victim;                  /* inspected/selected chunk */
@@ -1480,6 +1509,258 @@ Void_t* mALLOc(bytes) size_t bytes;
 
 }
 
+#ifdef CONFIG_SYS_MALLOC_SLAB
+/*
+ * Small allocations are made from pages of equal-sized objects, with one
+ * size class per page. The pages come from a single chunk of the heap, so
+ * small objects do not break up the space needed for large blocks, and
+ * allocating and freeing them takes constant time. When a page becomes
+ * empty it can be reused for any size class.
+ */
+enum {
+	SLAB_PAGE_SIZE	= 4096,
+	SLAB_MAX_SIZE	= 256,
+};
+
+/**
+ * struct slab_page - Information about a slab page
+ *
+ * @next:	Next page in the list of pages with free objects for this
+ *		size class, or in the list of empty pages
+ * @prev:	Previous page in the list of pages with free objects
+ * @free:	First free object in the page, or NULL if full
+ * @inuse:	Number of objects allocated from the page
+ * @cls:	Size class of the objects in this page
+ */
+struct slab_page {
+	struct slab_page *next;
+	struct slab_page *prev;
+	void *free;
+	ushort inuse;
+	ushort cls;
+};
+
+static const ushort slab_size[MALLOC_SLAB_CLASSES] = {
+	16, 32, 48, 64, 96, 128, 192, 256,
+};
+
+/* Size class for each request size, indexed by size in 16-byte units */
+static const u8 slab_class_of[SLAB_MAX_SIZE / 16 + 1] = {
+	0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7,
+};
+
+static struct slab_page *slab_pages;	/* Array with one entry per page */
+static char *slab_base;			/* Start of first page */
+static char *slab_end;			/* End of last page */
+static uint slab_npages;
+static bool slab_failed;		/* Could not allocate the slab area */
+static struct slab_page *slab_empty;	/* List of empty pages */
+static struct slab_page *slab_partial[MALLOC_SLAB_CLASSES];
+static struct malloc_slab_class slab_stats[MALLOC_SLAB_CLASSES];
+static ulong slab_fallbacks;
+
+static int slab_init(void)
+{
+	size_t len = CONFIG_SYS_MALLOC_SLAB_LEN;
+	size_t desc_size;
+	char *area;
+	uint i;
+
+	area = dl_malloc(len);
+	if (!area) {
+		slab_failed = true;
+		return -ENOMEM;
+	}
+	slab_npages = len / (SLAB_PAGE_SIZE + sizeof(struct slab_page));
+	desc_size = ALIGN(slab_npages * sizeof(struct slab_page),
+			  MALLOC_ALIGNMENT);
+	if (desc_size + slab_npages * SLAB_PAGE_SIZE > len)
+		slab_npages--;
+	slab_pages = (struct slab_page *)area;
+	slab_base = area + desc_size;
+	slab_end = slab_base + slab_npages * SLAB_PAGE_SIZE;
+	for (i = slab_npages; i-- > 0;) {
+		slab_pages[i].next = slab_empty;
+		slab_empty = &slab_pages[i];
+	}
+	for (i = 0; i < MALLOC_SLAB_CLASSES; i++)
+		slab_stats[i].size = slab_size[i];
+
+	return 0;
+}
+
+static inline char *slab_page_addr(struct slab_page *page)
+{
+	return slab_base + (page - slab_pages) * SLAB_PAGE_SIZE;
+}
+
+static inline bool slab_owns(Void_t *mem)
+{
+	return (char *)mem >= slab_base && (char *)mem < slab_end;
+}
+
+static inline struct slab_page *slab_page_of(Void_t *mem)
+{
+	return &slab_pages[((char *)mem - slab_base) / SLAB_PAGE_SIZE];
+}
+
+static void slab_link(struct slab_page *page)
+{
+	struct slab_page **headp = &slab_partial[page->cls];
+
+	page->prev = NULL;
+	page->next = *headp;
+	if (*headp)
+		(*headp)->prev = page;
+	*headp = page;
+}
+
+static void slab_unlink(struct slab_page *page)
+{
+	if (page->prev)
+		page->prev->next = page->next;
+	else
+		slab_partial[page->cls] = page->next;
+	if (page->next)
+		page->next->prev = page->prev;
+}
+
+/* Take an empty page and fill its free list with objects of class @cls */
+static struct slab_page *slab_new_page(int cls)
+{
+	struct slab_page *page = slab_empty;
+	uint size = slab_size[cls];
+	char *obj, *end;
+
+	if (!page)
+		return NULL;
+	slab_empty = page->next;
+
+	obj = slab_page_addr(page);
+	end = obj + (SLAB_PAGE_SIZE / size - 1) * size;
+	page->free = obj;
+	for (; obj < end; obj += size)
+		*(void **)obj = obj + size;
+	*(void **)obj = NULL;
+	page->inuse = 0;
+	page->cls = cls;
+	slab_link(page);
+	slab_stats[cls].pages++;
+
+	return page;
+}
+
+static Void_t *slab_alloc(size_t bytes)
+{
+	struct slab_page *page;
+	void **obj;
+	int cls;
+
+	if (bytes > SLAB_MAX_SIZE)
+		return NULL;
+#ifdef CONFIG_SYS_MALLOC_F_LEN
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+#endif
+	if (!slab_base) {
+		if (slab_failed || (!mem_malloc_start && !mem_malloc_end))
+			return NULL;
+		if (slab_init())
+			return NULL;
+	}
+
+	cls = slab_class_of[(bytes + 15) / 16];
+	page = slab_partial[cls];
+	if (!page) {
+		page = slab_new_page(cls);
+		if (!page) {
+			slab_fallbacks++;
+			return NULL;
+		}
+	}
+	obj = page->free;
+	page->free = *obj;
+	page->inuse++;
+	if (!page->free)
+		slab_unlink(page);
+	slab_stats[cls].inuse++;
+	slab_stats[cls].allocs++;
+
+	return obj;
+}
+
+static void slab_free(Void_t *mem)
+{
+	struct slab_page *page = slab_page_of(mem);
+
+	if (!page->free)
+		slab_link(page);
+	*(void **)mem = page->free;
+	page->free = mem;
+	page->inuse--;
+	slab_stats[page->cls].inuse--;
+
+	/* Keep the last page of each class to avoid refilling it each time */
+	if (!page->inuse && (page->prev || page->next)) {
+		slab_unlink(page);
+		page->next = slab_empty;
+		slab_empty = page;
+		slab_stats[page->cls].pages--;
+	}
+}
+
+static inline size_t slab_usable_size(Void_t *mem)
+{
+	return slab_size[slab_page_of(mem)->cls];
+}
+
+void malloc_slab_get_info(struct malloc_slab_info *info)
+{
+	struct slab_page *page;
+	uint i;
+
+	info->page_size = SLAB_PAGE_SIZE;
+	info->pages = slab_npages;
+	info->fallbacks = slab_fallbacks;
+	for (page = slab_empty, info->free_pages = 0; page; page = page->next)
+		info->free_pages++;
+	for (i = 0; i < MALLOC_SLAB_CLASSES; i++) {
+		info->cls[i] = slab_stats[i];
+		info->cls[i].size = slab_size[i];
+	}
+}
+#else
+static inline Void_t *slab_alloc(size_t bytes)
+{
+	return NULL;
+}
+
+static inline bool slab_owns(Void_t *mem)
+{
+	return false;
+}
+
+static inline void slab_free(Void_t *mem)
+{
+}
+
+static inline size_t slab_usable_size(Void_t *mem)
+{
+	return 0;
+}
+#endif /* CONFIG_SYS_MALLOC_SLAB */
+
+Void_t *mALLOc(size_t bytes)
+{
+	Void_t *mem;
+
+	mem = slab_alloc(bytes);
+	if (mem)
+		return mem;
+
+	return dl_malloc(bytes);
+}
+
 
 
 
@@ -1531,6 +1812,11 @@ void fREe(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+  if (slab_owns(mem)) {
+    slab_free(mem);
+    return;
+  }
+
   p = mem2chunk(mem);
   hd = p->size;
 
@@ -1686,6 +1972,19 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 	}
 #endif
 
+  if (slab_owns(oldmem)) {
+    oldsize = slab_usable_size(oldmem);
+    if (bytes <= oldsize)
+      return oldmem;
+    newmem = mALLOc(bytes);
+    if (newmem == NULL)
+      return NULL;
+    /* MALLOC_COPY() assumes a chunk and may copy more than oldsize */
+    memcpy(newmem, oldmem, oldsize);
+    slab_free(oldmem);
+    return newmem;
+  }
+
   newp    = oldp    = mem2chunk(oldmem);
   newsize = oldsize = chunksize(oldp);
 
@@ -1702,7 +2001,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
     /* Note the extra SIZE_SZ overhead. */
     if(oldsize - SIZE_SZ >= nb) return oldmem; /* do nothing */
     /* Must alloc, copy, free. */
-    newmem = mALLOc(bytes);
+    newmem = dl_malloc(bytes);
     if (newmem == 0) return 0; /* propagate failure */
     MALLOC_COPY(newmem, oldmem, oldsize - 2*SIZE_SZ);
     munmap_chunk(oldp);
@@ -1804,7 +2103,7 @@ Void_t* rEALLOc(oldmem, bytes) Void_t* oldmem; size_t bytes;
 
     /* Must allocate */
 
-    newmem = mALLOc (bytes);
+    newmem = dl_malloc(bytes);
 
     if (newmem == NULL)  /* propagate failure */
       return NULL;
@@ -1898,7 +2197,7 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
   /* Call malloc with worst case padding to hit alignment. */
 
   nb = request2size(bytes);
-  m  = (char*)(mALLOc(nb + alignment + MINSIZE));
+  m  = (char*)(dl_malloc(nb + alignment + MINSIZE));
 
   /*
   * The attempt to over-allocate (with a size large enough to guarantee the
@@ -1914,7 +2213,7 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
      * Use bytes not nb, since mALLOc internally calls request2size too, and
      * each call increases the size to allocate, to account for the header.
      */
-    m  = (char*)(mALLOc(bytes));
+    m  = (char*)(dl_malloc(bytes));
     /* Aligned -> return it */
     if ((((unsigned long)(m)) % alignment) == 0)
       return m;
@@ -1925,7 +2224,7 @@ Void_t* mEMALIGn(alignment, bytes) size_t alignment; size_t bytes;
     fREe(m);
     /* Add in extra bytes to match misalignment of unexpanded allocation */
     extra = alignment - (((unsigned long)(m)) % alignment);
-    m  = (char*)(mALLOc(bytes + extra));
+    m  = (char*)(dl_malloc(bytes + extra));
     /*
      * m might not be the same as before. Validate that the previous value of
      * extra still works for the current value of m.
@@ -2062,14 +2361,29 @@ Void_t* cALLOc(n, elem_size) size_t n; size_t elem_size;
   /* check if expand_top called, in which case don't need to clear */
 #ifdef CONFIG_SYS_MALLOC_CLEAR_ON_INIT
 #if MORECORE_CLEARS
-  mchunkptr oldtop = top;
-  INTERNAL_SIZE_T oldtopsize = chunksize(top);
+  mchunkptr oldtop;
+  INTERNAL_SIZE_T oldtopsize;
 #endif
 #endif
-  Void_t* mem = mALLOc (sz);
+  Void_t* mem;
 
   if ((long)n < 0) return NULL;
 
+  mem = slab_alloc(sz);
+  if (mem != NULL) {
+    /* Not MALLOC_ZERO(), which clears at least three words */
+    memset(mem, '\0', sz);
+    return mem;
+  }
+
+#ifdef CONFIG_SYS_MALLOC_CLEAR_ON_INIT
+#if MORECORE_CLEARS
+  oldtop = top;
+  oldtopsize = chunksize(top);
+#endif
+#endif
+  mem = dl_malloc(sz);
+
   if (mem == NULL)
     return NULL;
   else
@@ -2124,6 +2438,52 @@ void cfree(mem) Void_t *mem;
 }
 #endif
 
+#ifdef MALLOC_TRACE
+void *malloc(size_t bytes)
+{
+	void *mem = untraced_malloc(bytes);
+
+	malloc_trace_alloc(mem, bytes, _RET_IP_);
+
+	return mem;
+}
+
+void free(void *mem)
+{
+	malloc_trace_free(mem);
+	untraced_free(mem);
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	void *mem = untraced_realloc(oldmem, bytes);
+
+	/* On failure the old memory is left alone, unless bytes is 0 */
+	if (mem || !bytes)
+		malloc_trace_realloc(oldmem, mem, bytes, _RET_IP_);
+
+	return mem;
+}
+
+void *calloc(size_t n, size_t elem_size)
+{
+	void *mem = untraced_calloc(n, elem_size);
+
+	malloc_trace_alloc(mem, n * elem_size, _RET_IP_);
+
+	return mem;
+}
+
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *mem = untraced_memalign(alignment, bytes);
+
+	malloc_trace_alloc(mem, bytes, _RET_IP_);
+
+	return mem;
+}
+#endif /* MALLOC_TRACE */
+
 
 
 /*
@@ -2227,6 +2587,8 @@ size_t malloc_usable_size(mem) Void_t* mem;
   mchunkptr p;
   if (mem == NULL)
     return 0;
+  else if (slab_owns(mem))
+    return slab_usable_size(mem);
   else
   {
     p = mem2chunk(mem);
@@ -2282,9 +2644,49 @@ static void malloc_update_mallinfo()
   current_mallinfo.hblkhd = mmapped_mem;
   current_mallinfo.keepcost = chunksize(top);
 
+#ifdef CONFIG_SYS_MALLOC_SLAB
+  /* Count slab objects rather than the chunk holding them */
+  if (slab_pages)
+  {
+    INTERNAL_SIZE_T area = chunksize(mem2chunk(slab_pages));
+    INTERNAL_SIZE_T used = 0;
+
+    for (i = 0; i < MALLOC_SLAB_CLASSES; i++)
+      used += slab_stats[i].inuse * slab_size[i];
+    current_mallinfo.uordblks -= area - used;
+    current_mallinfo.fordblks += area - used;
+  }
+#endif
 }
 #endif	/* DEBUG */
 
+void malloc_get_frag_info(struct malloc_frag_info *info)
+{
+	INTERNAL_SIZE_T size;
+	mbinptr b;
+	mchunkptr p;
+	int i, bucket;
+
+	memset(info, '\0', sizeof(*info));
+	if (!mem_malloc_start && !mem_malloc_end)
+		return;
+	info->top_size = chunksize(top);
+	info->free_bytes = info->top_size;
+	info->largest = info->top_size;
+	for (i = 1; i < NAV; i++) {
+		b = bin_at(i);
+		for (p = last(b); p != b; p = p->bk) {
+			size = chunksize(p);
+			info->free_bytes += size;
+			info->free_chunks++;
+			if (size > info->largest)
+				info->largest = size;
+			bucket = max(ilog2(size) - 4, 0);
+			info->hist[min(bucket, MALLOC_FRAG_BUCKETS - 1)]++;
+		}
+	}
+}
+
 
 
 /*
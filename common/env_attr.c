@@ -12,6 +12,7 @@
 #else
 #include <common.h>
 #include <slre.h>
+#include <linux/ctype.h>
 #endif
 
 #include <env_attr.h>
@@ -304,3 +305,211 @@ int env_attr_lookup(const char *attr_list, const char *name, char *attributes)
 	return -ENOENT;
 }
 #endif
+
+#ifndef USE_HOSTCC
+struct env_attr_map_priv {
+	struct env_attr_map *map;
+	int alloced;
+	int seq;
+	unsigned long (*convert)(const char *attributes);
+};
+
+/*
+ * Check whether a name from an attribute list can only ever match itself.
+ * With CONFIG_REGEX the names are expressions, but nearly all of them are
+ * plain names or only escape literal characters (e.g. "\.flags"). Those are
+ * unescaped in place so they can be found with a binary search.
+ */
+static bool env_attr_name_is_plain(char *name)
+{
+#if defined(CONFIG_REGEX)
+	static const char meta[] = "^$.[]()|*+?";
+	char *src, *dst;
+
+	for (src = name; *src; src++) {
+		if (*src == '\\') {
+			if (!src[1] || isalnum(src[1]))
+				return false;
+			src++;
+		} else if (strchr(meta, *src)) {
+			return false;
+		}
+	}
+
+	for (src = dst = name; *src; src++) {
+		if (*src == '\\')
+			src++;
+		*dst++ = *src;
+	}
+	*dst = '\0';
+#endif
+	return true;
+}
+
+static int env_attr_map_add(const char *name, const char *attributes,
+	void *priv)
+{
+	struct env_attr_map_priv *mp = priv;
+	struct env_attr_map *map = mp->map;
+	struct env_attr_map_entry *ent;
+
+	if (map->count == mp->alloced) {
+		int alloced = mp->alloced ? mp->alloced * 2 : 16;
+
+		ent = realloc(map->entries, alloced * sizeof(*ent));
+		if (!ent)
+			return -ENOMEM;
+		map->entries = ent;
+		mp->alloced = alloced;
+	}
+
+	ent = &map->entries[map->count];
+	ent->name = strdup(name);
+	if (!ent->name)
+		return -ENOMEM;
+	ent->value = mp->convert(attributes ? attributes : "");
+	ent->seq = mp->seq++;
+	ent->regex = NULL;
+	if (!env_attr_name_is_plain(ent->name)) {
+#if defined(CONFIG_REGEX)
+		struct slre *slre = malloc(sizeof(*slre));
+		char regex[strlen(name) + 3];
+
+		/* Require the whole string to be described by the regex */
+		sprintf(regex, "^%s$", name);
+		if (!slre || !slre_compile(slre, regex)) {
+			if (slre)
+				printf("Error compiling regex: %s\n",
+				       slre->err_str);
+			free(slre);
+			free(ent->name);
+			return slre ? 0 : -ENOMEM;
+		}
+		ent->regex = slre;
+#endif
+	}
+	map->count++;
+
+	return 0;
+}
+
+/* Plain names first, sorted by name and then list position; then regexes */
+static int env_attr_map_cmp(const void *p1, const void *p2)
+{
+	const struct env_attr_map_entry *e1 = p1, *e2 = p2;
+	int ret;
+
+	if (!e1->regex != !e2->regex)
+		return e1->regex ? 1 : -1;
+	if (!e1->regex) {
+		ret = strcmp(e1->name, e2->name);
+		if (ret)
+			return ret;
+	}
+
+	return e1->seq - e2->seq;
+}
+
+void env_attr_map_free(struct env_attr_map *map)
+{
+	int i;
+
+	for (i = 0; i < map->count; i++) {
+		free(map->entries[i].name);
+		free(map->entries[i].regex);
+	}
+	free(map->entries);
+	map->entries = NULL;
+	map->count = 0;
+	map->num_names = 0;
+}
+
+int env_attr_map_build(struct env_attr_map *map, const char * const lists[],
+	int num_lists, unsigned long (*convert)(const char *attributes))
+{
+	struct env_attr_map_priv priv;
+	int i, n, ret;
+
+	env_attr_map_free(map);
+
+	priv.map = map;
+	priv.alloced = 0;
+	priv.seq = 0;
+	priv.convert = convert;
+	for (i = 0; i < num_lists; i++) {
+		if (!lists[i])
+			continue;
+		ret = env_attr_walk(lists[i], env_attr_map_add, &priv);
+		if (ret) {
+			env_attr_map_free(map);
+			return ret;
+		}
+	}
+
+	qsort(map->entries, map->count, sizeof(*map->entries),
+	      env_attr_map_cmp);
+
+	/* Keep only the last entry for each plain name */
+	for (i = 0, n = 0; i < map->count && !map->entries[i].regex; i++) {
+		if (n && !strcmp(map->entries[n - 1].name,
+				 map->entries[i].name)) {
+			free(map->entries[n - 1].name);
+			n--;
+		}
+		map->entries[n++] = map->entries[i];
+	}
+	map->num_names = n;
+	for (; i < map->count; i++)
+		map->entries[n++] = map->entries[i];
+	map->count = n;
+
+	return 0;
+}
+
+int env_attr_map_lookup(const struct env_attr_map *map, const char *name,
+	unsigned long *valuep)
+{
+	const struct env_attr_map_entry *found = NULL;
+	int lo = 0, hi = map->num_names;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int ret = strcmp(name, map->entries[mid].name);
+
+		if (!ret) {
+			found = &map->entries[mid];
+			break;
+		}
+		if (ret < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+#if defined(CONFIG_REGEX)
+	{
+		int i;
+
+		/* A regex listed after the plain name takes precedence */
+		for (i = map->count - 1; i >= map->num_names; i--) {
+			const struct env_attr_map_entry *ent = &map->entries[i];
+			struct slre *slre = ent->regex;
+			struct cap caps[slre->num_caps + 2];
+
+			if (found && ent->seq < found->seq)
+				break;
+			if (slre_match(slre, name, strlen(name), caps)) {
+				found = ent;
+				break;
+			}
+		}
+	}
+#endif
+
+	if (!found)
+		return -ENOENT;
+	*valuep = found->value;
+
+	return 0;
+}
+#endif
@@ -35,87 +35,76 @@ static struct env_clbk_tbl *find_env_callback(const char *name)
 	return NULL;
 }
 
-static int first_call = 1;
-static const char *callback_list;
+static struct env_attr_map callback_map;
+static int callback_map_valid;
 
 /*
- * Look for a possible callback for a newly added variable
- * This is called specifically when the variable did not exist in the hash
- * previously, so the blanket update did not find this variable.
+ * Convert the attributes of an association into a callback pointer. An
+ * empty association or an unknown callback name means no callback.
  */
-void env_callback_init(ENTRY *var_entry)
+static unsigned long callback_convert(const char *attributes)
 {
-	const char *var_name = var_entry->key;
-	char callback_name[256] = "";
 	struct env_clbk_tbl *clbkp;
-	int ret = 1;
 
-	if (first_call) {
-		callback_list = getenv(ENV_CALLBACK_VAR);
-		first_call = 0;
-	}
-
-	/* look in the ".callbacks" var for a reference to this variable */
-	if (callback_list != NULL)
-		ret = env_attr_lookup(callback_list, var_name, callback_name);
+	if (!strlen(attributes))
+		return 0;
 
-	/* only if not found there, look in the static list */
-	if (ret)
-		ret = env_attr_lookup(ENV_CALLBACK_LIST_STATIC, var_name,
-			callback_name);
+	clbkp = find_env_callback(attributes);
+	if (clbkp == NULL)
+		return 0;
 
-	/* if an association was found, set the callback pointer */
-	if (!ret && strlen(callback_name)) {
-		clbkp = find_env_callback(callback_name);
-		if (clbkp != NULL)
 #if defined(CONFIG_NEEDS_MANUAL_RELOC)
-			var_entry->callback = clbkp->callback + gd->reloc_off;
+	return (unsigned long)clbkp->callback + gd->reloc_off;
 #else
-			var_entry->callback = clbkp->callback;
+	return (unsigned long)clbkp->callback;
 #endif
-	}
 }
 
 /*
- * Called on each existing env var prior to the blanket update since removing
- * a callback association should remove its callback.
+ * Build the lookup table of callback associations from the static list and
+ * the ".callbacks" var, the latter taking precedence
  */
-static int clear_callback(ENTRY *entry)
+static void callback_map_update(const char *callback_list)
 {
-	entry->callback = NULL;
+	const char * const lists[] = {
+		ENV_CALLBACK_LIST_STATIC,
+		callback_list,
+	};
+
+	if (env_attr_map_build(&callback_map, lists, ARRAY_SIZE(lists),
+			       callback_convert))
+		printf("## Error: cannot build env callback table\n");
+	callback_map_valid = 1;
+}
 
-	return 0;
+static void set_callback(ENTRY *entry)
+{
+	unsigned long value = 0;
+
+	env_attr_map_lookup(&callback_map, entry->key, &value);
+	entry->callback = (void *)value;
 }
 
 /*
- * Call for each element in the list that associates variables to callbacks
+ * Look for a possible callback for a newly added variable
+ * This is called specifically when the variable did not exist in the hash
+ * previously, so the blanket update did not find this variable.
  */
-static int set_callback(const char *name, const char *value, void *priv)
+void env_callback_init(ENTRY *var_entry)
 {
-	ENTRY e, *ep;
-	struct env_clbk_tbl *clbkp;
+	if (!callback_map_valid)
+		callback_map_update(getenv(ENV_CALLBACK_VAR));
 
-	e.key	= name;
-	e.data	= NULL;
-	e.callback = NULL;
-	hsearch_r(e, FIND, &ep, &env_htab, 0);
-
-	/* does the env variable actually exist? */
-	if (ep != NULL) {
-		/* the assocaition delares no callback, so remove the pointer */
-		if (value == NULL || strlen(value) == 0)
-			ep->callback = NULL;
-		else {
-			/* assign the requested callback */
-			clbkp = find_env_callback(value);
-			if (clbkp != NULL)
-#if defined(CONFIG_NEEDS_MANUAL_RELOC)
-				ep->callback = clbkp->callback + gd->reloc_off;
-#else
-				ep->callback = clbkp->callback;
-#endif
-		}
-	}
+	set_callback(var_entry);
+}
+
+/*
+ * Called on each existing env var after the associations change since
+ * adding or removing an association should add or remove its callback.
+ */
+static int update_callback(ENTRY *entry)
+{
+	set_callback(entry);
 
 	return 0;
 }
@@ -123,13 +112,9 @@ static int set_callback(const char *name, const char *value, void *priv)
 static int on_callbacks(const char *name, const char *value, enum env_op op,
 	int flags)
 {
-	/* remove all callbacks */
-	hwalk_r(&env_htab, clear_callback);
-
-	/* configure any static callback bindings */
-	env_attr_walk(ENV_CALLBACK_LIST_STATIC, set_callback, NULL);
-	/* configure any dynamic callback bindings */
-	env_attr_walk(value, set_callback, NULL);
+	/* rebuild the bindings from the static and the new dynamic list */
+	callback_map_update(value);
+	hwalk_r(&env_htab, update_callback);
 
 	return 0;
 }
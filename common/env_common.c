@@ -97,7 +97,7 @@ char *getenv_default(const char *name)
 
 void set_default_env(const char *s)
 {
-	int flags = 0;
+	int flags = H_MERGE;
 
 	if (sizeof(default_environment) > ENV_SIZE) {
 		puts("*** Error - default environment is too large\n\n");
@@ -110,7 +110,7 @@ void set_default_env(const char *s)
 				"using default environment\n\n",
 				s + 1);
 		} else {
-			flags = H_INTERACTIVE;
+			flags |= H_INTERACTIVE;
 			puts(s);
 		}
 	} else {
@@ -213,7 +213,7 @@ int env_import(const char *buf, int check)
 		return ret;
 	}
 
-	if (himport_r(&env_htab, (char *)ep->data, ENV_SIZE, '\0', 0, 0,
+	if (himport_r(&env_htab, (char *)ep->data, ENV_SIZE, '\0', H_MERGE, 0,
 			0, NULL)) {
 		gd->flags |= GD_FLG_ENV_READY;
 		return 1;
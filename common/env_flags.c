@@ -411,64 +411,62 @@ static int env_parse_flags_to_bin(const char *flags)
 	return binflags;
 }
 
-static int first_call = 1;
-static const char *flags_list;
+static struct env_attr_map flags_map;
+static int flags_map_valid;
+
+static unsigned long flags_convert(const char *flags)
+{
+	if (!strlen(flags))
+		return 0;
+
+	return env_parse_flags_to_bin(flags);
+}
 
 /*
- * Look for possible flags for a newly added variable
- * This is called specifically when the variable did not exist in the hash
- * previously, so the blanket update did not find this variable.
+ * Build the lookup table of flags from the static list and the ".flags" var,
+ * the latter taking precedence
  */
-void env_flags_init(ENTRY *var_entry)
+static void flags_map_update(const char *flags_list)
 {
-	const char *var_name = var_entry->key;
-	char flags[ENV_FLAGS_ATTR_MAX_LEN + 1] = "";
-	int ret = 1;
+	const char * const lists[] = {
+		ENV_FLAGS_LIST_STATIC,
+		flags_list,
+	};
+
+	if (env_attr_map_build(&flags_map, lists, ARRAY_SIZE(lists),
+			       flags_convert))
+		printf("## Error: cannot build env flags table\n");
+	flags_map_valid = 1;
+}
 
-	if (first_call) {
-		flags_list = getenv(ENV_FLAGS_VAR);
-		first_call = 0;
-	}
-	/* look in the ".flags" and static for a reference to this variable */
-	ret = env_flags_lookup(flags_list, var_name, flags);
+static void set_flags(ENTRY *entry)
+{
+	unsigned long value = 0;
 
-	/* if any flags were found, set the binary form to the entry */
-	if (!ret && strlen(flags))
-		var_entry->flags = env_parse_flags_to_bin(flags);
+	env_attr_map_lookup(&flags_map, entry->key, &value);
+	entry->flags = value;
 }
 
 /*
- * Called on each existing env var prior to the blanket update since removing
- * a flag in the flag list should remove its flags.
+ * Look for possible flags for a newly added variable
+ * This is called specifically when the variable did not exist in the hash
+ * previously, so the blanket update did not find this variable.
  */
-static int clear_flags(ENTRY *entry)
+void env_flags_init(ENTRY *var_entry)
 {
-	entry->flags = 0;
+	if (!flags_map_valid)
+		flags_map_update(getenv(ENV_FLAGS_VAR));
 
-	return 0;
+	set_flags(var_entry);
 }
 
 /*
- * Call for each element in the list that defines flags for a variable
+ * Called on each existing env var after the flag list changes since adding
+ * or removing a flag in the flag list should add or remove its flags.
  */
-static int set_flags(const char *name, const char *value, void *priv)
+static int update_flags(ENTRY *entry)
 {
-	ENTRY e, *ep;
-
-	e.key	= name;
-	e.data	= NULL;
-	e.callback = NULL;
-	hsearch_r(e, FIND, &ep, &env_htab, 0);
-
-	/* does the env variable actually exist? */
-	if (ep != NULL) {
-		/* the flag list is empty, so clear the flags */
-		if (value == NULL || strlen(value) == 0)
-			ep->flags = 0;
-		else
-			/* assign the requested flags */
-			ep->flags = env_parse_flags_to_bin(value);
-	}
+	set_flags(entry);
 
 	return 0;
 }
@@ -476,13 +474,9 @@ static int set_flags(const char *name, const char *value, void *priv)
 static int on_flags(const char *name, const char *value, enum env_op op,
 	int flags)
 {
-	/* remove all flags */
-	hwalk_r(&env_htab, clear_flags);
-
-	/* configure any static flags */
-	env_attr_walk(ENV_FLAGS_LIST_STATIC, set_flags, NULL);
-	/* configure any dynamic flags */
-	env_attr_walk(value, set_flags, NULL);
+	/* rebuild the flags from the static and the new dynamic list */
+	flags_map_update(value);
+	hwalk_r(&env_htab, update_flags);
 
 	return 0;
 }
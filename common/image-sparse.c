@@ -49,27 +49,179 @@
 #define CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE (1024 * 512)
 #endif
 
+/*
+ * Chunks which land on adjacent blocks are not written one by one: runs of
+ * RAW chunks are gathered into a single write and runs of zero FILL chunks
+ * into a single erase where the storage supports it.
+ */
+struct sparse_ctx {
+	struct sparse_storage *info;
+	lbaint_t blk;			/* next block to write */
+	uint32_t *fill_buf;
+	uint32_t fill_val;		/* pattern in fill_buf */
+	int fill_buf_num_blks;
+	unsigned int run_type;		/* CHUNK_TYPE_RAW/FILL, 0 if none */
+	lbaint_t run_blkcnt;
+	void *run_data;
+};
+
+static int sparse_fill(struct sparse_ctx *ctx, lbaint_t blkcnt,
+		       uint32_t fill_val)
+{
+	struct sparse_storage *info = ctx->info;
+	lbaint_t blks;
+	lbaint_t i;
+	lbaint_t j;
+
+	if (!ctx->fill_buf) {
+		ctx->fill_buf = (uint32_t *)
+				memalign(ARCH_DMA_MINALIGN,
+					 ROUNDUP(
+					 info->blksz * ctx->fill_buf_num_blks,
+					 ARCH_DMA_MINALIGN));
+		if (!ctx->fill_buf) {
+			fastboot_fail("Malloc failed for: CHUNK_TYPE_FILL");
+			return -1;
+		}
+		ctx->fill_val = ~fill_val;
+	}
+
+	if (ctx->fill_val != fill_val) {
+		for (i = 0;
+		     i < (info->blksz * ctx->fill_buf_num_blks /
+			  sizeof(fill_val));
+		     i++)
+			ctx->fill_buf[i] = fill_val;
+		ctx->fill_val = fill_val;
+	}
+
+	for (i = 0; i < blkcnt;) {
+		j = blkcnt - i;
+		if (j > ctx->fill_buf_num_blks)
+			j = ctx->fill_buf_num_blks;
+		blks = info->write(info, ctx->blk, j, ctx->fill_buf);
+		/* blks might be > j (eg. NAND bad-blocks) */
+		if (blks < j) {
+			printf("%s: %s " LBAFU " [" LBAFU "]\n", __func__,
+			       "Write failed, block #", ctx->blk, j);
+			fastboot_fail("flash write failure");
+			return -1;
+		}
+		ctx->blk += blks;
+		i += j;
+	}
+
+	return 0;
+}
+
+static int sparse_zero(struct sparse_ctx *ctx, lbaint_t blkcnt)
+{
+	struct sparse_storage *info = ctx->info;
+	lbaint_t head, body;
+	u32 rem;
+
+	if (!info->erase || !info->erase_align)
+		return sparse_fill(ctx, blkcnt, 0);
+
+	/* Only whole erase groups are erased, the edges are written */
+	div_u64_rem(ctx->blk, info->erase_align, &rem);
+	head = rem ? info->erase_align - rem : 0;
+	if (head >= blkcnt)
+		return sparse_fill(ctx, blkcnt, 0);
+
+	div_u64_rem(blkcnt - head, info->erase_align, &rem);
+	body = blkcnt - head - rem;
+	if (!body)
+		return sparse_fill(ctx, blkcnt, 0);
+
+	if (sparse_fill(ctx, head, 0))
+		return -1;
+
+	if (info->erase(info, ctx->blk, body) == body) {
+		ctx->blk += body;
+	} else {
+		printf("%s: erase failed, block #" LBAFU ", writing zeros\n",
+		       __func__, ctx->blk);
+		if (sparse_fill(ctx, body, 0))
+			return -1;
+	}
+
+	return sparse_fill(ctx, rem, 0);
+}
+
+static int sparse_flush(struct sparse_ctx *ctx)
+{
+	struct sparse_storage *info = ctx->info;
+	unsigned int type = ctx->run_type;
+	lbaint_t blks;
+
+	ctx->run_type = 0;
+
+	switch (type) {
+	case CHUNK_TYPE_RAW:
+		blks = info->write(info, ctx->blk, ctx->run_blkcnt,
+				   ctx->run_data);
+		/* blks might be > blkcnt (eg. NAND bad-blocks) */
+		if (blks < ctx->run_blkcnt) {
+			printf("%s: %s" LBAFU " [" LBAFU "]\n",
+			       __func__, "Write failed, block #",
+			       ctx->blk, blks);
+			fastboot_fail("flash write failure");
+			return -1;
+		}
+		ctx->blk += blks;
+		break;
+
+	case CHUNK_TYPE_FILL:
+		return sparse_zero(ctx, ctx->run_blkcnt);
+	}
+
+	return 0;
+}
+
+static int sparse_run_add(struct sparse_ctx *ctx, unsigned int type,
+			  lbaint_t blkcnt, void *data)
+{
+	struct sparse_storage *info = ctx->info;
+	void *end;
+
+	if (ctx->run_type != type) {
+		if (sparse_flush(ctx))
+			return -1;
+		ctx->run_type = type;
+		ctx->run_blkcnt = 0;
+		ctx->run_data = data;
+	}
+
+	if (type == CHUNK_TYPE_RAW) {
+		/* Close the gap left by the chunk header */
+		end = ctx->run_data + ctx->run_blkcnt * info->blksz;
+		if (end != data)
+			memmove(end, data, blkcnt * info->blksz);
+	}
+	ctx->run_blkcnt += blkcnt;
+
+	return 0;
+}
+
 void write_sparse_image(
 		struct sparse_storage *info, const char *part_name,
 		void *data, unsigned sz)
 {
-	lbaint_t blk;
+	struct sparse_ctx ctx = { .info = info };
 	lbaint_t blkcnt;
-	lbaint_t blks;
 	uint32_t bytes_written = 0;
 	unsigned int chunk;
 	unsigned int offset;
 	unsigned int chunk_data_sz;
-	uint32_t *fill_buf = NULL;
+	unsigned int chunk_type;
 	uint32_t fill_val;
 	sparse_header_t *sparse_header;
 	chunk_header_t *chunk_header;
 	uint32_t total_blocks = 0;
-	int fill_buf_num_blks;
-	int i;
-	int j;
 
-	fill_buf_num_blks = CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE / info->blksz;
+	ctx.fill_buf_num_blks = CONFIG_FASTBOOT_FLASH_FILLBUF_SIZE /
+				info->blksz;
 
 	/* Read and skip over sparse image header */
 	sparse_header = (sparse_header_t *)data;
@@ -102,13 +254,13 @@ void write_sparse_image(
 		printf("%s: Sparse image block size issue [%u]\n",
 		       __func__, sparse_header->blk_sz);
 		fastboot_fail("sparse image block size issue");
-		return;
+		goto out;
 	}
 
 	puts("Flashing Sparse Image\n");
 
 	/* Start processing chunks */
-	blk = info->start;
+	ctx.blk = info->start;
 	for (chunk = 0; chunk < sparse_header->total_chunks; chunk++) {
 		/* Read and skip over chunk header */
 		chunk_header = (chunk_header_t *)data;
@@ -130,40 +282,17 @@ void write_sparse_image(
 				 sizeof(chunk_header_t));
 		}
 
+		chunk_type = chunk_header->chunk_type;
 		chunk_data_sz = sparse_header->blk_sz * chunk_header->chunk_sz;
 		blkcnt = chunk_data_sz / info->blksz;
-		switch (chunk_header->chunk_type) {
+		switch (chunk_type) {
 		case CHUNK_TYPE_RAW:
 			if (chunk_header->total_sz !=
 			    (sparse_header->chunk_hdr_sz + chunk_data_sz)) {
 				fastboot_fail(
 					"Bogus chunk size for chunk type Raw");
-				return;
+				goto out;
 			}
-
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				fastboot_fail(
-				    "Request would exceed partition size!");
-				return;
-			}
-
-			blks = info->write(info, blk, blkcnt, data);
-			/* blks might be > blkcnt (eg. NAND bad-blocks) */
-			if (blks < blkcnt) {
-				printf("%s: %s" LBAFU " [" LBAFU "]\n",
-				       __func__, "Write failed, block #",
-				       blk, blks);
-				fastboot_fail(
-					      "flash write failure");
-				return;
-			}
-			blk += blks;
-			bytes_written += blkcnt * info->blksz;
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
 			break;
 
 		case CHUNK_TYPE_FILL:
@@ -171,86 +300,82 @@ void write_sparse_image(
 			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t))) {
 				fastboot_fail(
 					"Bogus chunk size for chunk type FILL");
-				return;
+				goto out;
 			}
+			break;
 
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(
-						info->blksz * fill_buf_num_blks,
-						ARCH_DMA_MINALIGN));
-			if (!fill_buf) {
+		case CHUNK_TYPE_DONT_CARE:
+			break;
+
+		case CHUNK_TYPE_CRC32:
+			if (chunk_header->total_sz !=
+			    sparse_header->chunk_hdr_sz) {
 				fastboot_fail(
-					"Malloc failed for: CHUNK_TYPE_FILL");
-				return;
+					"Bogus chunk size for chunk type Dont Care");
+				goto out;
 			}
+			break;
 
-			fill_val = *(uint32_t *)data;
-			data = (char *)data + sizeof(uint32_t);
+		default:
+			printf("%s: Unknown chunk type: %x\n", __func__,
+			       chunk_type);
+			fastboot_fail("Unknown chunk type");
+			goto out;
+		}
 
-			for (i = 0;
-			     i < (info->blksz * fill_buf_num_blks /
-				  sizeof(fill_val));
-			     i++)
-				fill_buf[i] = fill_val;
+		if ((chunk_type == CHUNK_TYPE_RAW ||
+		     chunk_type == CHUNK_TYPE_FILL) &&
+		    ctx.blk + (ctx.run_type ? ctx.run_blkcnt : 0) + blkcnt >
+		    info->start + info->size) {
+			printf("%s: Request would exceed partition size!\n",
+			       __func__);
+			fastboot_fail("Request would exceed partition size!");
+			goto out;
+		}
 
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				fastboot_fail(
-				    "Request would exceed partition size!");
-				return;
-			}
+		switch (chunk_type) {
+		case CHUNK_TYPE_RAW:
+			/* The data is moved over the chunk header, if at all */
+			total_blocks += chunk_header->chunk_sz;
+			if (sparse_run_add(&ctx, CHUNK_TYPE_RAW, blkcnt, data))
+				goto out;
+			bytes_written += blkcnt * info->blksz;
+			data += chunk_data_sz;
+			break;
 
-			for (i = 0; i < blkcnt;) {
-				j = blkcnt - i;
-				if (j > fill_buf_num_blks)
-					j = fill_buf_num_blks;
-				blks = info->write(info, blk, j, fill_buf);
-				/* blks might be > j (eg. NAND bad-blocks) */
-				if (blks < j) {
-					printf("%s: %s " LBAFU " [%d]\n",
-					       __func__,
-					       "Write failed, block #",
-					       blk, j);
-					fastboot_fail(
-						      "flash write failure");
-					free(fill_buf);
-					return;
-				}
-				blk += blks;
-				i += j;
+		case CHUNK_TYPE_FILL:
+			fill_val = *(uint32_t *)data;
+			data = (char *)data + sizeof(uint32_t);
+
+			if (fill_val) {
+				if (sparse_flush(&ctx) ||
+				    sparse_fill(&ctx, blkcnt, fill_val))
+					goto out;
+			} else if (sparse_run_add(&ctx, CHUNK_TYPE_FILL,
+						  blkcnt, NULL)) {
+				goto out;
 			}
 			bytes_written += blkcnt * info->blksz;
 			total_blocks += chunk_data_sz / sparse_header->blk_sz;
-			free(fill_buf);
 			break;
 
 		case CHUNK_TYPE_DONT_CARE:
-			blk += info->reserve(info, blk, blkcnt);
+			if (sparse_flush(&ctx))
+				goto out;
+			ctx.blk += info->reserve(info, ctx.blk, blkcnt);
 			total_blocks += chunk_header->chunk_sz;
 			break;
 
 		case CHUNK_TYPE_CRC32:
-			if (chunk_header->total_sz !=
-			    sparse_header->chunk_hdr_sz) {
-				fastboot_fail(
-					"Bogus chunk size for chunk type Dont Care");
-				return;
-			}
 			total_blocks += chunk_header->chunk_sz;
 			data += chunk_data_sz;
 			break;
-
-		default:
-			printf("%s: Unknown chunk type: %x\n", __func__,
-			       chunk_header->chunk_type);
-			fastboot_fail("Unknown chunk type");
-			return;
 		}
 	}
 
+	if (sparse_flush(&ctx))
+		goto out;
+
 	debug("Wrote %d blocks, expected to write %d blocks\n",
 	      total_blocks, sparse_header->total_blks);
 	printf("........ wrote %u bytes to '%s'\n", bytes_written, part_name);
@@ -260,5 +385,6 @@ void write_sparse_image(
 	else
 		fastboot_okay("");
 
-	return;
+out:
+	free(ctx.fill_buf);
 }
@@ -0,0 +1,380 @@
+/*
+ * Tracking of malloc() allocations
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Each outstanding allocation is kept in a hash table indexed by its
+ * address, with the caller, size, time and the scope (command) that was
+ * running. Freeing the memory removes the record. Anything still in the
+ * table after a command finishes was either kept deliberately or leaked;
+ * running the command again tells the two apart.
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <malloc_trace.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct trace_rec - Information about an outstanding allocation
+ *
+ * @ptr:	Pointer returned by the allocator, NULL if this slot is empty
+ * @caller:	Address of the code which asked for the memory
+ * @size:	Number of bytes requested
+ * @time:	Time of the allocation in milliseconds
+ * @seq:	Sequence number, incremented for each allocation
+ * @scope:	Scope which made the allocation
+ * @flags:	Flags for the allocation (enum malloc_trace_flags)
+ */
+struct trace_rec {
+	void *ptr;
+	ulong caller;
+	u32 size;
+	u32 time;
+	u32 seq;
+	u8 scope;
+	u8 flags;
+};
+
+/* Keep the table no more than 3/4 full so that probe chains stay short */
+#define TRACE_MAX_RECS	(CONFIG_MALLOC_TRACE_COUNT * 3 / 4)
+
+static struct trace_rec trace_table[CONFIG_MALLOC_TRACE_COUNT];
+static struct malloc_trace_scope trace_scope[MALLOC_TRACE_SCOPES] = {
+	{ .name = "other" },
+};
+static struct malloc_trace_stats trace_stats;
+static int trace_num_scopes = 1;
+static int trace_cur_scope;
+static u32 trace_seq = 1;
+
+/*
+ * Set while the tracer itself is running. Reading the timer can probe the
+ * timer device, which allocates memory, so this stops recursion.
+ */
+static bool trace_busy;
+
+static uint trace_hash(void *ptr)
+{
+	return ((ulong)ptr >> 3) * 2654435761UL % CONFIG_MALLOC_TRACE_COUNT;
+}
+
+static inline uint trace_next(uint i)
+{
+	return i + 1 == CONFIG_MALLOC_TRACE_COUNT ? 0 : i + 1;
+}
+
+static struct trace_rec *trace_find(void *ptr)
+{
+	uint i;
+
+	for (i = trace_hash(ptr); trace_table[i].ptr; i = trace_next(i)) {
+		if (trace_table[i].ptr == ptr)
+			return &trace_table[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Remove a record, moving back any later records in the same probe chain
+ * so that lookups do not stop early at the hole
+ */
+static void trace_remove(struct trace_rec *rec)
+{
+	uint i = rec - trace_table;
+	uint j = i;
+	uint k;
+
+	for (;;) {
+		trace_table[i].ptr = NULL;
+		do {
+			j = trace_next(j);
+			if (!trace_table[j].ptr)
+				return;
+			k = trace_hash(trace_table[j].ptr);
+		} while (i <= j ? i < k && k <= j : i < k || k <= j);
+		trace_table[i] = trace_table[j];
+		i = j;
+	}
+}
+
+/* Add an allocation to its scope and to the totals */
+static void trace_count(struct trace_rec *rec)
+{
+	struct malloc_trace_scope *scope = &trace_scope[rec->scope];
+
+	scope->count++;
+	scope->bytes += rec->size;
+	scope->peak = max(scope->peak, scope->bytes);
+	trace_stats.count++;
+	trace_stats.bytes += rec->size;
+	trace_stats.peak = max(trace_stats.peak, trace_stats.bytes);
+	if (rec->flags & MALLOC_TRACE_DEVRES) {
+		trace_stats.devres_count++;
+		trace_stats.devres_bytes += rec->size;
+	}
+}
+
+static void trace_uncount(struct trace_rec *rec)
+{
+	struct malloc_trace_scope *scope = &trace_scope[rec->scope];
+
+	scope->count--;
+	scope->bytes -= rec->size;
+	trace_stats.count--;
+	trace_stats.bytes -= rec->size;
+	if (rec->flags & MALLOC_TRACE_DEVRES) {
+		trace_stats.devres_count--;
+		trace_stats.devres_bytes -= rec->size;
+	}
+}
+
+/* Get a slot for a new allocation, or NULL if the table is full */
+static struct trace_rec *trace_new(void *ptr)
+{
+	struct trace_rec *rec;
+	uint i;
+
+	rec = trace_find(ptr);
+	if (rec) {
+		/* The memory was freed without us seeing it */
+		trace_uncount(rec);
+		return rec;
+	}
+	if (trace_stats.count >= TRACE_MAX_RECS) {
+		trace_stats.dropped++;
+		return NULL;
+	}
+	for (i = trace_hash(ptr); trace_table[i].ptr; i = trace_next(i))
+		;
+
+	return &trace_table[i];
+}
+
+static bool trace_active(void)
+{
+	if (trace_busy)
+		return false;
+#ifdef CONFIG_SYS_MALLOC_F_LEN
+	/* Pre-relocation allocations are never freed */
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return false;
+#endif
+
+	return true;
+}
+
+void malloc_trace_alloc(void *ptr, size_t size, ulong caller)
+{
+	struct trace_rec *rec;
+
+	if (!ptr || !trace_active())
+		return;
+	trace_busy = true;
+	rec = trace_new(ptr);
+	if (rec) {
+		rec->ptr = ptr;
+		rec->caller = caller;
+		rec->size = size;
+		rec->time = get_timer(0);
+		rec->seq = trace_seq++;
+		rec->scope = trace_cur_scope;
+		rec->flags = 0;
+		trace_scope[rec->scope].allocs++;
+		trace_stats.allocs++;
+		trace_count(rec);
+	}
+	trace_busy = false;
+}
+
+void malloc_trace_realloc(void *oldptr, void *ptr, size_t size, ulong caller)
+{
+	struct trace_rec *rec, old;
+
+	if (!trace_active())
+		return;
+	rec = oldptr ? trace_find(oldptr) : NULL;
+	if (!rec) {
+		malloc_trace_alloc(ptr, size, caller);
+		return;
+	}
+
+	/* Keep the sequence number, so this does not look like a new leak */
+	old = *rec;
+	trace_uncount(rec);
+	trace_remove(rec);
+	if (!ptr)
+		return;
+	rec = trace_new(ptr);
+	if (rec) {
+		*rec = old;
+		rec->ptr = ptr;
+		rec->caller = caller;
+		rec->size = size;
+		trace_count(rec);
+	}
+}
+
+void malloc_trace_free(void *ptr)
+{
+	struct trace_rec *rec;
+
+	if (!ptr || trace_busy)
+		return;
+	rec = trace_find(ptr);
+	if (!rec)
+		return;
+	trace_uncount(rec);
+	trace_remove(rec);
+}
+
+void malloc_trace_set_caller(void *ptr, ulong caller, uint flags)
+{
+	struct trace_rec *rec;
+
+	if (!ptr)
+		return;
+	rec = trace_find(ptr);
+	if (!rec)
+		return;
+	trace_uncount(rec);
+	rec->caller = caller;
+	rec->flags |= flags;
+	trace_count(rec);
+}
+
+int malloc_trace_enter(const char *name)
+{
+	int prev = trace_cur_scope;
+	int i;
+
+	for (i = 1; i < trace_num_scopes; i++) {
+		if (!strcmp(trace_scope[i].name, name))
+			break;
+	}
+	if (i == trace_num_scopes) {
+		/* Charge anything beyond the last scope to 'other' */
+		if (trace_num_scopes == MALLOC_TRACE_SCOPES) {
+			i = 0;
+		} else {
+			trace_scope[i].name = name;
+			trace_num_scopes++;
+		}
+	}
+	trace_cur_scope = i;
+
+	return prev;
+}
+
+void malloc_trace_leave(int prev)
+{
+	trace_cur_scope = prev;
+}
+
+uint malloc_trace_mark(void)
+{
+	return trace_seq;
+}
+
+const struct malloc_trace_scope *malloc_trace_get_scope(int index)
+{
+	if (index < 0 || index >= trace_num_scopes)
+		return NULL;
+
+	return &trace_scope[index];
+}
+
+void malloc_trace_get_stats(struct malloc_trace_stats *stats)
+{
+	*stats = trace_stats;
+}
+
+static bool trace_match(struct trace_rec *rec, uint since, int scope)
+{
+	return rec->ptr && rec->seq >= since && (scope < 0 ||
+						 rec->scope == scope);
+}
+
+static int h_cmp_seq(const void *v1, const void *v2)
+{
+	const struct trace_rec *r1 = *(struct trace_rec **)v1;
+	const struct trace_rec *r2 = *(struct trace_rec **)v2;
+
+	return r1->seq < r2->seq ? -1 : r1->seq > r2->seq;
+}
+
+static void trace_show(struct trace_rec *rec)
+{
+	ulong caller = rec->caller;
+
+	/* Show the address in the symbol table, not the relocated one */
+#ifdef CONFIG_SANDBOX
+	/* Sandbox is position-independent and linked at address 0 */
+	caller -= (ulong)__executable_start;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		caller -= gd->reloc_off;
+#endif
+	printf("%8u %8u.%03u %0*lx %8x %0*lx %-12s%s\n", rec->seq,
+	       rec->time / 1000, rec->time % 1000, 2 * (int)sizeof(ulong),
+	       (ulong)rec->ptr, rec->size, 2 * (int)sizeof(ulong), caller,
+	       trace_scope[rec->scope].name,
+	       rec->flags & MALLOC_TRACE_DEVRES ? " devres" : "");
+}
+
+int malloc_trace_outstanding(uint since, const char *scope, bool show,
+			     ulong *bytesp)
+{
+	struct trace_rec **list;
+	int scope_num = -1;
+	ulong bytes = 0;
+	int count = 0;
+	uint i;
+
+	if (scope) {
+		for (i = 0; i < trace_num_scopes; i++) {
+			if (!strcmp(trace_scope[i].name, scope))
+				break;
+		}
+		if (i == trace_num_scopes)
+			goto done;
+		scope_num = i;
+	}
+	for (i = 0; i < CONFIG_MALLOC_TRACE_COUNT; i++) {
+		if (trace_match(&trace_table[i], since, scope_num)) {
+			count++;
+			bytes += trace_table[i].size;
+		}
+	}
+	if (!show || !count)
+		goto done;
+
+	/* Don't trace the list, since it would be counted as outstanding */
+	trace_busy = true;
+	list = malloc(count * sizeof(*list));
+	trace_busy = false;
+	if (!list)
+		return -ENOMEM;
+	for (i = 0, count = 0; i < CONFIG_MALLOC_TRACE_COUNT; i++) {
+		if (trace_match(&trace_table[i], since, scope_num))
+			list[count++] = &trace_table[i];
+	}
+	qsort(list, count, sizeof(*list), h_cmp_seq);
+	printf("%8s %12s %-*s %8s %-*s %-12s\n", "Seq", "Time", 2 *
+	       (int)sizeof(ulong), "Address", "Size", 2 * (int)sizeof(ulong),
+	       "Caller", "Scope");
+	for (i = 0; i < count; i++)
+		trace_show(list[i]);
+	free(list);
+done:
+	if (bytesp)
+		*bytesp = bytes;
+
+	return count;
+}
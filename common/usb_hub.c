@@ -51,10 +51,21 @@ DECLARE_GLOBAL_DATA_PTR;
 
 #define PORT_OVERCURRENT_MAX_SCAN_COUNT		3
 
+enum usb_scan_state {
+	USB_SCAN_CONNECT,		/* waiting for a connection */
+	USB_SCAN_RESET,			/* port reset in progress */
+};
+
 struct usb_device_scan {
 	struct usb_device *dev;		/* USB hub device to scan */
 	struct usb_hub_device *hub;	/* USB hub struct */
 	int port;			/* USB port to scan */
+	enum usb_scan_state state;
+	unsigned short portstatus;	/* port status when connected */
+	unsigned short portchange;
+	int reset_tries;
+	int reset_delay;		/* length of the current reset, ms */
+	ulong reset_timeout;		/* when to check the reset result */
 	struct list_head list;
 };
 
@@ -63,6 +74,12 @@ static struct usb_hub_device hub_dev[USB_MAX_HUB];
 static int usb_hub_index;
 static LIST_HEAD(usb_scan_list);
 
+/*
+ * The port which is being reset and enumerated. Only one device can answer
+ * to address 0, so all other ports wait for it before starting their reset.
+ */
+static struct usb_device_scan *usb_scan_resetting;
+
 __weak void usb_hub_reset_devices(int port)
 {
 	return;
@@ -160,6 +177,7 @@ static void usb_hub_power_on(struct usb_hub_device *hub)
 void usb_hub_reset(void)
 {
 	usb_hub_index = 0;
+	usb_scan_resetting = NULL;
 
 	/* Zero out global hub_dev in case its re-used again */
 	memset(hub_dev, 0, sizeof(hub_dev));
@@ -281,11 +299,15 @@ int hub_port_reset(struct udevice *dev, int port, unsigned short *portstat)
 }
 #endif
 
-int usb_hub_port_connect_change(struct usb_device *dev, int port)
+/*
+ * Acknowledge the connection change on a port, before it is reset. Returns
+ * -ENOTCONN if nothing is connected any more.
+ */
+static int usb_hub_port_connect_start(struct usb_device *dev, int port)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
 	unsigned short portstatus;
-	int ret, speed;
+	int ret;
 
 	/* Check status */
 	ret = usb_get_port_status(dev, port + 1, portsts);
@@ -313,13 +335,14 @@ int usb_hub_port_connect_change(struct usb_device *dev, int port)
 			return -ENOTCONN;
 	}
 
-	/* Reset the port */
-	ret = legacy_hub_port_reset(dev, port, &portstatus);
-	if (ret < 0) {
-		if (ret != -ENXIO)
-			printf("cannot reset port %i!?\n", port + 1);
-		return ret;
-	}
+	return 0;
+}
+
+/* Set up the new device on a port which has just been reset */
+static int usb_hub_port_enumerate(struct usb_device *dev, int port,
+				  unsigned short portstatus)
+{
+	int ret, speed;
 
 	switch (portstatus & USB_PORT_STAT_SPEED_MASK) {
 	case USB_PORT_STAT_SUPER_SPEED:
@@ -369,66 +392,60 @@ int usb_hub_port_connect_change(struct usb_device *dev, int port)
 	return ret;
 }
 
-static int usb_scan_port(struct usb_device_scan *usb_scan)
+int usb_hub_port_connect_change(struct usb_device *dev, int port)
 {
-	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
 	unsigned short portstatus;
-	unsigned short portchange;
-	struct usb_device *dev;
-	struct usb_hub_device *hub;
-	int ret = 0;
-	int i;
-
-	dev = usb_scan->dev;
-	hub = usb_scan->hub;
-	i = usb_scan->port;
+	int ret;
 
-	/*
-	 * Don't talk to the device before the query delay is expired.
-	 * This is needed for voltages to stabalize.
-	 */
-	if (get_timer(0) < hub->query_delay)
-		return 0;
+	ret = usb_hub_port_connect_start(dev, port);
+	if (ret)
+		return ret;
 
-	ret = usb_get_port_status(dev, i + 1, portsts);
+	/* Reset the port */
+	ret = legacy_hub_port_reset(dev, port, &portstatus);
 	if (ret < 0) {
-		debug("get_port_status failed\n");
-		if (get_timer(0) >= hub->connect_timeout) {
-			debug("devnum=%d port=%d: timeout\n",
-			      dev->devnum, i + 1);
-			/* Remove this device from scanning list */
-			list_del(&usb_scan->list);
-			free(usb_scan);
-			return 0;
-		}
-		return 0;
+		if (ret != -ENXIO)
+			printf("cannot reset port %i!?\n", port + 1);
+		return ret;
 	}
 
-	portstatus = le16_to_cpu(portsts->wPortStatus);
-	portchange = le16_to_cpu(portsts->wPortChange);
-	debug("Port %d Status %X Change %X\n", i + 1, portstatus, portchange);
+	return usb_hub_port_enumerate(dev, port, portstatus);
+}
 
-	/* No connection change happened, wait a bit more. */
-	if (!(portchange & USB_PORT_STAT_C_CONNECTION)) {
-		if (get_timer(0) >= hub->connect_timeout) {
-			debug("devnum=%d port=%d: timeout\n",
-			      dev->devnum, i + 1);
-			/* Remove this device from scanning list */
-			list_del(&usb_scan->list);
-			free(usb_scan);
-			return 0;
-		}
-		return 0;
-	}
+/*
+ * Issue a reset on the port being scanned. The port is looked at again once
+ * the reset time is up, in the meantime the other ports are scanned.
+ */
+static int usb_scan_reset_start(struct usb_device_scan *usb_scan)
+{
+	int ret;
 
-	/* Test if the connection came up, and if not exit */
-	if (!(portstatus & USB_PORT_STAT_CONNECTION))
-		return 0;
+	debug("%s: resetting hub %d port %d...\n", __func__,
+	      usb_scan->dev->devnum, usb_scan->port + 1);
+	ret = usb_set_port_feature(usb_scan->dev, usb_scan->port + 1,
+				   USB_PORT_FEAT_RESET);
+	if (ret < 0)
+		return ret;
 
-	/* A new USB device is ready at this point */
-	debug("devnum=%d port=%d: USB dev found\n", dev->devnum, i + 1);
+	usb_scan->state = USB_SCAN_RESET;
+	usb_scan->reset_timeout = get_timer(0) + usb_scan->reset_delay;
 
-	usb_hub_port_connect_change(dev, i);
+	return 0;
+}
+
+/*
+ * Finish with a port once its device has been set up (or failed to). The
+ * port is dropped from the scanning list unless it has to be scanned again.
+ */
+static int usb_scan_port_done(struct usb_device_scan *usb_scan)
+{
+	unsigned short portstatus = usb_scan->portstatus;
+	unsigned short portchange = usb_scan->portchange;
+	struct usb_device *dev = usb_scan->dev;
+	struct usb_hub_device *hub = usb_scan->hub;
+	int i = usb_scan->port;
+
+	usb_scan->state = USB_SCAN_CONNECT;
 
 	if (portchange & USB_PORT_STAT_C_ENABLE) {
 		debug("port %d enable change, status %x\n", i + 1, portstatus);
@@ -494,6 +511,141 @@ static int usb_scan_port(struct usb_device_scan *usb_scan)
 	return 0;
 }
 
+/*
+ * Check on a port being reset. Once the port is enabled, the device is set up
+ * and the next port may be reset.
+ */
+static int usb_scan_port_reset(struct usb_device_scan *usb_scan)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
+	unsigned short portstatus;
+	struct usb_device *dev = usb_scan->dev;
+	int i = usb_scan->port;
+	int ret;
+
+	if (get_timer(0) < usb_scan->reset_timeout)
+		return 0;
+
+	ret = usb_get_port_status(dev, i + 1, portsts);
+	if (ret < 0) {
+		debug("get_port_status failed status %lX\n", dev->status);
+		goto out;
+	}
+	portstatus = le16_to_cpu(portsts->wPortStatus);
+	debug("portstatus %x, change %x, %s\n", portstatus,
+	      le16_to_cpu(portsts->wPortChange), portspeed(portstatus));
+
+	/* See legacy_hub_port_reset() on why nothing else is checked */
+	if (!(portstatus & USB_PORT_STAT_ENABLE)) {
+		if (++usb_scan->reset_tries < MAX_TRIES) {
+			/* Switch to long reset delay for the next round */
+			usb_scan->reset_delay = HUB_LONG_RESET_TIME;
+			ret = usb_scan_reset_start(usb_scan);
+			if (!ret)
+				return 0;
+		} else {
+			debug("Cannot enable port %i after %i retries, disabling port.\n",
+			      i + 1, MAX_TRIES);
+			debug("Maybe the USB cable is bad?\n");
+			ret = -1;
+		}
+		goto out;
+	}
+
+	usb_clear_port_feature(dev, i + 1, USB_PORT_FEAT_C_RESET);
+	/* Record when the first device was ready */
+	if (!usb_hub_port_enumerate(dev, i, portstatus))
+		bootstage_mark_name(BOOTSTAGE_ID_USB_DEV, "usb_dev");
+out:
+	if (ret < 0)
+		printf("cannot reset port %i!?\n", i + 1);
+	usb_scan_resetting = NULL;
+
+	return usb_scan_port_done(usb_scan);
+}
+
+static int usb_scan_port(struct usb_device_scan *usb_scan)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct usb_port_status, portsts, 1);
+	unsigned short portstatus;
+	unsigned short portchange;
+	struct usb_device *dev;
+	struct usb_hub_device *hub;
+	int ret = 0;
+	int i;
+
+	if (usb_scan->state == USB_SCAN_RESET)
+		return usb_scan_port_reset(usb_scan);
+
+	dev = usb_scan->dev;
+	hub = usb_scan->hub;
+	i = usb_scan->port;
+
+	/*
+	 * Don't talk to the device before the query delay is expired.
+	 * This is needed for voltages to stabalize.
+	 */
+	if (get_timer(0) < hub->query_delay)
+		return 0;
+
+	ret = usb_get_port_status(dev, i + 1, portsts);
+	if (ret < 0) {
+		debug("get_port_status failed\n");
+		if (get_timer(0) >= hub->connect_timeout) {
+			debug("devnum=%d port=%d: timeout\n",
+			      dev->devnum, i + 1);
+			/* Remove this device from scanning list */
+			list_del(&usb_scan->list);
+			free(usb_scan);
+			return 0;
+		}
+		return 0;
+	}
+
+	portstatus = le16_to_cpu(portsts->wPortStatus);
+	portchange = le16_to_cpu(portsts->wPortChange);
+	debug("Port %d Status %X Change %X\n", i + 1, portstatus, portchange);
+
+	/* No connection change happened, wait a bit more. */
+	if (!(portchange & USB_PORT_STAT_C_CONNECTION)) {
+		if (get_timer(0) >= hub->connect_timeout) {
+			debug("devnum=%d port=%d: timeout\n",
+			      dev->devnum, i + 1);
+			/* Remove this device from scanning list */
+			list_del(&usb_scan->list);
+			free(usb_scan);
+			return 0;
+		}
+		return 0;
+	}
+
+	/* Test if the connection came up, and if not exit */
+	if (!(portstatus & USB_PORT_STAT_CONNECTION))
+		return 0;
+
+	/* Wait until no other port is using address 0 */
+	if (usb_scan_resetting)
+		return 0;
+
+	/* A new USB device is ready at this point */
+	debug("devnum=%d port=%d: USB dev found\n", dev->devnum, i + 1);
+
+	usb_scan->portstatus = portstatus;
+	usb_scan->portchange = portchange;
+	if (usb_hub_port_connect_start(dev, i))
+		return usb_scan_port_done(usb_scan);
+
+	usb_scan->reset_tries = 0;
+	usb_scan->reset_delay = HUB_SHORT_RESET_TIME;
+	if (usb_scan_reset_start(usb_scan) < 0) {
+		printf("cannot reset port %i!?\n", i + 1);
+		return usb_scan_port_done(usb_scan);
+	}
+	usb_scan_resetting = usb_scan;
+
+	return 0;
+}
+
 static int usb_device_list_scan(void)
 {
 	struct usb_device_scan *usb_scan;
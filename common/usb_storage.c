@@ -58,7 +58,7 @@
 static const unsigned char us_direction[256/8] = {
 	0x28, 0x81, 0x14, 0x14, 0x20, 0x01, 0x90, 0x77,
 	0x0C, 0x20, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01,
+	0x00, 0x01, 0x00, 0x40, 0x00, 0x01, 0x00, 0x01,
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 #define US_DIRECTION(x) ((us_direction[x>>3] >> (x & 7)) & 1)
@@ -98,6 +98,7 @@ struct us_data {
 	ccb		*srb;			/* current srb */
 	trans_reset	transport_reset;	/* reset routine */
 	trans_cmnd	transport;		/* transport routine */
+	size_t		max_xfer_size;		/* host limit, 0 if unknown */
 };
 
 #ifdef CONFIG_USB_EHCI
@@ -111,6 +112,21 @@ struct us_data {
 #define USB_MAX_XFER_BLK	20
 #endif
 
+/*
+ * Maximum number of blocks in one READ/WRITE command. Host controllers which
+ * report their transfer limit (e.g. xHCI, which queues a transfer as one TD of
+ * up to several MB) get transfers as large as they can handle.
+ */
+static unsigned short usb_stor_max_xfer_blk(struct us_data *ss,
+					    struct blk_desc *block_dev)
+{
+	if (!ss->max_xfer_size)
+		return USB_MAX_XFER_BLK;
+
+	return clamp_t(size_t, ss->max_xfer_size / block_dev->blksz, 1,
+		       USHRT_MAX);
+}
+
 #ifndef CONFIG_BLK
 static struct us_data usb_stor[USB_MAX_STOR_DEV];
 #endif
@@ -1043,6 +1059,64 @@ static int usb_read_capacity(ccb *srb, struct us_data *ss)
 	return -1;
 }
 
+#ifdef CONFIG_SYS_64BIT_LBA
+static int usb_read_capacity_16(ccb *srb, struct us_data *ss)
+{
+	int retry;
+
+	retry = 3;
+	do {
+		memset(&srb->cmd[0], 0, 16);
+		srb->cmd[0] = SCSI_RD_CAPAC16;
+		srb->cmd[1] = 0x10;	/* SERVICE ACTION IN: READ CAPACITY */
+		srb->cmd[13] = 16;
+		srb->datalen = 16;
+		srb->cmdlen = 16;
+		if (ss->transport(srb, ss) == USB_STOR_TRANSPORT_GOOD)
+			return 0;
+	} while (retry--);
+
+	return -1;
+}
+#endif
+
+/* READ(10) and WRITE(10) can only address the first 2^32 blocks */
+static bool usb_need_16(lbaint_t start, unsigned short blocks)
+{
+	return (u64)start + blocks > 0x100000000ULL;
+}
+
+static void usb_setup_16(ccb *srb, unsigned char opcode, lbaint_t start,
+			 unsigned short blocks)
+{
+	u64 lba = start;
+	int i;
+
+	memset(&srb->cmd[0], 0, 16);
+	srb->cmd[0] = opcode;
+	for (i = 0; i < 8; i++)
+		srb->cmd[2 + i] = (unsigned char)(lba >> (56 - 8 * i));
+	srb->cmd[12] = ((unsigned char) (blocks >> 8)) & 0xff;
+	srb->cmd[13] = (unsigned char) blocks & 0xff;
+	srb->cmdlen = 16;
+}
+
+static int usb_read_16(ccb *srb, struct us_data *ss, lbaint_t start,
+		       unsigned short blocks)
+{
+	usb_setup_16(srb, SCSI_READ16, start, blocks);
+	debug("read16: start " LBAF " blocks %x\n", start, blocks);
+	return ss->transport(srb, ss);
+}
+
+static int usb_write_16(ccb *srb, struct us_data *ss, lbaint_t start,
+			unsigned short blocks)
+{
+	usb_setup_16(srb, SCSI_WRITE16, start, blocks);
+	debug("write16: start " LBAF " blocks %x\n", start, blocks);
+	return ss->transport(srb, ss);
+}
+
 static int usb_read_10(ccb *srb, struct us_data *ss, unsigned long start,
 		       unsigned short blocks)
 {
@@ -1111,10 +1185,10 @@ static unsigned long usb_stor_read(struct blk_desc *block_dev, lbaint_t blknr,
 {
 	lbaint_t start, blks;
 	uintptr_t buf_addr;
-	unsigned short smallblks;
+	unsigned short smallblks, max_blks;
 	struct usb_device *udev;
 	struct us_data *ss;
-	int retry;
+	int retry, ret;
 	ccb *srb = &usb_ccb;
 #ifdef CONFIG_BLK
 	struct blk_desc *block_dev;
@@ -1142,6 +1216,7 @@ static unsigned long usb_stor_read(struct blk_desc *block_dev, lbaint_t blknr,
 	buf_addr = (uintptr_t)buffer;
 	start = blknr;
 	blks = blkcnt;
+	max_blks = usb_stor_max_xfer_blk(ss, block_dev);
 
 	debug("\nusb_read: dev %d startblk " LBAF ", blccnt " LBAF " buffer %"
 	      PRIxPTR "\n", block_dev->devnum, start, blks, buf_addr);
@@ -1150,16 +1225,20 @@ static unsigned long usb_stor_read(struct blk_desc *block_dev, lbaint_t blknr,
 		/* XXX need some comment here */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_XFER_BLK)
-			smallblks = USB_MAX_XFER_BLK;
+		if (blks > max_blks)
+			smallblks = max_blks;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_XFER_BLK)
+		if (smallblks == max_blks)
 			usb_show_progress();
 		srb->datalen = block_dev->blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_read_10(srb, ss, start, smallblks)) {
+		if (usb_need_16(start, smallblks))
+			ret = usb_read_16(srb, ss, start, smallblks);
+		else
+			ret = usb_read_10(srb, ss, start, smallblks);
+		if (ret) {
 			debug("Read ERROR\n");
 			usb_request_sense(srb, ss);
 			if (retry--)
@@ -1178,7 +1257,7 @@ retry_it:
 	      start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_XFER_BLK)
+	if (blkcnt >= max_blks)
 		debug("\n");
 	return blkcnt;
 }
@@ -1193,10 +1272,10 @@ static unsigned long usb_stor_write(struct blk_desc *block_dev, lbaint_t blknr,
 {
 	lbaint_t start, blks;
 	uintptr_t buf_addr;
-	unsigned short smallblks;
+	unsigned short smallblks, max_blks;
 	struct usb_device *udev;
 	struct us_data *ss;
-	int retry;
+	int retry, ret;
 	ccb *srb = &usb_ccb;
 #ifdef CONFIG_BLK
 	struct blk_desc *block_dev;
@@ -1226,6 +1305,7 @@ static unsigned long usb_stor_write(struct blk_desc *block_dev, lbaint_t blknr,
 	buf_addr = (uintptr_t)buffer;
 	start = blknr;
 	blks = blkcnt;
+	max_blks = usb_stor_max_xfer_blk(ss, block_dev);
 
 	debug("\nusb_write: dev %d startblk " LBAF ", blccnt " LBAF " buffer %"
 	      PRIxPTR "\n", block_dev->devnum, start, blks, buf_addr);
@@ -1236,16 +1316,20 @@ static unsigned long usb_stor_write(struct blk_desc *block_dev, lbaint_t blknr,
 		 */
 		retry = 2;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (blks > USB_MAX_XFER_BLK)
-			smallblks = USB_MAX_XFER_BLK;
+		if (blks > max_blks)
+			smallblks = max_blks;
 		else
 			smallblks = (unsigned short) blks;
 retry_it:
-		if (smallblks == USB_MAX_XFER_BLK)
+		if (smallblks == max_blks)
 			usb_show_progress();
 		srb->datalen = block_dev->blksz * smallblks;
 		srb->pdata = (unsigned char *)buf_addr;
-		if (usb_write_10(srb, ss, start, smallblks)) {
+		if (usb_need_16(start, smallblks))
+			ret = usb_write_16(srb, ss, start, smallblks);
+		else
+			ret = usb_write_10(srb, ss, start, smallblks);
+		if (ret) {
 			debug("Write ERROR\n");
 			usb_request_sense(srb, ss);
 			if (retry--)
@@ -1263,7 +1347,7 @@ retry_it:
 	      PRIxPTR "\n", start, smallblks, buf_addr);
 
 	usb_disable_asynch(0); /* asynch transfer allowed */
-	if (blkcnt >= USB_MAX_XFER_BLK)
+	if (blkcnt >= max_blks)
 		debug("\n");
 	return blkcnt;
 
@@ -1384,6 +1468,11 @@ int usb_storage_probe(struct usb_device *dev, unsigned int ifnum,
 		ss->irqmaxp = usb_maxpacket(dev, ss->irqpipe);
 		dev->irq_handle = usb_stor_irq;
 	}
+#ifdef CONFIG_DM_USB
+	/* Ask the host controller how much it can move in one transfer */
+	if (usb_get_max_xfer_size(dev, &ss->max_xfer_size))
+		ss->max_xfer_size = 0;
+#endif
 	dev->privptr = (void *)ss;
 	return 1;
 }
@@ -1392,9 +1481,10 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 		      struct blk_desc *dev_desc)
 {
 	unsigned char perq, modi;
-	ALLOC_CACHE_ALIGN_BUFFER(u32, cap, 2);
+	ALLOC_CACHE_ALIGN_BUFFER(u32, cap, 4);
 	ALLOC_CACHE_ALIGN_BUFFER(u8, usb_stor_buf, 36);
-	u32 capacity, blksz;
+	lbaint_t capacity;
+	u32 blksz;
 	ccb *pccb = &usb_ccb;
 
 	pccb->pdata = usb_stor_buf;
@@ -1464,7 +1554,19 @@ int usb_stor_get_info(struct usb_device *dev, struct us_data *ss,
 	capacity = be32_to_cpu(cap[0]) + 1;
 	blksz = be32_to_cpu(cap[1]);
 
-	debug("Capacity = 0x%08x, blocksz = 0x%08x\n", capacity, blksz);
+#ifdef CONFIG_SYS_64BIT_LBA
+	/* Too large for READ CAPACITY(10), so ask for the 64-bit value */
+	if (be32_to_cpu(cap[0]) == 0xffffffff) {
+		memset(pccb->pdata, 0, 16);
+		if (usb_read_capacity_16(pccb, ss) == 0) {
+			capacity = ((lbaint_t)be32_to_cpu(cap[0]) << 32 |
+				    be32_to_cpu(cap[1])) + 1;
+			blksz = be32_to_cpu(cap[2]);
+		}
+	}
+#endif
+
+	debug("Capacity = " LBAF ", blocksz = 0x%08x\n", capacity, blksz);
 	dev_desc->lba = capacity;
 	dev_desc->blksz = blksz;
 	dev_desc->log2blksz = LOG2(dev_desc->blksz);
@@ -292,7 +292,7 @@ static void *alloc_priv(int size, uint flags)
 	return priv;
 }
 
-int device_probe(struct udevice *dev)
+static int device_do_probe(struct udevice *dev)
 {
 	const struct driver *drv;
 	int size = 0;
@@ -419,6 +419,25 @@ fail:
 	return ret;
 }
 
+int device_probe(struct udevice *dev)
+{
+	int span;
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	if (dev->flags & DM_FLAG_ACTIVATED)
+		return 0;
+
+	/* The span includes the probe of any parents not yet probed */
+	span = bootstage_span_start(BOOTSTAGE_SPAN_DM, dev->name);
+	ret = device_do_probe(dev);
+	bootstage_span_end(span);
+
+	return ret;
+}
+
 void *dev_get_platdata(struct udevice *dev)
 {
 	if (!dev) {
@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <malloc_trace.h>
 #include <linux/compat.h>
 #include <linux/kernel.h>
 #include <linux/list.h>
@@ -68,6 +69,7 @@ void *_devres_alloc(dr_release_t release, size_t size, gfp_t gfp)
 	dr = kmalloc(tot_size, gfp);
 	if (unlikely(!dr))
 		return NULL;
+	malloc_trace_set_caller(dr, _RET_IP_, MALLOC_TRACE_DEVRES);
 
 	INIT_LIST_HEAD(&dr->entry);
 	dr->release = release;
@@ -244,6 +246,8 @@ void *devm_kmalloc(struct udevice *dev, size_t size, gfp_t gfp)
 	data = _devres_alloc(devm_kmalloc_release, size, gfp);
 	if (unlikely(!data))
 		return NULL;
+	malloc_trace_set_caller(container_of(data, struct devres, data),
+				_RET_IP_, 0);
 
 	devres_add(dev, data);
 
@@ -8,6 +8,7 @@
  */
 
 #include <common.h>
+#include <div64.h>
 #include <errno.h>
 #include <malloc.h>
 #include <mmc.h>
@@ -132,6 +133,29 @@ static char *dfu_get_hash_algo(void)
 	return NULL;
 }
 
+static int dfu_write_medium(struct dfu_entity *dfu, void *buf, long w_size)
+{
+	ulong start;
+	int ret;
+
+	if (dfu_hash_algo)
+		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
+					   buf, w_size, 0);
+
+	start = get_timer(0);
+	ret = dfu->write_medium(dfu, dfu->offset, buf, &w_size);
+	if (ret)
+		debug("%s: Write error!\n", __func__);
+	dfu->write_time += get_timer(start);
+
+	/* update offset */
+	dfu->offset += w_size;
+
+	puts("#");
+
+	return ret;
+}
+
 static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 {
 	long w_size;
@@ -142,23 +166,25 @@ static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 	if (w_size == 0)
 		return 0;
 
-	if (dfu_hash_algo)
-		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
-					   dfu->i_buf_start, w_size, 0);
-
-	ret = dfu->write_medium(dfu, dfu->offset, dfu->i_buf_start, &w_size);
-	if (ret)
-		debug("%s: Write error!\n", __func__);
+	ret = dfu_write_medium(dfu, dfu->i_buf_start, w_size);
 
 	/* point back */
 	dfu->i_buf = dfu->i_buf_start;
 
-	/* update offset */
-	dfu->offset += w_size;
+	return ret;
+}
 
-	puts("#");
+static void dfu_show_stats(struct dfu_entity *dfu)
+{
+	ulong time = get_timer(dfu->start_time);
 
-	return ret;
+	if (!dfu->offset)
+		return;
+
+	printf("\nDFU %s: %llu bytes in %lu ms", dfu->name, dfu->offset, time);
+	if (time)
+		printf(" (%llu kB/s)", lldiv(dfu->offset, time));
+	printf(", %lu ms writing the medium\n", dfu->write_time);
 }
 
 void dfu_write_transaction_cleanup(struct dfu_entity *dfu)
@@ -181,8 +207,15 @@ int dfu_flush(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	if (ret)
 		return ret;
 
-	if (dfu->flush_medium)
+	if (dfu->flush_medium) {
+		ulong start = get_timer(0);
+
 		ret = dfu->flush_medium(dfu);
+		dfu->write_time += get_timer(start);
+	}
+
+	if (!ret)
+		dfu_show_stats(dfu);
 
 	if (dfu_hash_algo)
 		printf("\nDFU complete %s: 0x%08x\n", dfu_hash_algo->name,
@@ -193,14 +226,8 @@ int dfu_flush(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	return ret;
 }
 
-int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
+static int dfu_write_start(struct dfu_entity *dfu, int blk_seq_num)
 {
-	int ret;
-
-	debug("%s: name: %s buf: 0x%p size: 0x%x p_num: 0x%x offset: 0x%llx bufoffset: 0x%lx\n",
-	      __func__, dfu->name, buf, size, blk_seq_num, dfu->offset,
-	      (unsigned long)(dfu->i_buf - dfu->i_buf_start));
-
 	if (!dfu->inited) {
 		/* initial state */
 		dfu->crc = 0;
@@ -212,6 +239,8 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 			return -ENOMEM;
 		dfu->i_buf_end = dfu_get_buf(dfu) + dfu_buf_size;
 		dfu->i_buf = dfu->i_buf_start;
+		dfu->start_time = get_timer(0);
+		dfu->write_time = 0;
 
 		dfu->inited = 1;
 	}
@@ -223,6 +252,46 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 		return -1;
 	}
 
+	return 0;
+}
+
+int dfu_write_unbuffered(struct dfu_entity *dfu, void *buf, int size,
+			 int blk_seq_num)
+{
+	int ret;
+
+	debug("%s: name: %s buf: 0x%p size: 0x%x p_num: 0x%x offset: 0x%llx\n",
+	      __func__, dfu->name, buf, size, blk_seq_num, dfu->offset);
+
+	ret = dfu_write_start(dfu, blk_seq_num);
+	if (ret)
+		return ret;
+
+	/* handle rollover, see dfu_write() */
+	dfu->i_blk_seq_num = (dfu->i_blk_seq_num + 1) & 0xffff;
+
+	/* Anything still in the DFU buffer comes first */
+	ret = dfu_write_buffer_drain(dfu);
+	if (!ret && size)
+		ret = dfu_write_medium(dfu, buf, size);
+	if (ret)
+		dfu_write_transaction_cleanup(dfu);
+
+	return ret;
+}
+
+int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
+{
+	int ret;
+
+	debug("%s: name: %s buf: 0x%p size: 0x%x p_num: 0x%x offset: 0x%llx bufoffset: 0x%lx\n",
+	      __func__, dfu->name, buf, size, blk_seq_num, dfu->offset,
+	      (unsigned long)(dfu->i_buf - dfu->i_buf_start));
+
+	ret = dfu_write_start(dfu, blk_seq_num);
+	if (ret)
+		return ret;
+
 	/* DFU 1.1 standard says:
 	 * The wBlockNum field is a block sequence number. It increments each
 	 * time a block is transferred, wrapping to zero from 65,535. It is used
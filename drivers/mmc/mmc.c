@@ -926,6 +926,9 @@ retry_scr:
 	mmc->scr[0] = __be32_to_cpu(scr[0]);
 	mmc->scr[1] = __be32_to_cpu(scr[1]);
 
+	if (!(mmc->scr[0] & SD_DATA_STAT_AFTER_ERASE))
+		mmc->erased_byte = 0;
+
 	switch ((mmc->scr[0] >> 24) & 0xf) {
 	case 0:
 		mmc->version = SD_VERSION_1_0;
@@ -1260,6 +1263,8 @@ static int mmc_startup(struct mmc *mmc)
 	 */
 	mmc->erase_grp_size = 1;
 	mmc->part_config = MMCPART_NOAVAILABLE;
+	/* Assume erased blocks read as ones unless the card tells otherwise */
+	mmc->erased_byte = 0xff;
 	if (!IS_SD(mmc) && (mmc->version >= MMC_VERSION_4)) {
 		/* check  ext_csd version and capacity */
 		err = mmc_send_ext_csd(mmc, ext_csd);
@@ -1408,6 +1413,10 @@ static int mmc_startup(struct mmc *mmc)
 			* ext_csd[EXT_CSD_HC_WP_GRP_SIZE];
 
 		mmc->wr_rel_set = ext_csd[EXT_CSD_WR_REL_SET];
+
+		if (ext_csd[EXT_CSD_REV] >= 3 &&
+		    !ext_csd[EXT_CSD_ERASED_MEM_CONT])
+			mmc->erased_byte = 0;
 	}
 
 	err = mmc_set_capacity(mmc, mmc_get_blk_desc(mmc)->hwpart);
@@ -1498,6 +1498,49 @@ static int nand_setup_read_retry(struct mtd_info *mtd, int retry_mode)
 	return chip->setup_read_retry(mtd, retry_mode);
 }
 
+/**
+ * nand_cache_read_last - [INTERN] find the end of a cache read sequence
+ * @mtd: MTD device structure
+ * @page: page to start the sequence with
+ * @readlen: number of bytes left to read, starting at @page
+ *
+ * A cache read sequence loads the next page into the chip's data register
+ * while the current one is transferred and corrected. It covers full pages
+ * only and stays within the erase block of @page. Returns the last page of
+ * the sequence, or -1 if a sequence is not worth starting.
+ */
+static int nand_cache_read_last(struct mtd_info *mtd, int page,
+				uint32_t readlen)
+{
+	struct nand_chip *chip = mtd_to_nand(mtd);
+	int ppb = 1 << (chip->phys_erase_shift - chip->page_shift);
+	int last;
+
+	if (!NAND_HAS_CACHEREAD(chip))
+		return -1;
+
+	last = page + (readlen >> chip->page_shift) - 1;
+	last = min(last, page | (ppb - 1));
+
+	return last > page ? last : -1;
+}
+
+/**
+ * nand_cache_read_end - [INTERN] terminate a cache read sequence early
+ * @mtd: MTD device structure
+ * @cache_last: last page of the sequence, -1 if none is running
+ */
+static void nand_cache_read_end(struct mtd_info *mtd, int *cache_last)
+{
+	struct nand_chip *chip = mtd_to_nand(mtd);
+
+	if (*cache_last < 0)
+		return;
+
+	chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+	*cache_last = -1;
+}
+
 /**
  * nand_do_read_ops - [INTERN] Read data with ECC
  * @mtd: MTD device structure
@@ -1521,6 +1564,7 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	unsigned int max_bitflips = 0;
 	int retry_mode = 0;
 	bool ecc_fail = false;
+	int cache_last = -1;
 
 	chipnr = (int)(from >> chip->chip_shift);
 	chip->select_chip(mtd, chipnr);
@@ -1555,7 +1599,32 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 						 __func__, buf);
 
 read_retry:
-			chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+			if (cache_last >= 0) {
+				/* Page is already being loaded by the chip */
+				if (page == cache_last) {
+					chip->cmdfunc(mtd, NAND_CMD_READCACHEEND,
+						      -1, -1);
+					cache_last = -1;
+				} else {
+					chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ,
+						      -1, -1);
+				}
+			} else {
+				chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+
+				if (!col && !retry_mode)
+					cache_last = nand_cache_read_last(mtd,
+								page, readlen);
+				if (cache_last >= 0) {
+					/* Pages ahead must come from the chip */
+					if (chip->pagebuf > realpage &&
+					    chip->pagebuf <= realpage +
+					    cache_last - page)
+						chip->pagebuf = -1;
+					chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ,
+						      -1, -1);
+				}
+			}
 
 			/*
 			 * Now read the page into the buffer.  Absent an error,
@@ -1616,6 +1685,8 @@ read_retry:
 
 			if (mtd->ecc_stats.failed - ecc_failures) {
 				if (retry_mode + 1 < chip->read_retries) {
+					/* The page has to be read again */
+					nand_cache_read_end(mtd, &cache_last);
 					retry_mode++;
 					ret = nand_setup_read_retry(mtd,
 							retry_mode);
@@ -1665,6 +1736,7 @@ read_retry:
 			chip->select_chip(mtd, chipnr);
 		}
 	}
+	nand_cache_read_end(mtd, &cache_last);
 	chip->select_chip(mtd, -1);
 
 	ops->retlen = ops->len - (size_t) readlen;
@@ -4184,6 +4256,26 @@ int nand_scan_tail(struct mtd_info *mtd)
 		break;
 	}
 
+#ifdef CONFIG_SYS_NAND_CACHE_READ
+	/*
+	 * The cache read commands are only known to the generic command and
+	 * page read functions, drivers replacing them have to set
+	 * NAND_CACHEREAD themselves.
+	 */
+	if (mtd->writesize > 512 && chip->cmdfunc == nand_command_lp &&
+	    (ecc->read_page == nand_read_page_hwecc ||
+	     ecc->read_page == nand_read_page_swecc ||
+	     ecc->read_page == nand_read_page_raw) &&
+	    ecc->read_page_raw == nand_read_page_raw) {
+#ifdef CONFIG_SYS_NAND_ONFI_DETECTION
+		if (!chip->onfi_version ||
+		    (le16_to_cpu(chip->onfi_params.opt_cmd) &
+		     ONFI_OPT_CMD_READ_CACHE))
+#endif
+			chip->options |= NAND_CACHEREAD;
+	}
+#endif
+
 	/* Fill in remaining MTD driver data */
 	mtd->type = nand_is_slc(chip) ? MTD_NANDFLASH : MTD_MLCNANDFLASH;
 	mtd->flags = (chip->options & NAND_ROM) ? MTD_CAP_ROM :
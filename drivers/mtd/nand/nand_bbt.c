@@ -65,6 +65,7 @@
 #include <linux/mtd/nand.h>
 #include <linux/bitops.h>
 #include <linux/string.h>
+#include <u-boot/crc.h>
 
 #define BBT_BLOCK_GOOD		0x00
 #define BBT_BLOCK_WORN		0x01
@@ -74,6 +75,11 @@
 #define BBT_ENTRY_MASK		0x03
 #define BBT_ENTRY_SHIFT		2
 
+/* format of the bad block list kept in the environment */
+#define BBT_CACHE_VERSION	1
+
+DECLARE_GLOBAL_DATA_PTR;
+
 static int nand_update_bbt(struct mtd_info *mtd, loff_t offs);
 
 static inline uint8_t bbt_get_entry(struct nand_chip *chip, int block)
@@ -807,6 +813,174 @@ static int write_bbt(struct mtd_info *mtd, uint8_t *buf,
 	return res;
 }
 
+#ifdef CONFIG_NAND_BBT_CACHE
+/*
+ * The bad block list is kept in the environment as
+ *   <version>,<erasesize>,<blocks>,<crc32 of list>:<block>,<block>,...
+ * with all numbers in hex.
+ */
+static int bbt_cache_name(struct mtd_info *mtd, char *name, int len)
+{
+	if (!(gd->flags & GD_FLG_ENV_READY) || !mtd->name)
+		return 0;
+
+	snprintf(name, len, "bbt_%s", mtd->name);
+	return 1;
+}
+
+static int bbt_cache_load(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	int numblocks = mtd->size >> this->bbt_erase_shift;
+	char name[32], *s, *p, *list;
+	ulong crc, block;
+	int bad = 0;
+
+	if (!bbt_cache_name(mtd, name, sizeof(name)))
+		return -EAGAIN;
+
+	this->options |= NAND_BBT_CACHE_CHECKED;
+	s = getenv(name);
+	if (!s)
+		return -ENOENT;
+
+	if (simple_strtoul(s, &p, 16) != BBT_CACHE_VERSION || *p != ',' ||
+	    simple_strtoul(p + 1, &p, 16) != mtd->erasesize || *p != ',' ||
+	    simple_strtoul(p + 1, &p, 16) != numblocks || *p != ',')
+		goto invalid;
+	crc = simple_strtoul(p + 1, &p, 16);
+	if (*p++ != ':' || crc32(0, (uchar *)p, strlen(p)) != crc)
+		goto invalid;
+
+	/* Check the whole list before marking anything */
+	for (list = p; *p; p++) {
+		block = simple_strtoul(p, &s, 16);
+		if (s == p || block >= numblocks || (*s && *s != ','))
+			goto invalid;
+		p = s;
+		if (!*p)
+			break;
+	}
+
+	for (p = list; *p; p++) {
+		block = simple_strtoul(p, &p, 16);
+		bbt_mark_entry(this, block, BBT_BLOCK_FACTORY_BAD);
+		bad++;
+		if (!*p)
+			break;
+	}
+	mtd->ecc_stats.badblocks = bad;
+
+	pr_info("Bad block list of %s read from %s\n", mtd->name, name);
+	return 0;
+
+invalid:
+	pr_warn("Ignoring invalid bad block list in %s\n", name);
+	return -EINVAL;
+}
+
+static void bbt_cache_store(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	int numblocks = mtd->size >> this->bbt_erase_shift;
+	char name[32], *buf, *p, *list;
+	int i, bad = 0;
+
+	if (!bbt_cache_name(mtd, name, sizeof(name)))
+		return;
+
+	for (i = 0; i < numblocks; i++)
+		if (bbt_get_entry(this, i) != BBT_BLOCK_GOOD)
+			bad++;
+
+	/* header, then up to 8 digits and a separator per block */
+	buf = malloc(48 + bad * 9);
+	if (!buf)
+		return;
+
+	p = buf + sprintf(buf, "%x,%x,%x,", BBT_CACHE_VERSION,
+			  mtd->erasesize, numblocks);
+	list = p + 9;
+	for (i = 0, p = list; i < numblocks; i++)
+		if (bbt_get_entry(this, i) != BBT_BLOCK_GOOD)
+			p += sprintf(p, p == list ? "%x" : ",%x", i);
+	*p = '\0';
+
+	sprintf(list - 9, "%08x", crc32(0, (uchar *)list, p - list));
+	list[-1] = ':';
+
+	setenv(name, buf);
+	free(buf);
+}
+
+static void bbt_cache_drop(struct mtd_info *mtd)
+{
+	char name[32];
+
+	if (bbt_cache_name(mtd, name, sizeof(name)))
+		setenv(name, NULL);
+}
+#else
+static inline int bbt_cache_load(struct mtd_info *mtd)
+{
+	return -ENOENT;
+}
+
+static inline void bbt_cache_store(struct mtd_info *mtd) {}
+static inline void bbt_cache_drop(struct mtd_info *mtd) {}
+#endif
+
+/*
+ * Lazy scanning: the bad block marker of each block is read the first time
+ * the block is looked up, and recorded in bbt_scanned.
+ */
+static int bbt_lazy_init(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	int numblocks = mtd->size >> this->bbt_erase_shift;
+
+	this->bbt_scanned = kzalloc(DIV_ROUND_UP(numblocks, 8), GFP_KERNEL);
+	if (!this->bbt_scanned)
+		return -ENOMEM;
+
+	this->bbt_pending = numblocks;
+	return 0;
+}
+
+static void bbt_lazy_done(struct nand_chip *this)
+{
+	kfree(this->bbt_scanned);
+	this->bbt_scanned = NULL;
+	this->bbt_pending = 0;
+}
+
+/* Must be called with the chip holding @block selected */
+static void bbt_lazy_check(struct mtd_info *mtd, int block)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+	loff_t offs = (loff_t)block << this->bbt_erase_shift;
+
+	/* The environment may have become available since the first access */
+	if (!(this->options & NAND_BBT_CACHE_CHECKED) &&
+	    !bbt_cache_load(mtd)) {
+		bbt_lazy_done(this);
+		return;
+	}
+
+	if (this->block_bad(mtd, offs)) {
+		bbt_mark_entry(this, block, BBT_BLOCK_FACTORY_BAD);
+		pr_warn("Bad eraseblock %d at 0x%012llx\n",
+			block, (unsigned long long)offs);
+		mtd->ecc_stats.badblocks++;
+	}
+
+	this->bbt_scanned[block >> 3] |= 1 << (block & 7);
+	if (!--this->bbt_pending) {
+		bbt_lazy_done(this);
+		bbt_cache_store(mtd);
+	}
+}
+
 /**
  * nand_memory_bbt - [GENERIC] create a memory based bad block table
  * @mtd: MTD device structure
@@ -818,8 +992,18 @@ static int write_bbt(struct mtd_info *mtd, uint8_t *buf,
 static inline int nand_memory_bbt(struct mtd_info *mtd, struct nand_bbt_descr *bd)
 {
 	struct nand_chip *this = mtd_to_nand(mtd);
+	int res;
 
-	return create_bbt(mtd, this->buffers->databuf, bd, -1);
+	if (!bbt_cache_load(mtd))
+		return 0;
+
+	if (IS_ENABLED(CONFIG_NAND_BBT_LAZY))
+		return bbt_lazy_init(mtd);
+
+	res = create_bbt(mtd, this->buffers->databuf, bd, -1);
+	if (!res)
+		bbt_cache_store(mtd);
+	return res;
 }
 
 /**
@@ -1334,6 +1518,9 @@ int nand_isbad_bbt(struct mtd_info *mtd, loff_t offs, int allowbbt)
 	int block, res;
 
 	block = (int)(offs >> this->bbt_erase_shift);
+	if (this->bbt_scanned &&
+	    !(this->bbt_scanned[block >> 3] & (1 << (block & 7))))
+		bbt_lazy_check(mtd, block);
 	res = bbt_get_entry(this, block);
 
 	pr_debug("nand_isbad_bbt(): bbt info for offs 0x%08x: (block %d) 0x%02x\n",
@@ -1368,6 +1555,26 @@ int nand_markbad_bbt(struct mtd_info *mtd, loff_t offs)
 	/* Update flash-based bad block table */
 	if (this->bbt_options & NAND_BBT_USE_FLASH)
 		ret = nand_update_bbt(mtd, offs);
+	else if (!this->bbt_scanned)
+		bbt_cache_store(mtd);
 
 	return ret;
 }
+
+/**
+ * nand_release_bbt - [NAND Interface] Forget the bad block table
+ * @mtd: MTD device structure
+ *
+ * Free the memory bad block table and drop its copy in the environment, so
+ * that the next access builds it again from the bad block markers.
+ */
+void nand_release_bbt(struct mtd_info *mtd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+
+	kfree(this->bbt);
+	this->bbt = NULL;
+	bbt_lazy_done(this);
+	bbt_cache_drop(mtd);
+	this->options &= ~(NAND_BBT_SCANNED | NAND_BBT_CACHE_CHECKED);
+}
@@ -110,6 +110,28 @@ static int nand_command(int block, int page, uint32_t offs,
 
 	return 0;
 }
+
+#if defined(CONFIG_SYS_NAND_CACHE_READ) && \
+	!defined(CONFIG_SYS_NAND_HW_ECC_OOBFIRST)
+#define NAND_SPL_CACHE_READ
+/*
+ * READ CACHE SEQUENTIAL / END: make the page loaded before available for
+ * readout while the chip loads the next one (SEQUENTIAL only)
+ */
+static void nand_cache_command(u8 cmd)
+{
+	struct nand_chip *this = mtd_to_nand(mtd);
+
+	while (!this->dev_ready(mtd))
+		;
+
+	this->cmd_ctrl(mtd, cmd, NAND_CTRL_CLE | NAND_CTRL_CHANGE);
+	this->cmd_ctrl(mtd, NAND_CMD_NONE, NAND_NCE | NAND_CTRL_CHANGE);
+
+	while (!this->dev_ready(mtd))
+		;
+}
+#endif
 #endif
 
 static int nand_is_bad_block(int block)
@@ -168,7 +190,8 @@ static int nand_read_page(int block, int page, uchar *dst)
 	return 0;
 }
 #else
-static int nand_read_page(int block, int page, void *dst)
+/* Transfer and correct the page the chip has loaded */
+static int nand_read_page_data(void *dst)
 {
 	struct nand_chip *this = mtd_to_nand(mtd);
 	u_char ecc_calc[ECCTOTAL];
@@ -180,8 +203,6 @@ static int nand_read_page(int block, int page, void *dst)
 	int eccsteps = ECCSTEPS;
 	uint8_t *p = dst;
 
-	nand_command(block, page, 0, NAND_CMD_READ0);
-
 	for (i = 0; eccsteps; eccsteps--, i += eccbytes, p += eccsize) {
 		if (this->ecc.mode != NAND_ECC_SOFT)
 			this->ecc.hwctl(mtd, NAND_ECC_READ);
@@ -207,8 +228,37 @@ static int nand_read_page(int block, int page, void *dst)
 
 	return 0;
 }
+
+static int nand_read_page(int block, int page, void *dst)
+{
+	nand_command(block, page, 0, NAND_CMD_READ0);
+
+	return nand_read_page_data(dst);
+}
 #endif
 
+/* Read @count consecutive pages of a block */
+static void nand_read_pages(int block, int page, int count, void *dst)
+{
+#ifdef NAND_SPL_CACHE_READ
+	if (count > 1) {
+		nand_command(block, page, 0, NAND_CMD_READ0);
+		while (count--) {
+			nand_cache_command(count ? NAND_CMD_READCACHESEQ :
+					   NAND_CMD_READCACHEEND);
+			nand_read_page_data(dst);
+			dst += CONFIG_SYS_NAND_PAGE_SIZE;
+		}
+		return;
+	}
+#endif
+
+	while (count--) {
+		nand_read_page(block, page++, dst);
+		dst += CONFIG_SYS_NAND_PAGE_SIZE;
+	}
+}
+
 #ifdef CONFIG_SPL_UBI
 /*
  * Temporary storage for non NAND page aligned and non NAND page sized
@@ -259,11 +309,13 @@ int nand_spl_read_block(int block, int offset, int len, void *dst)
 			read = min(len, CONFIG_SYS_NAND_PAGE_SIZE - offset);
 			memcpy(dst, scratch_buf + offset, read);
 			offset = 0;
+			page++;
 		} else {
-			nand_read_page(block, page, dst);
-			read = CONFIG_SYS_NAND_PAGE_SIZE;
+			read = len / CONFIG_SYS_NAND_PAGE_SIZE;
+			nand_read_pages(block, page, read, dst);
+			page += read;
+			read *= CONFIG_SYS_NAND_PAGE_SIZE;
 		}
-		page++;
 		len -= read;
 		dst += read;
 	}
@@ -288,11 +340,10 @@ int nand_spl_load_image(uint32_t offs, unsigned int size, void *dst)
 			/*
 			 * Skip bad blocks
 			 */
-			while (page < CONFIG_SYS_NAND_PAGE_COUNT) {
-				nand_read_page(block, page, dst);
-				dst += CONFIG_SYS_NAND_PAGE_SIZE;
-				page++;
-			}
+			nand_read_pages(block, page,
+					CONFIG_SYS_NAND_PAGE_COUNT - page, dst);
+			dst += (CONFIG_SYS_NAND_PAGE_COUNT - page) *
+			       CONFIG_SYS_NAND_PAGE_SIZE;
 
 			page = 0;
 		} else {
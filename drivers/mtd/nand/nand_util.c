@@ -89,11 +89,7 @@ int nand_erase_opts(struct mtd_info *mtd,
 		 * We don't need the bad block table anymore...
 		 * after scrub, there are no bad blocks left!
 		 */
-		if (chip->bbt) {
-			kfree(chip->bbt);
-		}
-		chip->bbt = NULL;
-		chip->options &= ~NAND_BBT_SCANNED;
+		nand_release_bbt(mtd);
 	}
 
 	for (erased_length = 0;
@@ -19,6 +19,7 @@
 #include <video.h>
 #include <linux/compiler.h>
 #include <asm/state.h>
+#include <asm/test.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -41,8 +42,30 @@ struct sandbox_serial_platdata {
 
 struct sandbox_serial_priv {
 	bool start_of_line;
+	int busy;		/* putc() calls to refuse, -1 for all */
+	char *capture;		/* Buffer to hold output, NULL to print it */
+	int capture_size;
+	int capture_len;
 };
 
+void sandbox_serial_set_busy(struct udevice *dev, int count)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+
+	priv->busy = count;
+}
+
+void sandbox_serial_capture(struct udevice *dev, char *buf, int size)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+
+	priv->capture = buf;
+	priv->capture_size = size;
+	priv->capture_len = 0;
+	if (buf)
+		*buf = '\0';
+}
+
 /**
  * output_ansi_colour() - Output an ANSI colour code
  *
@@ -88,6 +111,19 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 	struct sandbox_serial_priv *priv = dev_get_priv(dev);
 	struct sandbox_serial_platdata *plat = dev->platdata;
 
+	if (priv->busy) {
+		if (priv->busy > 0)
+			priv->busy--;
+		return -EAGAIN;
+	}
+	if (priv->capture) {
+		if (priv->capture_len < priv->capture_size - 1) {
+			priv->capture[priv->capture_len++] = ch;
+			priv->capture[priv->capture_len] = '\0';
+		}
+		return 0;
+	}
+
 	if (priv->start_of_line && plat->colour != -1) {
 		priv->start_of_line = false;
 		output_ansi_colour(plat->colour);
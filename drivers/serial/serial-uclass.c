@@ -9,12 +9,14 @@
 #include <environment.h>
 #include <errno.h>
 #include <fdtdec.h>
+#include <malloc.h>
 #include <os.h>
 #include <serial.h>
 #include <stdio_dev.h>
 #include <watchdog.h>
 #include <dm/lists.h>
 #include <dm/device-internal.h>
+#include <linux/bug.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -124,6 +126,129 @@ void serial_initialize(void)
 	serial_init();
 }
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+#define TX_BUF_SIZE	CONFIG_SERIAL_TX_BUFFER_SIZE
+#define TX_BUF_MASK	(TX_BUF_SIZE - 1)
+
+/* Write out buffered output until it is all gone or the uart is full */
+static void serial_tx_drain(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+
+	/* The driver may print, or delay, while taking a character */
+	if (upriv->tx_busy)
+		return;
+	upriv->tx_busy = true;
+	while (upriv->tx_tail != upriv->tx_head) {
+		if (ops->putc(dev, upriv->tx_buf[upriv->tx_tail & TX_BUF_MASK])
+		    == -EAGAIN)
+			break;
+		upriv->tx_tail++;
+	}
+	upriv->tx_busy = false;
+}
+
+/*
+ * Write a character without waiting for the uart if possible, putting it
+ * in the buffer otherwise. Returns false if the device is not buffered,
+ * so that the character must be written synchronously.
+ */
+static bool serial_tx_queue(struct udevice *dev, char ch)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	struct dm_serial_ops *ops = serial_get_ops(dev);
+
+	if (!upriv->tx_buf || upriv->tx_busy || upriv->tx_sync)
+		return false;
+
+	serial_tx_drain(dev);
+	if (upriv->tx_tail == upriv->tx_head && ops->putc(dev, ch) != -EAGAIN)
+		return true;
+
+	while (upriv->tx_head - upriv->tx_tail == TX_BUF_SIZE) {
+#ifdef CONFIG_SERIAL_TX_BUFFER_DROP
+		return true;
+#else
+		WATCHDOG_RESET();
+		serial_tx_drain(dev);
+#endif
+	}
+	upriv->tx_buf[upriv->tx_head++ & TX_BUF_MASK] = ch;
+
+	return true;
+}
+
+/* Write out all buffered output, waiting for the uart as needed */
+static void serial_tx_wait(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (!upriv->tx_buf || upriv->tx_busy)
+		return;
+	while (upriv->tx_tail != upriv->tx_head) {
+		WATCHDOG_RESET();
+		serial_tx_drain(dev);
+	}
+}
+
+/* Write out all buffered output, and free the buffer */
+static void serial_tx_stop(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	serial_tx_wait(dev);
+	free(upriv->tx_buf);
+	upriv->tx_buf = NULL;
+}
+
+void serial_tx_poll(void)
+{
+	if (gd->cur_serial_dev)
+		serial_tx_drain(gd->cur_serial_dev);
+}
+
+void serial_tx_flush(void)
+{
+	struct serial_dev_priv *upriv;
+	struct udevice *dev;
+	struct uclass *uc;
+
+	if (uclass_get(UCLASS_SERIAL, &uc))
+		return;
+	uclass_foreach_dev(dev, uc) {
+		if (!device_active(dev))
+			continue;
+		serial_tx_wait(dev);
+		upriv = dev_get_uclass_priv(dev);
+		upriv->tx_sync = true;
+	}
+}
+
+void serial_tx_resume(void)
+{
+	struct serial_dev_priv *upriv;
+	struct udevice *dev;
+	struct uclass *uc;
+
+	if (uclass_get(UCLASS_SERIAL, &uc))
+		return;
+	uclass_foreach_dev(dev, uc) {
+		if (!device_active(dev))
+			continue;
+		upriv = dev_get_uclass_priv(dev);
+		upriv->tx_sync = false;
+	}
+}
+#else
+static inline void serial_tx_drain(struct udevice *dev) {}
+static inline bool serial_tx_queue(struct udevice *dev, char ch)
+{
+	return false;
+}
+static inline void serial_tx_stop(struct udevice *dev) {}
+#endif
+
 static void _serial_putc(struct udevice *dev, char ch)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
@@ -132,6 +257,9 @@ static void _serial_putc(struct udevice *dev, char ch)
 	if (ch == '\n')
 		_serial_putc(dev, '\r');
 
+	if (serial_tx_queue(dev, ch))
+		return;
+
 	do {
 		err = ops->putc(dev, ch);
 	} while (err == -EAGAIN);
@@ -150,8 +278,10 @@ static int _serial_getc(struct udevice *dev)
 
 	do {
 		err = ops->getc(dev);
-		if (err == -EAGAIN)
+		if (err == -EAGAIN) {
 			WATCHDOG_RESET();
+			serial_tx_drain(dev);
+		}
 	} while (err == -EAGAIN);
 
 	return err >= 0 ? err : 0;
@@ -161,6 +291,7 @@ static int _serial_tstc(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	serial_tx_drain(dev);
 	if (ops->pending)
 		return ops->pending(dev, true);
 
@@ -327,6 +458,16 @@ static int serial_post_probe(struct udevice *dev)
 			return ret;
 	}
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	BUILD_BUG_ON_NOT_POWER_OF_2(TX_BUF_SIZE);
+	/* Before relocation, the buffer would be lost with the device */
+	if (gd->flags & GD_FLG_RELOC) {
+		struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+		upriv->tx_buf = malloc(TX_BUF_SIZE);
+	}
+#endif
+
 #ifdef CONFIG_DM_STDIO
 	if (!(gd->flags & GD_FLG_RELOC))
 		return 0;
@@ -346,6 +487,8 @@ static int serial_post_probe(struct udevice *dev)
 
 static int serial_pre_remove(struct udevice *dev)
 {
+	serial_tx_stop(dev);
+
 #if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
 
@@ -70,6 +70,7 @@ void reset_cpu(ulong addr)
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
+	serial_tx_flush();
 	sysreset_walk_halt(SYSRESET_WARM);
 
 	return 0;
@@ -61,6 +61,7 @@ static inline struct f_fastboot *func_to_fastboot(struct usb_function *f)
 static struct f_fastboot *fastboot_func;
 static unsigned int download_size;
 static unsigned int download_bytes;
+static ulong download_start;
 
 static struct usb_endpoint_descriptor fs_ep_in = {
 	.bLength            = USB_DT_ENDPOINT_SIZE,
@@ -478,6 +479,7 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 	const unsigned char *buffer = req->buf;
 	unsigned int buffer_size = req->actual;
 	unsigned int pre_dot_num, now_dot_num;
+	ulong time;
 
 	if (req->status != 0) {
 		printf("Bad status: %d\n", req->status);
@@ -513,7 +515,12 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 		strcpy(response, "OKAY");
 		fastboot_tx_write_str(response);
 
-		printf("\ndownloading of %d bytes finished\n", download_bytes);
+		time = get_timer(download_start);
+		printf("\ndownloading of %d bytes finished in %lu ms",
+		       download_bytes, time);
+		if (time)
+			printf(" (%lu kB/s)", download_bytes / time);
+		puts("\n");
 	} else {
 		req->length = rx_bytes_expected(ep);
 	}
@@ -530,6 +537,7 @@ static void cb_download(struct usb_ep *ep, struct usb_request *req)
 	strsep(&cmd, ":");
 	download_size = simple_strtoul(cmd, NULL, 16);
 	download_bytes = 0;
+	download_start = get_timer(0);
 
 	printf("Starting download of %d bytes\n", download_size);
 
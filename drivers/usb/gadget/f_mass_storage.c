@@ -826,6 +826,16 @@ static int do_read(struct fsg_common *common)
 
 /*-------------------------------------------------------------------------*/
 
+static int fsg_lun_flush(struct fsg_common *common)
+{
+	struct ums *ums_dev = &ums[common->lun];
+
+	if (!ums_dev->flush)
+		return 0;
+
+	return ums_dev->flush(ums_dev);
+}
+
 static int do_write(struct fsg_common *common)
 {
 	struct fsg_lun		*curlun = &common->luns[common->lun];
@@ -996,6 +1006,13 @@ static int do_write(struct fsg_common *common)
 			return rc;
 	}
 
+	/* FUA: the data must be on the medium before the status is sent */
+	if (common->cmnd[0] != SC_WRITE_6 && (common->cmnd[1] & 0x08) &&
+	    fsg_lun_flush(common)) {
+		curlun->sense_data = SS_WRITE_ERROR;
+		curlun->info_valid = 1;
+	}
+
 	return -EIO;		/* No default reply */
 }
 
@@ -1003,6 +1020,11 @@ static int do_write(struct fsg_common *common)
 
 static int do_synchronize_cache(struct fsg_common *common)
 {
+	struct fsg_lun	*curlun = &common->luns[common->lun];
+
+	if (fsg_lun_flush(common))
+		curlun->sense_data = SS_WRITE_ERROR;
+
 	return 0;
 }
 
@@ -1337,6 +1359,12 @@ static int do_start_stop(struct fsg_common *common)
 		return -EINVAL;
 	}
 
+	/* Stopping or ejecting the medium writes back the cached data */
+	if (!(common->cmnd[4] & 0x01) && fsg_lun_flush(common)) {
+		curlun->sense_data = SS_WRITE_ERROR;
+		return -EIO;
+	}
+
 	return 0;
 }
 
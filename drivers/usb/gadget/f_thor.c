@@ -32,6 +32,8 @@
 
 static void thor_tx_data(unsigned char *data, int len);
 static void thor_set_dma(void *addr, int len);
+static int thor_rx_start(void);
+static int thor_rx_wait(void);
 static int thor_rx_data(void);
 
 static struct f_thor *thor_func;
@@ -141,46 +143,88 @@ static int process_rqt_cmd(const struct rqt_box *rqt)
 	return true;
 }
 
+/*
+ * The DFU buffer is split in two halves of up to THOR_STORE_UNIT_SIZE. While
+ * one half is written to the medium, the next packet is received into the
+ * other one.
+ */
+static unsigned long thor_store_unit_size(void)
+{
+	unsigned long size = dfu_get_buf_size() / 2;
+
+	size = min_t(unsigned long, size, THOR_STORE_UNIT_SIZE);
+	return rounddown(size, THOR_PACKET_SIZE);
+}
+
 static long long int download_head(unsigned long long total,
 				   unsigned int packet_size,
 				   long long int *left,
+				   void **left_buf,
 				   int *cnt)
 {
 	long long int rcv_cnt = 0, left_to_rcv, ret_rcv;
 	struct dfu_entity *dfu_entity = dfu_get_entity(alt_setting_num);
 	void *transfer_buffer = dfu_get_buf(dfu_entity);
-	void *buf = transfer_buffer;
+	void *buf = transfer_buffer, *store_buf = transfer_buffer;
+	unsigned long unit = thor_store_unit_size();
 	int usb_pkt_cnt = 0, ret;
+	bool queued = false;
+
+	if (!transfer_buffer || unit < packet_size) {
+		error("DFU buffer too small (%lu bytes)", dfu_get_buf_size());
+		return -ENOMEM;
+	}
 
 	/*
-	 * Files smaller than THOR_STORE_UNIT_SIZE (now 32 MiB) are stored on
-	 * the medium.
-	 * The packet response is sent on the purpose after successful data
-	 * chunk write. There is a room for improvement when asynchronous write
-	 * is performed.
+	 * Files smaller than one unit are only stored on the medium by
+	 * download_tail().
+	 * When a half is full, the next packet is queued into the other half
+	 * and acknowledged before the full half is written. The host can then
+	 * send while the medium is busy. A write error is reported in the
+	 * response to that next packet.
 	 */
 	while (total - rcv_cnt >= packet_size) {
-		thor_set_dma(buf, packet_size);
-		buf += packet_size;
-		ret_rcv = thor_rx_data();
+		if (!queued) {
+			thor_set_dma(buf, packet_size);
+			ret = thor_rx_start();
+			if (ret)
+				return ret;
+		}
+		queued = false;
+		ret_rcv = thor_rx_wait();
 		if (ret_rcv < 0)
 			return ret_rcv;
+		buf += packet_size;
 		rcv_cnt += ret_rcv;
 		debug("%d: RCV data count: %llu cnt: %d\n", usb_pkt_cnt,
 		      rcv_cnt, *cnt);
 
-		if ((rcv_cnt % THOR_STORE_UNIT_SIZE) == 0) {
-			ret = dfu_write(dfu_get_entity(alt_setting_num),
-					transfer_buffer, THOR_STORE_UNIT_SIZE,
-					(*cnt)++);
-			if (ret) {
-				error("DFU write failed [%d] cnt: %d",
-				      ret, *cnt);
+		if ((rcv_cnt % unit) != 0) {
+			send_data_rsp(0, ++usb_pkt_cnt);
+			continue;
+		}
+
+		/* Switch halves */
+		buf = store_buf == transfer_buffer ? transfer_buffer + unit :
+						     transfer_buffer;
+		if (total - rcv_cnt >= packet_size) {
+			thor_set_dma(buf, packet_size);
+			ret = thor_rx_start();
+			if (ret)
 				return ret;
-			}
-			buf = transfer_buffer;
+			queued = true;
 		}
 		send_data_rsp(0, ++usb_pkt_cnt);
+
+		ret = dfu_write_unbuffered(dfu_entity, store_buf, unit,
+					   (*cnt)++);
+		if (ret) {
+			error("DFU write failed [%d] cnt: %d", ret, *cnt);
+			if (queued && thor_rx_wait() >= 0)
+				send_data_rsp(ret, ++usb_pkt_cnt);
+			return ret;
+		}
+		store_buf = buf;
 	}
 
 	/* Calculate the amount of data to arrive from PC (in bytes) */
@@ -188,9 +232,10 @@ static long long int download_head(unsigned long long total,
 
 	/*
 	 * Calculate number of data already received. but not yet stored
-	 * on the medium (they are smaller than THOR_STORE_UNIT_SIZE)
+	 * on the medium (they are smaller than one unit)
 	 */
-	*left = left_to_rcv + buf - transfer_buffer;
+	*left = left_to_rcv + buf - store_buf;
+	*left_buf = store_buf;
 	debug("%s: left: %llu left_to_rcv: %llu buf: 0x%p\n", __func__,
 	      *left, left_to_rcv, buf);
 
@@ -208,7 +253,7 @@ static long long int download_head(unsigned long long total,
 	return rcv_cnt;
 }
 
-static int download_tail(long long int left, int cnt)
+static int download_tail(long long int left, void *left_buf, int cnt)
 {
 	struct dfu_entity *dfu_entity;
 	void *transfer_buffer;
@@ -229,7 +274,7 @@ static int download_tail(long long int left, int cnt)
 	}
 
 	if (left) {
-		ret = dfu_write(dfu_entity, transfer_buffer, left, cnt++);
+		ret = dfu_write_unbuffered(dfu_entity, left_buf, left, cnt++);
 		if (ret) {
 			error("DFU write failed [%d]: left: %llu", ret, left);
 			return ret;
@@ -254,6 +299,7 @@ static long long int process_rqt_download(const struct rqt_box *rqt)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(struct rsp_box, rsp, sizeof(struct rsp_box));
 	static long long int left, ret_head;
+	static void *left_buf;
 	int file_type, ret = 0;
 	static int cnt;
 
@@ -294,7 +340,7 @@ static long long int process_rqt_download(const struct rqt_box *rqt)
 	case RQT_DL_FILE_START:
 		send_rsp(rsp);
 		ret_head = download_head(thor_file_size, THOR_PACKET_SIZE,
-					 &left, &cnt);
+					 &left, &left_buf, &cnt);
 		if (ret_head < 0) {
 			left = 0;
 			cnt = 0;
@@ -302,7 +348,7 @@ static long long int process_rqt_download(const struct rqt_box *rqt)
 		return ret_head;
 	case RQT_DL_FILE_END:
 		debug("DL FILE_END\n");
-		rsp->ack = download_tail(left, cnt);
+		rsp->ack = download_tail(left, left_buf, cnt);
 		ret = rsp->ack;
 		left = 0;
 		cnt = 0;
@@ -527,26 +573,35 @@ static struct usb_request *alloc_ep_req(struct usb_ep *ep, unsigned length)
 	return req;
 }
 
-static int thor_rx_data(void)
+/* Queue the OUT request, the controller receives into it in the background */
+static int thor_rx_start(void)
+{
+	struct thor_dev *dev = thor_func->dev;
+	int status;
+
+	debug("dev->out_req->length:%d dev->rxdata:%d\n",
+	      dev->out_req->length, dev->rxdata);
+
+	status = usb_ep_queue(dev->out_ep, dev->out_req, 0);
+	if (status) {
+		error("kill %s:  resubmit %d bytes --> %d",
+		      dev->out_ep->name, dev->out_req->length, status);
+		usb_ep_set_halt(dev->out_ep);
+		return -EAGAIN;
+	}
+
+	return 0;
+}
+
+/* Wait until the request queued by thor_rx_start() is filled */
+static int thor_rx_wait(void)
 {
 	struct thor_dev *dev = thor_func->dev;
-	int data_to_rx, tmp, status;
+	int data_to_rx, tmp, ret;
 
 	data_to_rx = dev->out_req->length;
 	tmp = data_to_rx;
-	do {
-		dev->out_req->length = data_to_rx;
-		debug("dev->out_req->length:%d dev->rxdata:%d\n",
-		      dev->out_req->length, dev->rxdata);
-
-		status = usb_ep_queue(dev->out_ep, dev->out_req, 0);
-		if (status) {
-			error("kill %s:  resubmit %d bytes --> %d",
-			      dev->out_ep->name, dev->out_req->length, status);
-			usb_ep_set_halt(dev->out_ep);
-			return -EAGAIN;
-		}
-
+	for (;;) {
 		while (!dev->rxdata) {
 			usb_gadget_handle_interrupts(0);
 			if (ctrlc())
@@ -554,11 +609,29 @@ static int thor_rx_data(void)
 		}
 		dev->rxdata = 0;
 		data_to_rx -= dev->out_req->actual;
-	} while (data_to_rx);
+		if (!data_to_rx)
+			break;
+
+		dev->out_req->length = data_to_rx;
+		ret = thor_rx_start();
+		if (ret)
+			return ret;
+	}
 
 	return tmp;
 }
 
+static int thor_rx_data(void)
+{
+	int ret;
+
+	ret = thor_rx_start();
+	if (ret)
+		return ret;
+
+	return thor_rx_wait();
+}
+
 static void thor_tx_data(unsigned char *data, int len)
 {
 	struct thor_dev *dev = thor_func->dev;
@@ -281,35 +281,176 @@ static inline u8 ehci_encode_speed(enum usb_device_speed speed)
 	return QH_FULL_SPEED;
 }
 
-static void ehci_update_endpt2_dev_n_port(struct usb_device *udev,
-					  struct QH *qh)
+static uint32_t ehci_get_endpt2_dev_n_port(struct usb_device *udev)
 {
 	uint8_t portnr = 0;
 	uint8_t hubaddr = 0;
 
 	if (udev->speed != USB_SPEED_LOW && udev->speed != USB_SPEED_FULL)
-		return;
+		return 0;
 
 	usb_find_usb2_hub_address_port(udev, &hubaddr, &portnr);
 
-	qh->qh_endpt2 |= cpu_to_hc32(QH_ENDPT2_PORTNUM(portnr) |
-				     QH_ENDPT2_HUBADDR(hubaddr));
+	return QH_ENDPT2_PORTNUM(portnr) | QH_ENDPT2_HUBADDR(hubaddr);
+}
+
+static void ehci_update_endpt2_dev_n_port(struct usb_device *udev,
+					  struct QH *qh)
+{
+	qh->qh_endpt2 |= cpu_to_hc32(ehci_get_endpt2_dev_n_port(udev));
+}
+
+/*
+ * Queue heads used for asynchronous transfers stay linked into the schedule
+ * after a transfer, and the schedule is left running. A transfer then only has
+ * to hang its qTD chain off the idle queue head of its endpoint. A queue head
+ * is taken off the schedule to make room for another endpoint, or when a
+ * transfer did not complete or ended in an error.
+ *
+ * An error such as a STALL leaves the overlay halted, and a halted queue head
+ * never moves on to the next qTD. So after an error the next transfer on the
+ * endpoint, such as the retry which follows CLEAR_FEATURE(ENDPOINT_HALT), gets
+ * a freshly set up queue head, just as if each transfer had its own.
+ */
+static int ehci_async_start(struct ehci_ctrl *ctrl)
+{
+	uint32_t cmd;
+	int ret;
+
+	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
+	if (cmd & CMD_ASE)
+		return 0;
+
+	/* Set async. queue head pointer. */
+	ehci_writel(&ctrl->hcor->or_asynclistaddr, virt_to_phys(&ctrl->qh_list));
+
+	/* Enable async. schedule. */
+	cmd |= CMD_ASE;
+	ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
+
+	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS, STS_ASS,
+			100 * 1000);
+	if (ret < 0)
+		printf("EHCI fail timeout STS_ASS set\n");
+
+	return ret;
+}
+
+static void ehci_async_unlink(struct ehci_ctrl *ctrl, struct QH *qh)
+{
+	uint32_t link = cpu_to_hc32(virt_to_phys(qh) | QH_LINK_TYPE_QH);
+	struct QH *prev = &ctrl->qh_list;
+	uint32_t cmd;
+	int i;
+
+	for (i = 0; prev->qh_link != link && i < EHCI_ASYNC_QH_COUNT; i++)
+		prev = &ctrl->async_qh[i].qh;
+	if (prev->qh_link != link)
+		return;
+
+	prev->qh_link = qh->qh_link;
+	flush_dcache_range((unsigned long)prev,
+			   ALIGN_END_ADDR(struct QH, prev, 1));
+
+	/* Ring the doorbell so we know the controller let go of it */
+	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
+	if (cmd & CMD_ASE) {
+		ehci_writel(&ctrl->hcor->or_usbsts, STS_IAA);
+		ehci_writel(&ctrl->hcor->or_usbcmd, cmd | CMD_IAAD);
+		if (handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_IAA,
+			      STS_IAA, 100 * 1000) < 0)
+			printf("EHCI fail timeout STS_IAA set\n");
+		ehci_writel(&ctrl->hcor->or_usbsts, STS_IAA);
+	}
+
+	/* Keep the overlay, the caller may still want to look at it */
+	invalidate_dcache_range((unsigned long)qh,
+				ALIGN_END_ADDR(struct QH, qh, 1));
+	qh->qh_endpt1 = 0;
+	flush_dcache_range((unsigned long)qh, ALIGN_END_ADDR(struct QH, qh, 1));
+}
+
+static struct ehci_async_qh *ehci_async_get_qh(struct ehci_ctrl *ctrl,
+					       uint32_t endpt1,
+					       uint32_t endpt2)
+{
+	struct ehci_async_qh *aqh, *free_aqh = NULL;
+	struct QH *qh;
+	struct qTD *dummy;
+	int i;
+
+	endpt1 = cpu_to_hc32(endpt1);
+	endpt2 = cpu_to_hc32(endpt2);
+	for (i = 0; i < EHCI_ASYNC_QH_COUNT; i++) {
+		aqh = &ctrl->async_qh[i];
+		if (!aqh->qh.qh_endpt1) {
+			if (!free_aqh)
+				free_aqh = aqh;
+		} else if (aqh->qh.qh_endpt1 == endpt1 &&
+			   aqh->qh.qh_endpt2 == endpt2) {
+			return aqh;
+		}
+	}
+
+	if (!free_aqh) {
+		free_aqh = &ctrl->async_qh[ctrl->async_qh_next];
+		ctrl->async_qh_next = (ctrl->async_qh_next + 1) %
+				      EHCI_ASYNC_QH_COUNT;
+		ehci_async_unlink(ctrl, &free_aqh->qh);
+	}
+
+	/* The overlay starts at the first dummy, which is inactive */
+	aqh = free_aqh;
+	ctrl->async_dummy[aqh - ctrl->async_qh] = 0;
+	dummy = &aqh->dummy[0];
+	memset(dummy, 0, sizeof(*dummy));
+	dummy->qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
+	dummy->qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
+	flush_dcache_range((unsigned long)dummy,
+			   ALIGN_END_ADDR(struct qTD, dummy, 1));
+
+	/*
+	 * Setup QH (3.6 in ehci-r10.pdf)
+	 *
+	 *   qh_link ................. 03-00 H
+	 *   qh_endpt1 ............... 07-04 H
+	 *   qh_endpt2 ............... 0B-08 H
+	 * - qh_curtd
+	 *   qh_overlay.qt_next ...... 13-10 H
+	 * - qh_overlay.qt_altnext
+	 */
+	qh = &aqh->qh;
+	memset(qh, 0, sizeof(*qh));
+	qh->qh_link = ctrl->qh_list.qh_link;
+	qh->qh_endpt1 = endpt1;
+	qh->qh_endpt2 = endpt2;
+	qh->qh_overlay.qt_next = cpu_to_hc32(virt_to_phys(dummy));
+	qh->qh_overlay.qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
+	flush_dcache_range((unsigned long)qh, ALIGN_END_ADDR(struct QH, qh, 1));
+
+	/* Link it in right behind the head of the reclamation list */
+	ctrl->qh_list.qh_link = cpu_to_hc32(virt_to_phys(qh) | QH_LINK_TYPE_QH);
+	flush_dcache_range((unsigned long)&ctrl->qh_list,
+		ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
+
+	return aqh;
 }
 
 static int
 ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		   int length, struct devrequest *req)
 {
-	ALLOC_ALIGN_BUFFER(struct QH, qh, 1, USB_DMA_MINALIGN);
-	struct qTD *qtd;
+	struct ehci_async_qh *aqh;
+	struct QH *qh;
+	struct qTD *qtd, *head, *tail;
+	uint8_t *dummy;
 	int qtd_count = 0;
 	int qtd_counter = 0;
 	volatile struct qTD *vtd;
 	unsigned long ts;
-	uint32_t *tdp;
-	uint32_t endpt, maxpacket, token, usbsts;
+	uint32_t *tdp, first;
+	uint32_t endpt1, endpt2, maxpacket, token, usbsts;
 	uint32_t c, toggle;
-	uint32_t cmd;
 	int timeout;
 	int ret = 0;
 	struct ehci_ctrl *ctrl = ehci_get_ctrl(dev);
@@ -382,44 +523,40 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 #if CONFIG_SYS_MALLOC_LEN <= 64 + 128 * 1024
 #warning CONFIG_SYS_MALLOC_LEN may be too small for EHCI
 #endif
-	qtd = memalign(USB_DMA_MINALIGN, qtd_count * sizeof(struct qTD));
-	if (qtd == NULL) {
-		printf("unable to allocate TDs\n");
-		return -1;
+	/*
+	 * The qTDs are kept between transfers and only grow when a larger
+	 * transfer comes along. All queue heads are idle at this point, so
+	 * none of them refers to the old qTDs any more.
+	 */
+	if (qtd_count > ctrl->qtd_pool_count) {
+		free(ctrl->qtd_pool);
+		ctrl->qtd_pool = memalign(USB_DMA_MINALIGN,
+					  qtd_count * sizeof(struct qTD));
+		if (ctrl->qtd_pool == NULL) {
+			ctrl->qtd_pool_count = 0;
+			printf("unable to allocate TDs\n");
+			return -1;
+		}
+		ctrl->qtd_pool_count = qtd_count;
 	}
-
-	memset(qh, 0, sizeof(struct QH));
+	qtd = ctrl->qtd_pool;
 	memset(qtd, 0, qtd_count * sizeof(*qtd));
 
 	toggle = usb_gettoggle(dev, usb_pipeendpoint(pipe), usb_pipeout(pipe));
 
-	/*
-	 * Setup QH (3.6 in ehci-r10.pdf)
-	 *
-	 *   qh_link ................. 03-00 H
-	 *   qh_endpt1 ............... 07-04 H
-	 *   qh_endpt2 ............... 0B-08 H
-	 * - qh_curtd
-	 *   qh_overlay.qt_next ...... 13-10 H
-	 * - qh_overlay.qt_altnext
-	 */
-	qh->qh_link = cpu_to_hc32(virt_to_phys(&ctrl->qh_list) | QH_LINK_TYPE_QH);
 	c = (dev->speed != USB_SPEED_HIGH) && !usb_pipeendpoint(pipe);
 	maxpacket = usb_maxpacket(dev, pipe);
-	endpt = QH_ENDPT1_RL(8) | QH_ENDPT1_C(c) |
-		QH_ENDPT1_MAXPKTLEN(maxpacket) | QH_ENDPT1_H(0) |
-		QH_ENDPT1_DTC(QH_ENDPT1_DTC_DT_FROM_QTD) |
-		QH_ENDPT1_EPS(ehci_encode_speed(dev->speed)) |
-		QH_ENDPT1_ENDPT(usb_pipeendpoint(pipe)) | QH_ENDPT1_I(0) |
-		QH_ENDPT1_DEVADDR(usb_pipedevice(pipe));
-	qh->qh_endpt1 = cpu_to_hc32(endpt);
-	endpt = QH_ENDPT2_MULT(1) | QH_ENDPT2_UFCMASK(0) | QH_ENDPT2_UFSMASK(0);
-	qh->qh_endpt2 = cpu_to_hc32(endpt);
-	ehci_update_endpt2_dev_n_port(dev, qh);
-	qh->qh_overlay.qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
-	qh->qh_overlay.qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
-
-	tdp = &qh->qh_overlay.qt_next;
+	endpt1 = QH_ENDPT1_RL(8) | QH_ENDPT1_C(c) |
+		 QH_ENDPT1_MAXPKTLEN(maxpacket) | QH_ENDPT1_H(0) |
+		 QH_ENDPT1_DTC(QH_ENDPT1_DTC_DT_FROM_QTD) |
+		 QH_ENDPT1_EPS(ehci_encode_speed(dev->speed)) |
+		 QH_ENDPT1_ENDPT(usb_pipeendpoint(pipe)) | QH_ENDPT1_I(0) |
+		 QH_ENDPT1_DEVADDR(usb_pipedevice(pipe));
+	endpt2 = QH_ENDPT2_MULT(1) | QH_ENDPT2_UFCMASK(0) |
+		 QH_ENDPT2_UFSMASK(0) | ehci_get_endpt2_dev_n_port(dev);
+
+	first = cpu_to_hc32(QT_NEXT_TERMINATE);
+	tdp = &first;
 	if (req != NULL) {
 		/*
 		 * Setup request qTD (3.5 in ehci-r10.pdf)
@@ -536,36 +673,44 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		tdp = &qtd[qtd_counter++].qt_next;
 	}
 
-	ctrl->qh_list.qh_link = cpu_to_hc32(virt_to_phys(qh) | QH_LINK_TYPE_QH);
-
-	/* Flush dcache */
-	flush_dcache_range((unsigned long)&ctrl->qh_list,
-		ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
-	flush_dcache_range((unsigned long)qh, ALIGN_END_ADDR(struct QH, qh, 1));
-	flush_dcache_range((unsigned long)qtd,
-			   ALIGN_END_ADDR(struct qTD, qtd, qtd_count));
-
-	/* Set async. queue head pointer. */
-	ehci_writel(&ctrl->hcor->or_asynclistaddr, virt_to_phys(&ctrl->qh_list));
-
 	usbsts = ehci_readl(&ctrl->hcor->or_usbsts);
 	ehci_writel(&ctrl->hcor->or_usbsts, (usbsts & 0x3f));
 
-	/* Enable async. schedule. */
-	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
-	cmd |= CMD_ASE;
-	ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
+	ret = ehci_async_start(ctrl);
+	if (ret < 0)
+		return -1;
 
-	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS, STS_ASS,
-			100 * 1000);
-	if (ret < 0) {
-		printf("EHCI fail timeout STS_ASS set\n");
-		goto fail;
-	}
+	/*
+	 * Hand the chain to the queue head of the endpoint. It stays in the
+	 * schedule, so its overlay must not be written. Instead the first qTD
+	 * is copied into the dummy the overlay points at, and the chain ends
+	 * at the other dummy. The token goes last, so that the controller
+	 * never sees a half-written qTD.
+	 */
+	aqh = ehci_async_get_qh(ctrl, endpt1, endpt2);
+	qh = &aqh->qh;
+	dummy = &ctrl->async_dummy[aqh - ctrl->async_qh];
+	head = &aqh->dummy[*dummy];
+	tail = &aqh->dummy[!*dummy];
+	*dummy = !*dummy;
+
+	memset(tail, 0, sizeof(*tail));
+	tail->qt_next = cpu_to_hc32(QT_NEXT_TERMINATE);
+	tail->qt_altnext = cpu_to_hc32(QT_NEXT_TERMINATE);
+	*tdp = cpu_to_hc32(virt_to_phys(tail));
+	*head = qtd[0];
+	head->qt_token = 0;
+	flush_dcache_range((unsigned long)qtd,
+			   ALIGN_END_ADDR(struct qTD, qtd, qtd_count));
+	flush_dcache_range((unsigned long)aqh->dummy,
+			   ALIGN_END_ADDR(struct qTD, aqh->dummy, 2));
+	head->qt_token = qtd[0].qt_token;
+	flush_dcache_range((unsigned long)aqh->dummy,
+			   ALIGN_END_ADDR(struct qTD, aqh->dummy, 2));
 
 	/* Wait for TDs to be processed. */
 	ts = get_timer(0);
-	vtd = &qtd[qtd_counter - 1];
+	vtd = qtd_counter > 1 ? &qtd[qtd_counter - 1] : head;
 	timeout = USB_TIMEOUT_MS(pipe);
 	do {
 		/* Invalidate dcache */
@@ -573,6 +718,8 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 			ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
 		invalidate_dcache_range((unsigned long)qh,
 			ALIGN_END_ADDR(struct QH, qh, 1));
+		invalidate_dcache_range((unsigned long)aqh->dummy,
+			ALIGN_END_ADDR(struct qTD, aqh->dummy, 2));
 		invalidate_dcache_range((unsigned long)qtd,
 			ALIGN_END_ADDR(struct qTD, qtd, qtd_count));
 
@@ -594,23 +741,18 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 	invalidate_dcache_range((unsigned long)buffer,
 		ALIGN((unsigned long)buffer + length, ARCH_DMA_MINALIGN));
 
-	/* Check that the TD processing happened */
-	if (QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE)
+	/*
+	 * Check that the TD processing happened. If it did, the last qTD holds
+	 * the final state of the transfer. Otherwise the queue head may still
+	 * be working on the chain, so take it off the schedule before looking
+	 * at its overlay.
+	 */
+	if (QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE) {
 		printf("EHCI timed out on TD - token=%#x\n", token);
-
-	/* Disable async schedule. */
-	cmd = ehci_readl(&ctrl->hcor->or_usbcmd);
-	cmd &= ~CMD_ASE;
-	ehci_writel(&ctrl->hcor->or_usbcmd, cmd);
-
-	ret = handshake((uint32_t *)&ctrl->hcor->or_usbsts, STS_ASS, 0,
-			100 * 1000);
-	if (ret < 0) {
-		printf("EHCI fail timeout STS_ASS reset\n");
-		goto fail;
+		ehci_async_unlink(ctrl, qh);
+		token = hc32_to_cpu(qh->qh_overlay.qt_token);
 	}
 
-	token = hc32_to_cpu(qh->qh_overlay.qt_token);
 	if (!(QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE)) {
 		debug("TOKEN=%#x\n", token);
 		switch (QT_TOKEN_GET_STATUS(token) &
@@ -639,6 +781,11 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 			break;
 		}
 		dev->act_len = length - QT_TOKEN_GET_TOTALBYTES(token);
+
+		/* Start the next transfer on a fresh queue head */
+		if (QT_TOKEN_GET_STATUS(token) &
+		    ~(QT_TOKEN_STATUS_SPLITXSTATE | QT_TOKEN_STATUS_PERR))
+			ehci_async_unlink(ctrl, qh);
 	} else {
 		dev->act_len = 0;
 #ifndef CONFIG_USB_EHCI_FARADAY
@@ -649,11 +796,9 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 #endif
 	}
 
-	free(qtd);
 	return (dev->status != USB_ST_NOT_PROC) ? 0 : -1;
 
 fail:
-	free(qtd);
 	return -1;
 }
 
@@ -1007,6 +1152,10 @@ static int ehci_common_init(struct ehci_ctrl *ctrl, uint tweaks)
 	/* Set async. queue head pointer. */
 	ehci_writel(&ctrl->hcor->or_asynclistaddr, virt_to_phys(qh_list));
 
+	/* None of the cached queue heads is in the schedule any more */
+	memset(ctrl->async_qh, 0, sizeof(ctrl->async_qh));
+	ctrl->async_qh_next = 0;
+
 	/*
 	 * Set up periodic list
 	 * Step 1: Parent QH for all periodic transfers.
@@ -1090,6 +1239,9 @@ static int ehci_common_init(struct ehci_ctrl *ctrl, uint tweaks)
 int usb_lowlevel_stop(int index)
 {
 	ehci_shutdown(&ehcic[index]);
+	free(ehcic[index].qtd_pool);
+	ehcic[index].qtd_pool = NULL;
+	ehcic[index].qtd_pool_count = 0;
 	return ehci_hcd_stop(index);
 }
 
@@ -1643,6 +1795,20 @@ int ehci_deregister(struct udevice *dev)
 		return 0;
 
 	ehci_shutdown(ctrl);
+	free(ctrl->qtd_pool);
+	ctrl->qtd_pool = NULL;
+	ctrl->qtd_pool_count = 0;
+
+	return 0;
+}
+
+static int ehci_get_max_xfer_size(struct udevice *dev, size_t *size)
+{
+	/*
+	 * EHCI can handle any transfer length as long as there is enough
+	 * free heap space left, hence set the theoretical max number here.
+	 */
+	*size = SIZE_MAX;
 
 	return 0;
 }
@@ -1654,6 +1820,7 @@ struct dm_usb_ops ehci_usb_ops = {
 	.create_int_queue = ehci_create_int_queue,
 	.poll_int_queue = ehci_poll_int_queue,
 	.destroy_int_queue = ehci_destroy_int_queue,
+	.get_max_xfer_size = ehci_get_max_xfer_size,
 };
 
 #endif
@@ -44,6 +44,7 @@ struct ehci_hcor {
 #define STS_ASS		(1 << 15)
 #define	STS_PSS		(1 << 14)
 #define STS_HALT	(1 << 12)
+#define STS_IAA		(1 << 5)		/* interrupted on async advance */
 	uint32_t or_usbintr;
 #define INTR_UE         (1 << 0)                /* USB interrupt enable */
 #define INTR_UEE        (1 << 1)                /* USB error interrupt enable */
@@ -226,6 +227,24 @@ struct QH {
 	};
 };
 
+/*
+ * Number of queue heads kept linked into the asynchronous schedule between
+ * transfers, one per endpoint in use. The least recently added one is
+ * unlinked when a new endpoint needs a queue head.
+ */
+#define EHCI_ASYNC_QH_COUNT	8
+
+/*
+ * A cached queue head, padded so that it never shares a cache line. While it
+ * is in the schedule, its overlay points at one of two inactive dummy qTDs,
+ * which the controller keeps reading. A transfer is started by filling in
+ * that dummy, and its chain ends at the other one.
+ */
+struct ehci_async_qh {
+	struct QH qh;
+	struct qTD dummy[2] __aligned(USB_DMA_MINALIGN);
+} __aligned(USB_DMA_MINALIGN);
+
 /* Tweak flags for EHCI, used to control operation */
 enum {
 	/* don't use or_configflag in init */
@@ -251,6 +270,11 @@ struct ehci_ctrl {
 	uint16_t portreset;
 	struct QH qh_list __aligned(USB_DMA_MINALIGN);
 	struct QH periodic_queue __aligned(USB_DMA_MINALIGN);
+	struct ehci_async_qh async_qh[EHCI_ASYNC_QH_COUNT];
+	int async_qh_next;	/* slot to reuse when all are taken */
+	uint8_t async_dummy[EHCI_ASYNC_QH_COUNT];	/* dummy the QH is at */
+	struct qTD *qtd_pool;	/* qTDs for asynchronous transfers */
+	int qtd_pool_count;
 	uint32_t *periodic_list;
 	int periodic_schedules;
 	int ntds;
@@ -564,6 +564,7 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 
 	int running_total, trb_buff_len;
 	unsigned int total_packet_count;
+	bool hc_v1_0;
 	int maxpacketsize;
 	u64 addr;
 	int ret;
@@ -606,6 +607,13 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		running_total += TRB_MAX_BUFF_SIZE;
 	}
 
+	/* The whole TD must fit on the ring before we give it to the HC */
+	if (num_trbs > XHCI_MAX_TD_TRBS) {
+		debug("XHCI bulk transfer of %d bytes needs %d TRBs\n",
+		      length, num_trbs);
+		return -EINVAL;
+	}
+
 	/*
 	 * XXX: Calling routine prepare_ring() called in place of
 	 * prepare_trasfer() as there in 'Linux' since we are not
@@ -628,6 +636,7 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 	maxpacketsize = usb_maxpacket(udev, pipe);
 
 	total_packet_count = DIV_ROUND_UP(length, maxpacketsize);
+	hc_v1_0 = HC_VERSION(xhci_readl(&ctrl->hccr->cr_capbase)) >= 0x100;
 
 	/* How much data is in the first TRB? */
 	/*
@@ -673,7 +682,7 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 			field |= TRB_ISP;
 
 		/* Set the TRB length, TD size, and interrupter fields. */
-		if (HC_VERSION(xhci_readl(&ctrl->hccr->cr_capbase)) < 0x100)
+		if (!hc_v1_0)
 			remainder = xhci_td_remainder(length - running_total);
 		else
 			remainder = xhci_v1_0_td_remainder(running_total,
@@ -1188,6 +1188,18 @@ static int xhci_alloc_device(struct udevice *dev, struct usb_device *udev)
 	return _xhci_alloc_device(udev);
 }
 
+static int xhci_get_max_xfer_size(struct udevice *dev, size_t *size)
+{
+	/*
+	 * A transfer is queued as one TD of chained TRBs, each covering up
+	 * to 64KB, on a single-segment ring. Leave room for the link TRB
+	 * and for the partial TRBs of a buffer not aligned to 64KB.
+	 */
+	*size = XHCI_MAX_TD_TRBS * TRB_MAX_BUFF_SIZE - TRB_MAX_BUFF_SIZE;
+
+	return 0;
+}
+
 int xhci_register(struct udevice *dev, struct xhci_hccr *hccr,
 		  struct xhci_hcor *hcor)
 {
@@ -1240,6 +1252,7 @@ struct dm_usb_ops xhci_usb_ops = {
 	.bulk = xhci_submit_bulk_msg,
 	.interrupt = xhci_submit_int_msg,
 	.alloc_device = xhci_alloc_device,
+	.get_max_xfer_size = xhci_get_max_xfer_size,
 };
 
 #endif
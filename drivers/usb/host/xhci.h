@@ -1001,6 +1001,8 @@ typedef enum {
 /* TRB buffer pointers can't cross 64KB boundaries */
 #define TRB_MAX_BUFF_SHIFT	16
 #define TRB_MAX_BUFF_SIZE	(1 << TRB_MAX_BUFF_SHIFT)
+/* TRBs a single TD may use on a one-segment transfer ring */
+#define XHCI_MAX_TD_TRBS	(TRBS_PER_SEGMENT - 2)
 
 struct xhci_segment {
 	union xhci_trb		*trbs;
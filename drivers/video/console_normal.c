@@ -53,6 +53,8 @@ static int console_normal_set_row(struct udevice *dev, uint row, int clr)
 	default:
 		return -ENOSYS;
 	}
+	video_damage(dev->parent, 0, row * VIDEO_FONT_HEIGHT, vid_priv->xsize,
+		     VIDEO_FONT_HEIGHT);
 
 	return 0;
 }
@@ -67,6 +69,8 @@ static int console_normal_move_rows(struct udevice *dev, uint rowdst,
 	dst = vid_priv->fb + rowdst * VIDEO_FONT_HEIGHT * vid_priv->line_length;
 	src = vid_priv->fb + rowsrc * VIDEO_FONT_HEIGHT * vid_priv->line_length;
 	memmove(dst, src, VIDEO_FONT_HEIGHT * vid_priv->line_length * count);
+	video_damage(dev->parent, 0, rowdst * VIDEO_FONT_HEIGHT,
+		     vid_priv->xsize, VIDEO_FONT_HEIGHT * count);
 
 	return 0;
 }
@@ -77,6 +81,10 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 	struct vidconsole_priv *vc_priv = dev_get_uclass_priv(dev);
 	struct udevice *vid = dev->parent;
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
+	/* Locals, as the compiler cannot tell the frame buffer from vid_priv */
+	const int fg = vid_priv->colour_fg;
+	const int bg = vid_priv->colour_bg;
+	const uchar *font = video_fontdata + ch * VIDEO_FONT_HEIGHT;
 	int i, row;
 	void *line = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x_frac) * VNBYTES(vid_priv->bpix);
@@ -85,7 +93,7 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 		return -EAGAIN;
 
 	for (row = 0; row < VIDEO_FONT_HEIGHT; row++) {
-		uchar bits = video_fontdata[ch * VIDEO_FONT_HEIGHT + row];
+		uchar bits = font[row];
 
 		switch (vid_priv->bpix) {
 #ifdef CONFIG_VIDEO_BPP8
@@ -93,8 +101,7 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 			uint8_t *dst = line;
 
 			for (i = 0; i < VIDEO_FONT_WIDTH; i++) {
-				*dst++ = (bits & 0x80) ? vid_priv->colour_fg
-					: vid_priv->colour_bg;
+				*dst++ = (bits & 0x80) ? fg : bg;
 				bits <<= 1;
 			}
 			break;
@@ -105,8 +112,7 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 			uint16_t *dst = line;
 
 			for (i = 0; i < VIDEO_FONT_WIDTH; i++) {
-				*dst++ = (bits & 0x80) ? vid_priv->colour_fg
-					: vid_priv->colour_bg;
+				*dst++ = (bits & 0x80) ? fg : bg;
 				bits <<= 1;
 			}
 			break;
@@ -117,8 +123,7 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 			uint32_t *dst = line;
 
 			for (i = 0; i < VIDEO_FONT_WIDTH; i++) {
-				*dst++ = (bits & 0x80) ? vid_priv->colour_fg
-					: vid_priv->colour_bg;
+				*dst++ = (bits & 0x80) ? fg : bg;
 				bits <<= 1;
 			}
 			break;
@@ -129,6 +134,8 @@ static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
 		}
 		line += vid_priv->line_length;
 	}
+	video_damage(vid, VID_TO_PIXEL(x_frac), y, VIDEO_FONT_WIDTH,
+		     VIDEO_FONT_HEIGHT);
 
 	return VID_TO_POS(VIDEO_FONT_WIDTH);
 }
@@ -92,6 +92,35 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/* Number of horizontal positions within a pixel that are cached */
+#define TT_SUBPIXELS		4
+#define TT_HASH_SIZE		256
+
+/**
+ * struct tt_glyph - A rendered character in the cache
+ *
+ * @sibling:	Position in the list of least recently used characters
+ * @next:	Next character with the same hash value
+ * @codepoint:	Character, or -1 if this entry is not in use
+ * @shift:	Horizontal position within the pixel, in 1/TT_SUBPIXELS units
+ * @width:	Width of the image in pixels
+ * @height:	Height of the image in pixels
+ * @xoff:	X offset of the image from the cursor position
+ * @yoff:	Y offset of the image from the baseline
+ * @bits:	8-bit-per-pixel image of the character, or NULL if it has none
+ */
+struct tt_glyph {
+	struct list_head sibling;
+	struct tt_glyph *next;
+	int codepoint;
+	int shift;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	u8 *bits;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -111,6 +140,10 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @glyphs:	Cache entries, CONFIG_CONSOLE_TRUETYPE_CACHE_SIZE of them
+ * @hash:	Hash table of the cached characters, see tt_glyph_hash()
+ * @lru:	List of cached characters, most recently used first
+ * @stats:	Cache statistics
  */
 struct console_tt_priv {
 	int font_size;
@@ -120,8 +153,105 @@ struct console_tt_priv {
 	int pos_ptr;
 	int baseline;
 	double scale;
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	struct tt_glyph *glyphs;
+	struct tt_glyph *hash[TT_HASH_SIZE];
+	struct list_head lru;
+	struct console_tt_cache_stats stats;
+#endif
 };
 
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+static uint tt_glyph_hash(int codepoint, int shift)
+{
+	return (codepoint * TT_SUBPIXELS + shift) & (TT_HASH_SIZE - 1);
+}
+
+static void console_truetype_drop_glyph(struct console_tt_priv *priv,
+					struct tt_glyph *glyph)
+{
+	struct tt_glyph **ptr;
+
+	ptr = &priv->hash[tt_glyph_hash(glyph->codepoint, glyph->shift)];
+	while (*ptr != glyph)
+		ptr = &(*ptr)->next;
+	*ptr = glyph->next;
+	priv->stats.glyphs--;
+	priv->stats.bytes -= glyph->width * glyph->height;
+	free(glyph->bits);
+	glyph->bits = NULL;
+	glyph->codepoint = -1;
+}
+
+/**
+ * console_truetype_get_glyph() - Get the image of a character
+ *
+ * This looks up the character in the cache. If it is not there, it is
+ * rendered into the least recently used entry.
+ *
+ * @priv:	Console information
+ * @ch:		Character to get
+ * @shift:	Horizontal position within the pixel, 0 to TT_SUBPIXELS - 1
+ * @return cache entry for the character, whose @bits is NULL if it has no
+ *	image
+ */
+static struct tt_glyph *console_truetype_get_glyph(struct console_tt_priv *priv,
+						   int ch, int shift)
+{
+	struct tt_glyph **head = &priv->hash[tt_glyph_hash(ch, shift)];
+	struct tt_glyph *glyph;
+
+	for (glyph = *head; glyph; glyph = glyph->next) {
+		if (glyph->codepoint == ch && glyph->shift == shift) {
+			list_move(&glyph->sibling, &priv->lru);
+			priv->stats.hits++;
+			return glyph;
+		}
+	}
+
+	priv->stats.misses++;
+	glyph = list_last_entry(&priv->lru, struct tt_glyph, sibling);
+	if (glyph->codepoint != -1) {
+		console_truetype_drop_glyph(priv, glyph);
+		priv->stats.evictions++;
+	}
+	glyph->bits = stbtt_GetCodepointBitmapSubpixel(&priv->font,
+			priv->scale, priv->scale, (double)shift / TT_SUBPIXELS,
+			0, ch, &glyph->width, &glyph->height, &glyph->xoff,
+			&glyph->yoff);
+	if (!glyph->bits)
+		glyph->width = 0;
+	glyph->codepoint = ch;
+	glyph->shift = shift;
+	glyph->next = *head;
+	*head = glyph;
+	list_move(&glyph->sibling, &priv->lru);
+	priv->stats.glyphs++;
+	priv->stats.bytes += glyph->width * glyph->height;
+
+	return glyph;
+}
+
+int console_truetype_get_cache_stats(struct udevice *dev,
+				     struct console_tt_cache_stats *stats)
+{
+	struct console_tt_priv *priv;
+
+	if (dev->driver != DM_GET_DRIVER(vidconsole_truetype))
+		return -ENOSYS;
+	priv = dev_get_priv(dev);
+	*stats = priv->stats;
+
+	return 0;
+}
+#else
+int console_truetype_get_cache_stats(struct udevice *dev,
+				     struct console_tt_cache_stats *stats)
+{
+	return -ENOSYS;
+}
+#endif
+
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 {
 	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
@@ -162,6 +292,8 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 	default:
 		return -ENOSYS;
 	}
+	video_damage(dev->parent, 0, row * priv->font_size, vid_priv->xsize,
+		     priv->font_size);
 
 	return 0;
 }
@@ -178,6 +310,8 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	dst = vid_priv->fb + rowdst * priv->font_size * vid_priv->line_length;
 	src = vid_priv->fb + rowsrc * priv->font_size * vid_priv->line_length;
 	memmove(dst, src, priv->font_size * vid_priv->line_length * count);
+	video_damage(dev->parent, 0, rowdst * priv->font_size, vid_priv->xsize,
+		     priv->font_size * count);
 
 	/* Scroll up our position history */
 	diff = (rowsrc - rowdst) * priv->font_size;
@@ -187,6 +321,84 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_truetype_blit() - Draw the image of a character
+ *
+ * This converts the 8bpp image into the colour depth of the display. We only
+ * expect white-on-black or the reverse so the code only handles this simple
+ * case: the image is ORed into the frame buffer for a white foreground and
+ * ANDed for black, and inverted for a non-black background.
+ *
+ * @vid_priv:	Video device information
+ * @line:	Frame buffer address of the cursor position on the first line
+ * @glyph:	Character to draw
+ * @return 0 if OK, -ENOSYS if the display depth is not supported
+ */
+static int console_truetype_blit(struct video_priv *vid_priv, void *line,
+				 struct tt_glyph *glyph)
+{
+	bool invert = vid_priv->colour_bg;
+	bool set = vid_priv->colour_fg;
+	/* Pixels with this value leave the frame buffer as it is */
+	int skip = invert == set ? 255 : 0;
+	u8 *bits = glyph->bits;
+	int row, i;
+
+	switch (vid_priv->bpix) {
+#ifdef CONFIG_VIDEO_BPP16
+	case VIDEO_BPP16:
+		for (row = 0; row < glyph->height; row++) {
+			uint16_t *dst = (uint16_t *)line + glyph->xoff;
+
+			for (i = 0; i < glyph->width; i++, dst++) {
+				int val = *bits++;
+				int out;
+
+				if (val == skip)
+					continue;
+				if (invert)
+					val = 255 - val;
+				out = val >> 3 | (val >> 2) << 5 |
+					(val >> 3) << 11;
+				if (set)
+					*dst |= out;
+				else
+					*dst &= out;
+			}
+			line += vid_priv->line_length;
+		}
+		break;
+#endif
+#ifdef CONFIG_VIDEO_BPP32
+	case VIDEO_BPP32:
+		for (row = 0; row < glyph->height; row++) {
+			uint32_t *dst = (uint32_t *)line + glyph->xoff;
+
+			for (i = 0; i < glyph->width; i++, dst++) {
+				u32 val = *bits++;
+				u32 out;
+
+				if (val == skip)
+					continue;
+				if (invert)
+					val = 255 - val;
+				out = val | val << 8 | val << 16;
+				if (set)
+					*dst |= out;
+				else
+					*dst &= out | 0xff000000;
+			}
+			line += vid_priv->line_length;
+		}
+		break;
+#endif
+	default:
+		return -ENOSYS;
+	}
+
+	return 0;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    char ch)
 {
@@ -195,15 +407,17 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	stbtt_fontinfo *font = &priv->font;
-	int width, height, xoff, yoff;
+	struct tt_glyph *glyph;
+#ifndef CONFIG_CONSOLE_TRUETYPE_CACHE
+	struct tt_glyph uncached;
+#endif
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
 	int advance;
 	void *line;
-	int row;
+	int ret;
 
 	/* First get some basic metrics about this character */
 	stbtt_GetCodepointHMetrics(font, ch, &advance, &lsb);
@@ -241,61 +455,36 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	/*
 	 * Figure out how much past the start of a pixel we are, and pass this
 	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * image of the character. For empty characters, like ' ', there is no
+	 * image.
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, priv->scale, priv->scale,
-						x_shift, 0, ch, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	glyph = console_truetype_get_glyph(priv, ch,
+			clamp((int)(x_shift * TT_SUBPIXELS), 0,
+			      TT_SUBPIXELS - 1));
+#else
+	glyph = &uncached;
+	glyph->bits = stbtt_GetCodepointBitmapSubpixel(font, priv->scale,
+			priv->scale, x_shift, 0, ch, &glyph->width,
+			&glyph->height, &glyph->xoff, &glyph->yoff);
+#endif
+	if (!glyph->bits)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
 	line = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = priv->baseline + yoff;
+	linenum = priv->baseline + glyph->yoff;
 	if (linenum > 0)
 		line += linenum * vid_priv->line_length;
-
-	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
-	 */
-	for (row = 0; row < height; row++) {
-		switch (vid_priv->bpix) {
-#ifdef CONFIG_VIDEO_BPP16
-		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
-			int i;
-
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val >> 3 |
-					(val >> 2) << 5 |
-					(val >> 3) << 11;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
-			}
-			break;
-		}
+	ret = console_truetype_blit(vid_priv, line, glyph);
+#ifndef CONFIG_CONSOLE_TRUETYPE_CACHE
+	free(glyph->bits);
 #endif
-		default:
-			free(data);
-			return -ENOSYS;
-		}
-
-		line += vid_priv->line_length;
-	}
-	free(data);
+	if (ret)
+		return ret;
+	video_damage(vid, VID_TO_PIXEL(x) + glyph->xoff, y + max(linenum, 0),
+		     glyph->width, glyph->height);
 
 	return width_frac;
 }
@@ -358,6 +547,7 @@ static int console_truetype_erase(struct udevice *dev, int xstart, int ystart,
 		}
 		line += vid_priv->line_length;
 	}
+	video_damage(dev->parent, xstart, ystart, xend - xstart, yend - ystart);
 
 	return 0;
 }
@@ -501,6 +691,9 @@ static int console_truetype_probe(struct udevice *dev)
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid_dev);
 	stbtt_fontinfo *font = &priv->font;
 	int ascent;
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	int i;
+#endif
 
 	debug("%s: start\n", __func__);
 	if (vid_priv->font_size)
@@ -529,11 +722,38 @@ static int console_truetype_probe(struct udevice *dev)
 	priv->scale = stbtt_ScaleForPixelHeight(font, priv->font_size);
 	stbtt_GetFontVMetrics(font, &ascent, 0, 0);
 	priv->baseline = (int)(ascent * priv->scale);
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	priv->glyphs = calloc(CONFIG_CONSOLE_TRUETYPE_CACHE_SIZE,
+			      sizeof(struct tt_glyph));
+	if (!priv->glyphs)
+		return -ENOMEM;
+	INIT_LIST_HEAD(&priv->lru);
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_CACHE_SIZE; i++) {
+		priv->glyphs[i].codepoint = -1;
+		list_add_tail(&priv->glyphs[i].sibling, &priv->lru);
+	}
+#endif
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	debug("%s: %lu hits, %lu misses, %lu evictions\n", __func__,
+	      priv->stats.hits, priv->stats.misses, priv->stats.evictions);
+	for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_CACHE_SIZE; i++)
+		free(priv->glyphs[i].bits);
+	free(priv->glyphs);
+#endif
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -547,5 +767,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto_alloc_size	= sizeof(struct console_tt_priv),
 };
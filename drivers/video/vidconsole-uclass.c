@@ -102,8 +102,6 @@ static void vidconsole_newline(struct udevice *dev)
 		priv->ycur -= rows * priv->y_charsize;
 	}
 	priv->last_ch = 0;
-
-	video_sync(dev->parent);
 }
 
 int vidconsole_put_char(struct udevice *dev, char ch)
@@ -162,6 +160,8 @@ static void vidconsole_putc(struct stdio_dev *sdev, const char ch)
 	struct udevice *dev = sdev->priv;
 
 	vidconsole_put_char(dev, ch);
+	if (ch == '\n')
+		video_sync(dev->parent);
 }
 
 static void vidconsole_puts(struct stdio_dev *sdev, const char *s)
@@ -258,6 +258,7 @@ static int do_video_puts(cmd_tbl_t *cmdtp, int flag, int argc,
 		return CMD_RET_FAILURE;
 	for (s = argv[1]; *s; s++)
 		vidconsole_put_char(dev, *s);
+	video_sync(dev->parent);
 
 	return 0;
 }
@@ -87,6 +87,30 @@ int video_reserve(ulong *addrp)
 	return 0;
 }
 
+static void video_clear_damage(struct video_priv *priv)
+{
+	priv->damage_xstart = priv->xsize;
+	priv->damage_ystart = priv->ysize;
+	priv->damage_xend = 0;
+	priv->damage_yend = 0;
+}
+
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int xend = min_t(int, x + width, priv->xsize);
+	int yend = min_t(int, y + height, priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (x >= xend || y >= yend)
+		return;
+	priv->damage_xstart = min(priv->damage_xstart, x);
+	priv->damage_ystart = min(priv->damage_ystart, y);
+	priv->damage_xend = max(priv->damage_xend, xend);
+	priv->damage_yend = max(priv->damage_yend, yend);
+}
+
 static int video_clear(struct udevice *dev)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
@@ -100,35 +124,70 @@ static int video_clear(struct udevice *dev)
 	} else {
 		memset(priv->fb, priv->colour_bg, priv->fb_size);
 	}
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 
 	return 0;
 }
 
+#if defined(CONFIG_ARM) && !defined(CONFIG_SYS_DCACHE_OFF)
+static void video_flush_range(ulong start, ulong end)
+{
+	flush_dcache_range(round_down(start, CONFIG_SYS_CACHELINE_SIZE),
+			   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
+}
+
+/*
+ * Flush the damaged area. A narrow area, such as a character, is flushed
+ * a line at a time, which avoids flushing the rest of each line.
+ */
+static void video_flush_damage(struct video_priv *priv)
+{
+	int bits = VNBITS(priv->bpix);
+	ulong line = (ulong)priv->fb + priv->damage_ystart * priv->line_length;
+	ulong start = priv->damage_xstart * bits / 8;
+	ulong end = DIV_ROUND_UP(priv->damage_xend * bits, 8);
+	int y;
+
+	if (end - start > priv->line_length / 2) {
+		video_flush_range(line + start,
+				  line + (priv->damage_yend -
+					  priv->damage_ystart - 1) *
+				  priv->line_length + end);
+		return;
+	}
+	for (y = priv->damage_ystart; y < priv->damage_yend; y++) {
+		video_flush_range(line + start, line + end);
+		line += priv->line_length;
+	}
+}
+#endif
+
 /* Flush video activity to the caches */
 void video_sync(struct udevice *vid)
 {
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	if (!priv->damage_xend)
+		return;
+
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
 	 * architectures do not actually implement it. Is there a way to find
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !defined(CONFIG_SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
-	}
+	if (priv->flush_dcache)
+		video_flush_damage(priv);
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
-	if (get_timer(last_sync) > 10) {
-		sandbox_sdl_sync(priv->fb);
-		last_sync = get_timer(0);
-	}
+	/* Keep the damage until the display is actually updated */
+	if (get_timer(last_sync) <= 10)
+		return;
+	sandbox_sdl_sync(priv->fb);
+	last_sync = get_timer(0);
 #endif
+	video_clear_damage(priv);
 }
 
 void video_sync_all(void)
@@ -192,6 +251,7 @@ static int video_post_probe(struct udevice *dev)
 	priv->fb = map_sysmem(plat->base, plat->size);
 	priv->line_length = priv->xsize * VNBYTES(priv->bpix);
 	priv->fb_size = priv->line_length * priv->ysize;
+	video_clear_damage(priv);
 
 	/* Set up colours - we could in future support other colours */
 #ifdef CONFIG_SYS_WHITE_ON_BLACK
@@ -11,6 +11,7 @@
 #include <video.h>
 #include <watchdog.h>
 #include <asm/unaligned.h>
+#include <u-boot/zlib.h>
 
 #ifdef CONFIG_VIDEO_BMP_RLE8
 #define BMP_RLE8_ESCAPE		0
@@ -128,19 +129,6 @@ static void video_display_rle8_bitmap(struct udevice *dev,
 }
 #endif
 
-__weak void fb_put_byte(uchar **fb, uchar **from)
-{
-	*(*fb)++ = *(*from)++;
-}
-
-#if defined(CONFIG_BMP_16BPP)
-__weak void fb_put_word(uchar **fb, uchar **from)
-{
-	*(*fb)++ = *(*from)++;
-	*(*fb)++ = *(*from)++;
-}
-#endif /* CONFIG_BMP_16BPP */
-
 #define BMP_ALIGN_CENTER	0x7fff
 
 /**
@@ -189,28 +177,86 @@ static void video_set_cmap(struct udevice *dev,
 	}
 }
 
-int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
-		      bool align)
+/* Convert a row of 8bpp palette indexes to 16bpp */
+static void video_bmp_row_8_16(void *dst, const uchar *src, const ushort *cmap,
+			       int width)
 {
-	struct video_priv *priv = dev_get_uclass_priv(dev);
-	ushort *cmap_base = NULL;
-	int i, j;
+	u16 *fb = dst;
+
+	for (; width >= 4; width -= 4) {
+		fb[0] = cmap[src[0]];
+		fb[1] = cmap[src[1]];
+		fb[2] = cmap[src[2]];
+		fb[3] = cmap[src[3]];
+		fb += 4;
+		src += 4;
+	}
+	while (width--)
+		*fb++ = cmap[*src++];
+}
+
+#if defined(CONFIG_BMP_24BMP)
+/* Convert a row of 24bpp BGR pixels to 32bpp */
+static void video_bmp_row_24_32(void *dst, const uchar *src,
+				const ushort *cmap, int width)
+{
+	u32 *fb = dst;
+
+	while (width--) {
+		*fb++ = cpu_to_le32(src[0] | src[1] << 8 | src[2] << 16);
+		src += 3;
+	}
+}
+#endif
+
+/**
+ * struct video_bmp_draw - Information about drawing a BMP image
+ *
+ * @width:	Number of pixels to draw on each row
+ * @height:	Number of rows to draw
+ * @stride:	Number of bytes of each row in the BMP image, including padding
+ * @copy_len:	Number of bytes to copy on each row, if @row_func is NULL
+ * @compression: Compression of the image (BMP_BI_...)
+ * @fb:		Frame buffer address of the first row drawn, i.e. the bottom
+ * @row_func:	Function to convert a row to the frame-buffer format, or NULL
+ *		if the formats are the same
+ */
+struct video_bmp_draw {
+	ulong width;
+	ulong height;
+	ulong stride;
+	ulong copy_len;
+	u32 compression;
 	uchar *fb;
-	struct bmp_image *bmp = map_sysmem(bmp_image, 0);
-	uchar *bmap;
-	ushort padded_width;
-	unsigned long width, height, byte_width;
+	void (*row_func)(void *dst, const uchar *src, const ushort *cmap,
+			 int width);
+};
+
+/**
+ * video_bmp_setup() - Check a BMP image and work out how to draw it
+ *
+ * This sets up the palette for images which have one.
+ *
+ * @dev:	Video device
+ * @bmp:	BMP image, only the header and palette are used
+ * @xp:		X position, updated if @align is true
+ * @yp:		Y position, updated if @align is true
+ * @align:	true to adjust the position as described in
+ *		video_bmp_display()
+ * @draw:	Returns information about drawing the image
+ * @return 0 if OK, -ve on error
+ */
+static int video_bmp_setup(struct udevice *dev, struct bmp_image *bmp,
+			   int *xp, int *yp, bool align,
+			   struct video_bmp_draw *draw)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	unsigned long width, height;
 	unsigned long pwidth = priv->xsize;
 	unsigned colours, bpix, bmp_bpix;
 	struct bmp_color_table_entry *palette;
 	int hdr_size;
-
-	if (!bmp || !(bmp->header.signature[0] == 'B' &&
-	    bmp->header.signature[1] == 'M')) {
-		printf("Error: no valid bmp image at %lx\n", bmp_image);
-
-		return -EINVAL;
-	}
+	int x = *xp, y = *yp;
 
 	width = get_unaligned_le32(&bmp->header.width);
 	height = get_unaligned_le32(&bmp->header.height);
@@ -248,7 +294,8 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	if (bmp_bpix == 8)
 		video_set_cmap(dev, palette, colours);
 
-	padded_width = (width & 0x3 ? (width & ~0x3) + 4 : width);
+	draw->stride = ALIGN(DIV_ROUND_UP(width * bmp_bpix, 8),
+			     BMP_DATA_ALIGN);
 
 	if (align) {
 		video_splash_align_axis(&x, priv->xsize, width);
@@ -260,94 +307,237 @@ int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
 	if ((y + height) > priv->ysize)
 		height = priv->ysize - y;
 
-	bmap = (uchar *)bmp + get_unaligned_le32(&bmp->header.data_offset);
-	fb = (uchar *)(priv->fb +
+	draw->width = width;
+	draw->height = height;
+	draw->compression = get_unaligned_le32(&bmp->header.compression);
+	draw->fb = (uchar *)(priv->fb +
 		(y + height - 1) * priv->line_length + x * bpix / 8);
+	draw->copy_len = DIV_ROUND_UP(width * bmp_bpix, 8);
 
 	switch (bmp_bpix) {
 	case 1:
-	case 8: {
-		cmap_base = priv->cmap;
+	case 8:
 #ifdef CONFIG_VIDEO_BMP_RLE8
-		u32 compression = get_unaligned_le32(&bmp->header.compression);
-		debug("compressed %d %d\n", compression, BMP_BI_RLE8);
-		if (compression == BMP_BI_RLE8) {
-			if (bpix != 16) {
-				/* TODO implement render code for bpix != 16 */
-				printf("Error: only support 16 bpix");
-				return -EPROTONOSUPPORT;
-			}
-			video_display_rle8_bitmap(dev, bmp, cmap_base, fb, x,
-						  y);
-			break;
+		debug("compressed %d %d\n", draw->compression, BMP_BI_RLE8);
+		if (draw->compression == BMP_BI_RLE8 && bpix != 16) {
+			/* TODO implement render code for bpix != 16 */
+			printf("Error: only support 16 bpix");
+			return -EPROTONOSUPPORT;
 		}
 #endif
-
-		if (bpix != 16)
-			byte_width = width;
-		else
-			byte_width = width * 2;
-
-		for (i = 0; i < height; ++i) {
-			WATCHDOG_RESET();
-			for (j = 0; j < width; j++) {
-				if (bpix != 16) {
-					fb_put_byte(&fb, &bmap);
-				} else {
-					*(uint16_t *)fb = cmap_base[*bmap];
-					bmap++;
-					fb += sizeof(uint16_t) / sizeof(*fb);
-				}
-			}
-			bmap += (padded_width - width);
-			fb -= byte_width + priv->line_length;
-		}
+		draw->row_func = bpix == 16 ? video_bmp_row_8_16 : NULL;
 		break;
-	}
 #if defined(CONFIG_BMP_16BPP)
 	case 16:
-		for (i = 0; i < height; ++i) {
-			WATCHDOG_RESET();
-			for (j = 0; j < width; j++)
-				fb_put_word(&fb, &bmap);
-
-			bmap += (padded_width - width) * 2;
-			fb -= width * 2 + priv->line_length;
-		}
+		draw->row_func = NULL;
 		break;
 #endif /* CONFIG_BMP_16BPP */
 #if defined(CONFIG_BMP_24BMP)
 	case 24:
-		for (i = 0; i < height; ++i) {
-			for (j = 0; j < width; j++) {
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-				*(fb++) = 0;
-			}
-			fb -= priv->line_length + width * (bpix / 8);
-		}
+		draw->row_func = video_bmp_row_24_32;
 		break;
 #endif /* CONFIG_BMP_24BMP */
 #if defined(CONFIG_BMP_32BPP)
 	case 32:
-		for (i = 0; i < height; ++i) {
-			for (j = 0; j < width; j++) {
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-				*(fb++) = *(bmap++);
-			}
-			fb -= priv->line_length + width * (bpix / 8);
-		}
+		draw->row_func = NULL;
 		break;
 #endif /* CONFIG_BMP_32BPP */
 	default:
+		/* Nothing is drawn, as before */
+		draw->row_func = NULL;
+		draw->height = 0;
 		break;
 	};
 
-	video_sync(dev);
+	*xp = x;
+	*yp = y;
 
 	return 0;
 }
 
+/* Draw a row of the image and move to the row above it */
+static void video_bmp_put_row(struct video_priv *priv,
+			      struct video_bmp_draw *draw, const uchar *src)
+{
+	if (draw->row_func)
+		draw->row_func(draw->fb, src, priv->cmap, draw->width);
+	else
+		memcpy(draw->fb, src, draw->copy_len);
+	draw->fb -= priv->line_length;
+}
+
+#ifdef CONFIG_VIDEO_BMP_GZIP
+/* Decompress exactly @len bytes, returning -EIO if there are fewer */
+static int video_bmp_inflate(z_stream *s, void *dst, uint len)
+{
+	int ret;
+
+	s->next_out = dst;
+	s->avail_out = len;
+	do {
+		ret = inflate(s, Z_SYNC_FLUSH);
+	} while (ret == Z_OK && s->avail_out);
+
+	return s->avail_out ? -EIO : 0;
+}
+
+/*
+ * Display a gzipped BMP image. Rows are decompressed one at a time and
+ * converted straight into the frame buffer, so the image is never held in
+ * memory. RLE8 images need random access so they are decompressed into a
+ * buffer of the size given in their header.
+ */
+static int video_bmp_display_gzip(struct udevice *dev, uchar *src, int x,
+				  int y, bool align)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_bmp_draw draw;
+	struct bmp_image *bmp, *whole;
+	ulong data_offset;
+	uchar *row = NULL;
+	z_stream s;
+	int offset;
+	int ret, i;
+
+	offset = gzip_parse_header(src, CONFIG_SYS_VIDEO_LOGO_MAX_SIZE);
+	if (offset < 0)
+		return -EINVAL;
+	memset(&s, '\0', sizeof(s));
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+	if (inflateInit2(&s, -MAX_WBITS) != Z_OK)
+		return -ENOMEM;
+	s.next_in = src + offset;
+	s.avail_in = CONFIG_SYS_VIDEO_LOGO_MAX_SIZE;
+
+	bmp = malloc(sizeof(struct bmp_header));
+	if (!bmp) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	ret = video_bmp_inflate(&s, bmp, sizeof(struct bmp_header));
+	if (ret)
+		goto err;
+	data_offset = get_unaligned_le32(&bmp->header.data_offset);
+	if (bmp->header.signature[0] != 'B' ||
+	    bmp->header.signature[1] != 'M' ||
+	    data_offset < sizeof(struct bmp_header) ||
+	    data_offset > CONFIG_SYS_VIDEO_LOGO_MAX_SIZE) {
+		printf("Error: no valid bmp image in gzipped data\n");
+		ret = -EINVAL;
+		goto err;
+	}
+
+	/* Read the rest of the header and the palette */
+	whole = realloc(bmp, data_offset);
+	if (!whole) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	bmp = whole;
+	ret = video_bmp_inflate(&s, (void *)bmp + sizeof(struct bmp_header),
+				data_offset - sizeof(struct bmp_header));
+	if (ret)
+		goto err;
+	ret = video_bmp_setup(dev, bmp, &x, &y, align, &draw);
+	if (ret)
+		goto err;
+
+#ifdef CONFIG_VIDEO_BMP_RLE8
+	if (draw.compression == BMP_BI_RLE8) {
+		ulong file_size = get_unaligned_le32(&bmp->header.file_size);
+		uchar *end;
+
+		if (file_size <= data_offset ||
+		    file_size > CONFIG_SYS_VIDEO_LOGO_MAX_SIZE) {
+			ret = -EINVAL;
+			goto err;
+		}
+		/* Add an end-of-bitmap marker in case the data is short */
+		whole = realloc(bmp, file_size + 2);
+		if (!whole) {
+			ret = -ENOMEM;
+			goto err;
+		}
+		bmp = whole;
+		end = (uchar *)bmp + data_offset;
+		memset(end, '\0', file_size + 2 - data_offset);
+		video_bmp_inflate(&s, end, file_size - data_offset);
+		end[file_size - data_offset + 1] = BMP_RLE8_EOBMP;
+		video_display_rle8_bitmap(dev, bmp, priv->cmap, draw.fb, x, y);
+		goto done;
+	}
+#endif
+	row = malloc(draw.stride);
+	if (!row) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	for (i = 0; i < draw.height; i++) {
+		WATCHDOG_RESET();
+		ret = video_bmp_inflate(&s, row, draw.stride);
+		if (ret) {
+			printf("Error: gzipped bmp image is truncated\n");
+			break;
+		}
+		video_bmp_put_row(priv, &draw, row);
+	}
+#ifdef CONFIG_VIDEO_BMP_RLE8
+done:
+#endif
+	video_damage(dev, x, y, draw.width, draw.height);
+	video_sync(dev);
+err:
+	inflateEnd(&s);
+	free(row);
+	free(bmp);
+
+	return ret;
+}
+#endif
+
+int video_bmp_display(struct udevice *dev, ulong bmp_image, int x, int y,
+		      bool align)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct bmp_image *bmp = map_sysmem(bmp_image, 0);
+	struct video_bmp_draw draw;
+	uchar *bmap;
+	int ret, i;
+
+#ifdef CONFIG_VIDEO_BMP_GZIP
+	if (bmp && (uchar)bmp->header.signature[0] == 0x1f &&
+	    (uchar)bmp->header.signature[1] == 0x8b)
+		return video_bmp_display_gzip(dev, (uchar *)bmp, x, y, align);
+#endif
+	if (!bmp || !(bmp->header.signature[0] == 'B' &&
+	    bmp->header.signature[1] == 'M')) {
+		printf("Error: no valid bmp image at %lx\n", bmp_image);
+
+		return -EINVAL;
+	}
+
+	ret = video_bmp_setup(dev, bmp, &x, &y, align, &draw);
+	if (ret)
+		return ret;
+
+#ifdef CONFIG_VIDEO_BMP_RLE8
+	if (draw.compression == BMP_BI_RLE8) {
+		video_display_rle8_bitmap(dev, bmp, priv->cmap, draw.fb, x, y);
+		goto done;
+	}
+#endif
+	bmap = (uchar *)bmp + get_unaligned_le32(&bmp->header.data_offset);
+	for (i = 0; i < draw.height; i++) {
+		WATCHDOG_RESET();
+		video_bmp_put_row(priv, &draw, bmap);
+		bmap += draw.stride;
+	}
+#ifdef CONFIG_VIDEO_BMP_RLE8
+done:
+#endif
+	video_damage(dev, x, y, draw.width, draw.height);
+	video_sync(dev);
+
+	return 0;
+}
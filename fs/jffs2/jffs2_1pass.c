@@ -543,7 +543,7 @@ add_node(struct b_list *list)
 }
 
 static struct b_node *
-insert_node(struct b_list *list, u32 offset)
+insert_node(struct b_list *list, u32 offset, u32 ino, u32 version)
 {
 	struct b_node *new;
 
@@ -553,6 +553,8 @@ insert_node(struct b_list *list, u32 offset)
 	}
 	new->offset = offset;
 	new->next = NULL;
+	new->ino = ino;
+	new->version = version;
 
 	if (list->listTail != NULL)
 		list->listTail->next = new;
@@ -569,18 +571,8 @@ insert_node(struct b_list *list, u32 offset)
  */
 static int compare_inodes(struct b_node *new, struct b_node *old)
 {
-	/*
-	 * Only read in the version info from flash, not the entire inode.
-	 * This can make a big difference to speed if flash is slow.
-	 */
-	u32 new_version;
-	u32 old_version;
-	get_fl_mem(new->offset + offsetof(struct jffs2_raw_inode, version),
-		   sizeof(new_version), &new_version);
-	get_fl_mem(old->offset + offsetof(struct jffs2_raw_inode, version),
-		   sizeof(old_version), &old_version);
-
-	return new_version > old_version;
+	/* The versions were kept when scanning, no need to read the flash */
+	return new->version > old->version;
 }
 
 /* Sort directory entries so all entries in the same directory
@@ -595,15 +587,18 @@ static int compare_dirents(struct b_node *new, struct b_node *old)
 	 * being read. This makes most comparisons much quicker as only one
 	 * or two entries from the node will be used most of the time.
 	 */
-	struct jffs2_raw_dirent *jNew = get_node_mem(new->offset, NULL);
-	struct jffs2_raw_dirent *jOld = get_node_mem(old->offset, NULL);
+	struct jffs2_raw_dirent *jNew;
+	struct jffs2_raw_dirent *jOld;
 	int cmp;
 	int ret;
 
-	if (jNew->pino != jOld->pino) {
-		/* ascending sort by pino */
-		ret = jNew->pino > jOld->pino;
-	} else if (jNew->nsize != jOld->nsize) {
+	/* ascending sort by pino, known without reading the nodes */
+	if (new->ino != old->ino)
+		return new->ino > old->ino;
+
+	jNew = get_node_mem(new->offset, NULL);
+	jOld = get_node_mem(old->offset, NULL);
+	if (jNew->nsize != jOld->nsize) {
 		/*
 		 * pino is the same, so use ascending sort by nsize,
 		 * so we don't do strncmp unless we really must.
@@ -686,6 +681,8 @@ jffs2_1pass_read_inode(struct b_lists *pL, u32 inode, char *dest)
 	 * we will live with it.
 	 */
 	for (b = pL->frag.listHead; b != NULL; b = b->next) {
+		if (b->ino != inode)
+			continue;
 		jNode = (struct jffs2_raw_inode *) get_fl_mem(b->offset,
 			sizeof(struct jffs2_raw_inode), pL->readbuf);
 		if ((inode == jNode->ino)) {
@@ -706,6 +703,8 @@ jffs2_1pass_read_inode(struct b_lists *pL, u32 inode, char *dest)
 #endif
 
 	for (b = pL->frag.listHead; b != NULL; b = b->next) {
+		if (b->ino != inode)
+			continue;
 		/*
 		 * Copy just the node and not the data at this point,
 		 * since we don't yet know if we need this data.
@@ -826,6 +825,8 @@ jffs2_1pass_find_inode(struct b_lists * pL, const char *name, u32 pino)
 	counter = 0;
 	/* we need to search all and return the inode with the highest version */
 	for(b = pL->dir.listHead; b; b = b->next, counter++) {
+		if (b->ino != pino)
+			continue;
 		jDir = (struct jffs2_raw_dirent *) get_node_mem(b->offset,
 								pL->readbuf);
 		if ((pino == jDir->pino) && (len == jDir->nsize) &&
@@ -947,6 +948,8 @@ jffs2_1pass_list_inodes(struct b_lists * pL, u32 pino)
 	struct jffs2_raw_dirent *jDir;
 
 	for (b = pL->dir.listHead; b; b = b->next) {
+		if (b->ino != pino)
+			continue;
 		jDir = (struct jffs2_raw_dirent *) get_node_mem(b->offset,
 								pL->readbuf);
 		if (pino == jDir->pino) {
@@ -960,7 +963,7 @@ jffs2_1pass_list_inodes(struct b_lists * pL, u32 pino)
 			do {
 				struct b_node *next = b->next;
 				struct jffs2_raw_dirent *jDirNext;
-				if (!next)
+				if (!next || next->ino != b->ino)
 					break;
 				jDirNext = (struct jffs2_raw_dirent *)
 					get_node_mem(next->offset, NULL);
@@ -985,6 +988,8 @@ jffs2_1pass_list_inodes(struct b_lists * pL, u32 pino)
 			}
 
 			for (b2 = pL->frag.listHead; b2; b2 = b2->next) {
+				if (b2->ino != jDir->ino)
+					continue;
 				jNode = (struct jffs2_raw_inode *)
 					get_fl_mem(b2->offset, sizeof(*jNode),
 						   NULL);
@@ -1114,8 +1119,9 @@ jffs2_1pass_resolve_inode(struct b_lists * pL, u32 ino)
 		return jDirFoundIno;
 
 	/* it's a soft link so we follow it again. */
-	b2 = pL->frag.listHead;
-	while (b2) {
+	for (b2 = pL->frag.listHead; b2; b2 = b2->next) {
+		if (b2->ino != jDirFoundIno)
+			continue;
 		jNode = (struct jffs2_raw_inode *) get_node_mem(b2->offset,
 								pL->readbuf);
 		if (jNode->ino == jDirFoundIno) {
@@ -1132,7 +1138,6 @@ jffs2_1pass_resolve_inode(struct b_lists * pL, u32 ino)
 			put_fl_mem(jNode, pL->readbuf);
 			break;
 		}
-		b2 = b2->next;
 		put_fl_mem(jNode, pL->readbuf);
 	}
 	/* ok so the name of the new file to find is in tmp */
@@ -1279,7 +1284,11 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 							(u32)part->offset +
 							offset +
 							sum_get_unaligned32(
-								&spi->offset));
+								&spi->offset),
+							sum_get_unaligned32(
+								&spi->inode),
+							sum_get_unaligned32(
+								&spi->version));
 						if (ret == NULL)
 							return -1;
 					}
@@ -1296,7 +1305,11 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 							(u32) part->offset +
 							offset +
 							sum_get_unaligned32(
-								&spd->offset));
+								&spd->offset),
+							sum_get_unaligned32(
+								&spd->pino),
+							sum_get_unaligned32(
+								&spd->version));
 						if (ret == NULL)
 							return -1;
 					}
@@ -1690,7 +1703,10 @@ jffs2_1pass_build_lists(struct part_info * part)
 					break;
 
 				if (insert_node(&pL->frag, (u32) part->offset +
-						ofs) == NULL) {
+						ofs, ((struct jffs2_raw_inode *)
+						      node)->ino,
+						((struct jffs2_raw_inode *)
+						 node)->version) == NULL) {
 					free(buf);
 					jffs2_free_cache(part);
 					return 0;
@@ -1725,7 +1741,10 @@ jffs2_1pass_build_lists(struct part_info * part)
 				if (! (counterN%100))
 					puts ("\b\b.  ");
 				if (insert_node(&pL->dir, (u32) part->offset +
-						ofs) == NULL) {
+						ofs, ((struct jffs2_raw_dirent *)
+						      node)->pino,
+						((struct jffs2_raw_dirent *)
+						 node)->version) == NULL) {
 					free(buf);
 					jffs2_free_cache(part);
 					return 0;
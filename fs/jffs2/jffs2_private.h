@@ -8,6 +8,13 @@ struct b_node {
 	u32 offset;
 	struct b_node *next;
 	enum { CRC_UNKNOWN = 0, CRC_OK, CRC_BAD } datacrc;
+	/*
+	 * Copied from the node when it is found, so that lists can be
+	 * searched and sorted without reading the flash: the inode of a
+	 * fragment, or the parent inode of a dirent, and its version.
+	 */
+	u32 ino;
+	u32 version;
 };
 
 struct b_list {
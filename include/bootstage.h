@@ -198,7 +198,10 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_SCSI,
 	BOOTSTAGE_ID_ACCUM_SPI,
 	BOOTSTAGE_ID_ACCUM_DECOMP,
+	BOOTSTAGE_ID_ACCUM_HUSH,
 	BOOTSTAGE_ID_FPGA_INIT,
+	BOOTSTAGE_ID_ACCUM_SPLASH,
+	BOOTSTAGE_ID_USB_DEV,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -392,6 +395,90 @@ static inline int bootstage_unstash(void *base, int size)
 }
 #endif /* CONFIG_BOOTSTAGE */
 
+/* Kinds of timing span, used to group them in reports */
+enum bootstage_span_type {
+	BOOTSTAGE_SPAN_OTHER,
+	BOOTSTAGE_SPAN_DM,		/* Device probe */
+	BOOTSTAGE_SPAN_INITCALL,
+	BOOTSTAGE_SPAN_CMD,		/* Command execution */
+
+	BOOTSTAGE_SPAN_TYPE_COUNT,
+};
+
+#if defined(CONFIG_BOOTSTAGE_SPANS) && !defined(CONFIG_SPL_BUILD) && \
+	!defined(USE_HOSTCC)
+/**
+ * bootstage_span_start() - Mark the start of a timing span
+ *
+ * Spans nest: a span started while another is open becomes its child. Each
+ * call must be matched by a call to bootstage_span_end().
+ *
+ * @type:	Kind of span
+ * @name:	Name of the span, which is copied (and truncated if long)
+ * @return span number to pass to bootstage_span_end(), or -1 if there is
+ *	no space to record it
+ */
+int bootstage_span_start(enum bootstage_span_type type, const char *name);
+
+/**
+ * bootstage_span_end() - Mark the end of a timing span
+ *
+ * @span:	Span number returned by bootstage_span_start()
+ */
+void bootstage_span_end(int span);
+
+/**
+ * bootstage_span_end_all() - End the innermost open spans of a given type
+ *
+ * This ends the current span, and its parents in turn, for as long as they
+ * are of type @type. It is used for code which never returns to end its
+ * span, such as the initcall which jumps to relocated U-Boot, so that later
+ * spans do not become its children.
+ *
+ * @type:	Kind of span to end
+ */
+void bootstage_span_end_all(enum bootstage_span_type type);
+
+/**
+ * bootstage_span_reset() - Throw away all recorded spans
+ *
+ * This is for tests which need room in the span table. Spans which are open
+ * are thrown away too, and ending them later has no effect.
+ */
+void bootstage_span_reset(void);
+
+/* Print the recorded spans as a tree */
+void bootstage_span_report(void);
+
+/**
+ * bootstage_span_json() - Write the timing data in Chrome trace-event format
+ *
+ * This writes a JSON object with a traceEvents array holding a complete
+ * event for each span and an instant event for each bootstage mark. Open
+ * spans end at the current time.
+ *
+ * @buf:	Buffer for the output, always nul-terminated if @size is not 0
+ * @size:	Size of the buffer in bytes
+ * @return number of bytes needed for the output, excluding the
+ *	terminator. If this is @size or more, the output was truncated.
+ */
+int bootstage_span_json(char *buf, int size);
+#else
+static inline int bootstage_span_start(enum bootstage_span_type type,
+				       const char *name)
+{
+	return -1;
+}
+
+static inline void bootstage_span_end(int span)
+{
+}
+
+static inline void bootstage_span_end_all(enum bootstage_span_type type)
+{
+}
+#endif /* CONFIG_BOOTSTAGE_SPANS */
+
 /* Helper macro for adding a bootstage to a line of code */
 #define BOOTSTAGE_MARKER()	\
 		bootstage_mark_code(__FILE__, __func__, __LINE__)
@@ -650,6 +650,15 @@ void	serial_putc_raw(const char);
 void	serial_puts   (const char *);
 int	serial_getc   (void);
 int	serial_tstc   (void);
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+void	serial_tx_poll(void);
+void	serial_tx_flush(void);
+void	serial_tx_resume(void);
+#else
+static inline void serial_tx_poll(void) {}
+static inline void serial_tx_flush(void) {}
+static inline void serial_tx_resume(void) {}
+#endif
 
 /* These versions take a stdio_dev pointer */
 struct stdio_dev;
@@ -796,6 +805,15 @@ ulong	usec2ticks    (unsigned long usec);
 ulong	ticks2usec    (unsigned long ticks);
 
 /* lib/gunzip.c */
+/**
+ * gzip_parse_header() - Check the header of gzip data
+ *
+ * @src:	Start of the gzip data
+ * @len:	Length of the gzip data
+ * @return length of the header in bytes, so offset of the compressed data,
+ *	or -1 if the header is not valid
+ */
+int gzip_parse_header(const unsigned char *src, unsigned long len);
 int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
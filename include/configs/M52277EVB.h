@@ -37,7 +37,6 @@
 
 /* Command line configuration */
 #define CONFIG_CMD_DATE
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_REGINFO
 #undef CONFIG_CMD_BMP
 
@@ -38,7 +38,6 @@
 /* Command line configuration */
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_IDE
-#define CONFIG_CMD_JFFS2
 #undef CONFIG_CMD_PCI
 #define CONFIG_CMD_REGINFO
 
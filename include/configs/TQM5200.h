@@ -146,7 +146,6 @@
  */
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_EEPROM
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_REGINFO
 #define CONFIG_CMD_BSP
 
@@ -93,7 +93,6 @@
  */
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_IDE
-#define CONFIG_CMD_JFFS2
 
 #ifdef	CONFIG_SPLASH_SCREEN
     #define CONFIG_CMD_BMP
@@ -91,7 +91,6 @@
  */
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_IDE
-#define CONFIG_CMD_JFFS2
 
 #define CONFIG_NETCONSOLE
 
@@ -283,7 +283,6 @@
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_DTT
 #define CONFIG_CMD_EEPROM
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_REGINFO
 
 #if defined(CONFIG_PCI)
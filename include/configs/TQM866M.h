@@ -131,7 +131,6 @@
  */
 #define CONFIG_CMD_EEPROM
 #define CONFIG_CMD_IDE
-#define CONFIG_CMD_JFFS2
 
 #define CONFIG_NETCONSOLE
 
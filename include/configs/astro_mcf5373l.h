@@ -60,9 +60,6 @@
 /* Define which commands should be available at u-boot command prompt */
 
 #define CONFIG_CMD_DATE
-#if ENABLE_JFFS
-#define CONFIG_CMD_JFFS2
-#endif
 #define CONFIG_CMD_REGINFO
 #define CONFIG_CMD_FPGA_LOADMK
 #define CONFIG_CMDLINE_EDITING
@@ -90,11 +90,6 @@
 #define CONFIG_BOOTP_SUBNETMASK
 #define CONFIG_BOOTP_GATEWAY
 
-/*
- * Command line configuration.
- */
-#define CONFIG_CMD_JFFS2
-
 #define CONFIG_ATMEL_USART
 #define CONFIG_MACB
 #define CONFIG_PORTMUX_PIO
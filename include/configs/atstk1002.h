@@ -92,11 +92,6 @@
 /* generic board */
 #define CONFIG_BOARD_EARLY_INIT_R
 
-/*
- * Command line configuration.
- */
-#define CONFIG_CMD_JFFS2
-
 #define CONFIG_ATMEL_USART
 #define CONFIG_MACB
 #define CONFIG_PORTMUX_PIO
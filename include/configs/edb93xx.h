@@ -77,7 +77,6 @@
 
 /* Monitor configuration */
 #undef CONFIG_CMD_DATE
-#define CONFIG_CMD_JFFS2
 
 #define CONFIG_SYS_LONGHELP			/* Enable "long" help in mon */
 #define CONFIG_SYS_CBSIZE		1024	/* Console I/O buffer size */
@@ -86,7 +86,6 @@
  * Command line configuration.
  */
 /* add useful commands */
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_REGINFO
 
 #define CONFIG_AUTO_COMPLETE
@@ -16,7 +16,6 @@
 #define CONFIG_CMD_DEFAULTENV_VARS
 #define CONFIG_CMD_IMMAP
 #define CONFIG_CMD_EEPROM
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_MTDPARTS
 
 #undef	CONFIG_WATCHDOG		/* disable platform specific watchdog */
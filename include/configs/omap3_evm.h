@@ -24,9 +24,6 @@
  * Supported U-Boot commands
  * ----------------------------------------------------------------------------
  */
-
-#define CONFIG_CMD_JFFS2
-
 #define CONFIG_CMD_NAND
 
 /* ----------------------------------------------------------------------------
@@ -51,7 +51,6 @@ Serial console configuration
  */
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_EEPROM
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_PCI
 
 #define	CONFIG_TIMESTAMP	1	/* Print image info with timestamp */
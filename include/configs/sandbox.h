@@ -26,6 +26,7 @@
 #endif
 
 #define CONFIG_LMB
+#define CONFIG_BCH
 #define CONFIG_ANDROID_BOOT_IMAGE
 
 #define CONFIG_CMD_PCI
@@ -127,6 +128,8 @@
 #define LCD_BPP			LCD_COLOR16
 #define CONFIG_LCD_BMP_RLE8
 #define CONFIG_VIDEO_BMP_RLE8
+#define CONFIG_VIDEO_BMP_GZIP
+#define CONFIG_SYS_VIDEO_LOGO_MAX_SIZE	(1 << 20)
 #define CONFIG_SPLASH_SCREEN_ALIGN
 
 #define CONFIG_KEYBOARD
@@ -76,7 +76,6 @@
 #define CONFIG_CMD_IDE
 #define CONFIG_CMD_DIAG
 #define CONFIG_CMD_IRQ
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_SDRAM
 #define CONFIG_CMD_DATE
 
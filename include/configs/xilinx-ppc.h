@@ -27,7 +27,6 @@
 #define CONFIG_CMD_DIAG
 #define CONFIG_CMD_IRQ
 #define CONFIG_CMD_REGINFO
-#undef CONFIG_CMD_JFFS2
 #undef CONFIG_CMD_MTDPARTS
 #undef CONFIG_CMD_DTT
 #undef CONFIG_CMD_EEPROM
@@ -79,7 +78,6 @@
 #define	CONFIG_SYS_FLASH_EMPTY_INFO	1
 #define	CONFIG_SYS_MAX_FLASH_BANKS	1
 #define	CONFIG_SYS_FLASH_PROTECTION
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_MTDPARTS
 #define CONFIG_MTD_DEVICE		/* needed for mtdparts commands */
 #define CONFIG_FLASH_CFI_MTD
@@ -178,7 +178,6 @@ extern void out32(unsigned int, unsigned long);
 #define CONFIG_CMD_DATE
 #define CONFIG_CMD_EEPROM
 #define CONFIG_CMD_IRQ
-#define CONFIG_CMD_JFFS2
 #define CONFIG_CMD_PCI
 
 /*
@@ -137,6 +137,9 @@ struct dfu_entity {
 
 	u32 bad_skip;	/* for nand use */
 
+	ulong start_time;	/* when the transfer started, ms */
+	ulong write_time;	/* time spent writing the medium, ms */
+
 	unsigned int inited:1;
 };
 
@@ -163,6 +166,23 @@ int dfu_read(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 int dfu_write(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 int dfu_flush(struct dfu_entity *de, void *buf, int size, int blk_seq_num);
 
+/**
+ * dfu_write_unbuffered - write data to the medium without buffering it
+ *
+ * Like dfu_write(), but the data is written to the medium straight from
+ * @buf instead of being collected in the DFU buffer first. This lets a
+ * caller receive into one part of its buffer while another part is written.
+ *
+ * @param de - dfu entity to which we want to store data
+ * @param buf - data to write
+ * @param size - number of bytes to write
+ * @param blk_seq_num - block sequence number, as for dfu_write()
+ *
+ * @return - 0 on success, other value on failure
+ */
+int dfu_write_unbuffered(struct dfu_entity *de, void *buf, int size,
+			 int blk_seq_num);
+
 /*
  * dfu_defer_flush - pointer to store dfu_entity for deferred flashing.
  *		     It should be NULL when not used.
@@ -101,6 +101,8 @@ efi_status_t EFIAPI efi_return_handle(void *handle,
 		uint32_t attributes);
 /* Called from places to check whether a timer expired */
 void efi_timer_check(void);
+/* Call the notification function of an event, e.g. on I/O completion */
+void efi_notify_event(void *event);
 /* PE loader implementation */
 void *efi_load_pe(void *efi, struct efi_loaded_image *loaded_image_info);
 /* Called once to store the pristine gd pointer */
@@ -137,6 +139,8 @@ uint64_t efi_add_memory_map(uint64_t start, uint64_t pages, int memory_type,
 			    bool overlap_only_ram);
 /* Called by board init to initialize the EFI memory map */
 int efi_memory_init(void);
+/* Checks that the EFI memory map is sorted and its free sizes are right */
+int efi_memory_check(void);
 /* Adds new or overrides configuration table entry to the system table */
 efi_status_t efi_install_configuration_table(const efi_guid_t *guid, void *table);
 
@@ -36,4 +36,47 @@ int env_attr_walk(const char *attr_list,
  */
 int env_attr_lookup(const char *attr_list, const char *name, char *attributes);
 
+#ifndef USE_HOSTCC
+struct env_attr_map_entry {
+	char *name;
+	unsigned long value;
+	int seq;
+	void *regex;
+};
+
+/*
+ * A pre-parsed form of one or more attribute lists, so that looking up a
+ * variable does not have to rescan the list strings. Plain names are kept
+ * sorted for a binary search; regular expressions (CONFIG_REGEX) are kept
+ * in list order after them.
+ */
+struct env_attr_map {
+	struct env_attr_map_entry *entries;
+	int count;
+	int num_names;
+};
+
+/*
+ * env_attr_map_build takes "num_lists" attribute lists with the form above,
+ * in increasing order of precedence, and converts the attributes of each
+ * entry to a value with "convert". A later entry for the same name overrides
+ * an earlier one, just as with env_attr_lookup() on the concatenated lists.
+ * Any previous contents of "map" are released.
+ * Returns 0 on success.
+ */
+int env_attr_map_build(struct env_attr_map *map, const char * const lists[],
+	int num_lists,
+	unsigned long (*convert)(const char *attributes));
+
+/*
+ * env_attr_map_lookup finds the value associated with "name" in "map".
+ * Returns 0 on success, -ENOENT if there is no entry for the name.
+ */
+int env_attr_map_lookup(const struct env_attr_map *map, const char *name,
+	unsigned long *valuep);
+
+/* env_attr_map_free releases everything allocated for "map" */
+void env_attr_map_free(struct env_attr_map *map);
+#endif
+
 #endif /* __ENV_ATTR_H__ */
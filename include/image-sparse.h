@@ -23,6 +23,16 @@ struct sparse_storage {
 	lbaint_t	(*reserve)(struct sparse_storage *info,
 				 lbaint_t blk,
 				 lbaint_t blkcnt);
+
+	/*
+	 * Optional: erase blocks so that they read back as zeros. It is
+	 * only called for ranges which start and end on a multiple of
+	 * erase_align blocks; the remainder of a zero fill is written.
+	 */
+	lbaint_t	erase_align;
+	lbaint_t	(*erase)(struct sparse_storage *info,
+				 lbaint_t blk,
+				 lbaint_t blkcnt);
 };
 
 static inline int is_sparse_image(void *buf)
@@ -35,6 +35,8 @@
 
 #define STACK_MAGIC	0xdeadbeef
 
+#define _RET_IP_		(unsigned long)__builtin_return_address(0)
+
 #define REPEAT_BYTE(x)	((~0ul / 0xff) * (x))
 
 #define ALIGN(x,a)		__ALIGN_MASK((x),(typeof(x))(a)-1)
@@ -95,6 +95,8 @@ extern void nand_wait_ready(struct mtd_info *mtd);
 #define NAND_CMD_READSTART	0x30
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 
 /* Extended commands for AG-AND device */
 /*
@@ -170,6 +172,8 @@ typedef enum {
 #define NAND_CACHEPRG		0x00000008
 /* Chip has copy back function */
 #define NAND_COPYBACK		0x00000010
+/* Chip has cache read function (READ CACHE SEQUENTIAL / END) */
+#define NAND_CACHEREAD		0x00000020
 /*
  * Chip requires ready check on read (for auto-incremented sequential read).
  * True only for small page devices; large page devices do not support
@@ -200,6 +204,7 @@ typedef enum {
 
 /* Macros to identify the above */
 #define NAND_HAS_CACHEPROG(chip) ((chip->options & NAND_CACHEPRG))
+#define NAND_HAS_CACHEREAD(chip) ((chip->options & NAND_CACHEREAD))
 #define NAND_HAS_SUBPAGE_READ(chip) ((chip->options & NAND_SUBPAGE_READ))
 
 /* Non chip related options */
@@ -226,6 +231,8 @@ typedef enum {
 #define NAND_USE_BOUNCE_BUFFER	0x00100000
 
 /* Options set by nand scan */
+/* bbt cache in the environment has been looked at */
+#define NAND_BBT_CACHE_CHECKED	0x20000000
 /* bbt has already been read */
 #define NAND_BBT_SCANNED	0x40000000
 /* Nand scan has allocated controller struct */
@@ -261,7 +268,8 @@ struct nand_chip;
 /* ONFI subfeature parameters length */
 #define ONFI_SUBFEATURE_PARAM_LEN	4
 
-/* ONFI optional commands SET/GET FEATURES supported? */
+/* ONFI optional commands READ CACHE and SET/GET FEATURES supported? */
+#define ONFI_OPT_CMD_READ_CACHE		(1 << 1)
 #define ONFI_OPT_CMD_SET_GET_FEATURES	(1 << 2)
 
 struct nand_onfi_params {
@@ -670,6 +678,9 @@ struct nand_buffers {
  * @onfi_set_features:	[REPLACEABLE] set the features for ONFI nand
  * @onfi_get_features:	[REPLACEABLE] get the features for ONFI nand
  * @bbt:		[INTERN] bad block table pointer
+ * @bbt_scanned:	[INTERN] bitmap of the blocks whose bad block marker
+ *			has been read, NULL when all have
+ * @bbt_pending:	[INTERN] number of blocks not yet in @bbt_scanned
  * @bbt_td:		[REPLACEABLE] bad block table descriptor for flash
  *			lookup.
  * @bbt_md:		[REPLACEABLE] bad block table mirror descriptor
@@ -759,6 +770,8 @@ struct nand_chip {
 	struct nand_hw_control hwcontrol;
 
 	uint8_t *bbt;
+	uint8_t *bbt_scanned;
+	int bbt_pending;
 	struct nand_bbt_descr *bbt_td;
 	struct nand_bbt_descr *bbt_md;
 
@@ -904,6 +917,7 @@ extern int nand_default_bbt(struct mtd_info *mtd);
 extern int nand_markbad_bbt(struct mtd_info *mtd, loff_t offs);
 extern int nand_isreserved_bbt(struct mtd_info *mtd, loff_t offs);
 extern int nand_isbad_bbt(struct mtd_info *mtd, loff_t offs, int allowbbt);
+extern void nand_release_bbt(struct mtd_info *mtd);
 extern int nand_erase_nand(struct mtd_info *mtd, struct erase_info *instr,
 			   int allowbbt);
 extern int nand_do_read(struct mtd_info *mtd, loff_t from, size_t len,
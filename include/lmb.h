@@ -11,6 +11,10 @@
  * SPDX-License-Identifier:	GPL-2.0+
  */
 
+/*
+ * Number of regions which fit in the region table itself. Beyond that the
+ * table is moved to the heap and grows as needed.
+ */
 #define MAX_LMB_REGIONS 8
 
 struct lmb_property {
@@ -18,20 +22,35 @@ struct lmb_property {
 	phys_size_t size;
 };
 
+/*
+ * The regions are kept sorted by base address. They never overlap and
+ * adjacent regions are coalesced, so they can be searched with a binary
+ * search.
+ */
 struct lmb_region {
 	unsigned long cnt;
+	unsigned long max;
 	phys_size_t size;
-	struct lmb_property region[MAX_LMB_REGIONS+1];
+	struct lmb_property *region;
+	struct lmb_property initial[MAX_LMB_REGIONS];
+};
+
+/* How __lmb_alloc_base() picks the free area for an allocation */
+enum lmb_alloc_policy {
+	LMB_ALLOC_TOP_DOWN,	/* highest free area which fits */
+	LMB_ALLOC_BEST_FIT,	/* smallest free area which fits */
 };
 
 struct lmb {
 	struct lmb_region memory;
 	struct lmb_region reserved;
+	enum lmb_alloc_policy policy;
 };
 
 extern struct lmb lmb;
 
 extern void lmb_init(struct lmb *lmb);
+extern void lmb_release(struct lmb *lmb);
 extern long lmb_add(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 extern long lmb_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 extern phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align);
@@ -957,6 +957,82 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/* Number of size classes used by CONFIG_SYS_MALLOC_SLAB */
+#define MALLOC_SLAB_CLASSES	8
+
+/**
+ * struct malloc_slab_class - Information about one slab size class
+ *
+ * @size:	Size of each object in bytes
+ * @pages:	Number of pages holding objects of this size
+ * @inuse:	Number of objects allocated
+ * @allocs:	Total number of allocations made from this class
+ */
+struct malloc_slab_class {
+	uint size;
+	uint pages;
+	uint inuse;
+	ulong allocs;
+};
+
+/**
+ * struct malloc_slab_info - Information about the slab allocator
+ *
+ * @page_size:	Size of each slab page in bytes
+ * @pages:	Total number of pages, 0 if the slab area is not set up yet
+ * @free_pages:	Number of pages not holding any objects
+ * @fallbacks:	Number of small allocations passed to the main heap because
+ *		there was no free page
+ * @cls:	Information about each size class
+ */
+struct malloc_slab_info {
+	uint page_size;
+	uint pages;
+	uint free_pages;
+	ulong fallbacks;
+	struct malloc_slab_class cls[MALLOC_SLAB_CLASSES];
+};
+
+/**
+ * malloc_slab_get_info() - Get information about the slab allocator
+ *
+ * @info:	Returns the information
+ */
+void malloc_slab_get_info(struct malloc_slab_info *info);
+
+/* Number of power-of-two size buckets in struct malloc_frag_info */
+#define MALLOC_FRAG_BUCKETS	16
+
+/**
+ * struct malloc_frag_info - Information about free space in the heap
+ *
+ * The top chunk is the unused space at the end of the heap, from which
+ * the heap grows. It is included in @free_bytes and @largest but not in
+ * @free_chunks or @hist.
+ *
+ * @free_bytes:	Total free space in bytes
+ * @free_chunks: Number of free chunks, not counting the top chunk
+ * @largest:	Size of the largest free chunk
+ * @top_size:	Size of the top chunk
+ * @hist:	Number of free chunks of each size, where bucket n counts
+ *		chunks of 2^(n + 4) bytes up to but not including 2^(n + 5)
+ *		bytes, and the last bucket counts everything larger
+ */
+struct malloc_frag_info {
+	ulong free_bytes;
+	uint free_chunks;
+	ulong largest;
+	ulong top_size;
+	uint hist[MALLOC_FRAG_BUCKETS];
+};
+
+/**
+ * malloc_get_frag_info() - Find out how fragmented the heap is
+ *
+ * @info:	Returns the information
+ */
+void malloc_get_frag_info(struct malloc_frag_info *info);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
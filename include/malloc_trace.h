@@ -0,0 +1,187 @@
+/*
+ * Tracking of malloc() allocations
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __MALLOC_TRACE_H
+#define __MALLOC_TRACE_H
+
+/* Maximum number of scopes (commands) which are counted separately */
+#define MALLOC_TRACE_SCOPES	32
+
+/* Flags for an allocation */
+enum malloc_trace_flags {
+	MALLOC_TRACE_DEVRES	= 1 << 0,	/* Managed device resource */
+};
+
+/**
+ * struct malloc_trace_scope - Heap use by a scope
+ *
+ * Each command is a scope, so this shows how much memory the command has
+ * allocated and not yet freed. Scope 0 holds allocations made outside any
+ * command, such as while starting up.
+ *
+ * @name:	Name of the scope (command name)
+ * @allocs:	Total number of allocations made in this scope
+ * @count:	Number of allocations which are still outstanding
+ * @bytes:	Number of bytes still outstanding
+ * @peak:	Largest value that @bytes has had
+ */
+struct malloc_trace_scope {
+	const char *name;
+	ulong allocs;
+	uint count;
+	ulong bytes;
+	ulong peak;
+};
+
+/**
+ * struct malloc_trace_stats - Overall heap use
+ *
+ * @allocs:	Total number of allocations traced
+ * @count:	Number of allocations still outstanding
+ * @bytes:	Number of bytes still outstanding
+ * @peak:	Largest value that @bytes has had
+ * @devres_count: Number of outstanding allocations for device resources
+ * @devres_bytes: Number of bytes outstanding for device resources
+ * @dropped:	Number of allocations not traced because the table was full
+ */
+struct malloc_trace_stats {
+	ulong allocs;
+	uint count;
+	ulong bytes;
+	ulong peak;
+	uint devres_count;
+	ulong devres_bytes;
+	ulong dropped;
+};
+
+#if defined(CONFIG_MALLOC_TRACE) && !defined(CONFIG_SPL_BUILD)
+/**
+ * malloc_trace_alloc() - Record an allocation
+ *
+ * This is called by malloc() and friends. The allocation is charged to the
+ * current scope.
+ *
+ * @ptr:	Pointer returned by the allocator, or NULL if it failed
+ * @size:	Number of bytes requested
+ * @caller:	Address of the code which asked for the memory
+ */
+void malloc_trace_alloc(void *ptr, size_t size, ulong caller);
+
+/**
+ * malloc_trace_realloc() - Record that an allocation has been resized
+ *
+ * The allocation keeps its sequence number and scope, so growing an old
+ * buffer is not reported as a new allocation.
+ *
+ * @oldptr:	Pointer passed to realloc()
+ * @ptr:	Pointer returned by realloc(), or NULL if the memory was freed
+ * @size:	New size in bytes
+ * @caller:	Address of the code which called realloc()
+ */
+void malloc_trace_realloc(void *oldptr, void *ptr, size_t size, ulong caller);
+
+/**
+ * malloc_trace_free() - Record that an allocation has been freed
+ *
+ * @ptr:	Pointer being freed (it is ignored if it is not being traced)
+ */
+void malloc_trace_free(void *ptr);
+
+/**
+ * malloc_trace_set_caller() - Update the caller of an allocation
+ *
+ * Wrappers around malloc(), such as kmalloc() and devres_alloc(), use this
+ * so that the allocation is charged to their own caller.
+ *
+ * @ptr:	Pointer returned by the allocator
+ * @caller:	Address of the code which asked for the memory
+ * @flags:	Flags to add to the allocation (enum malloc_trace_flags)
+ */
+void malloc_trace_set_caller(void *ptr, ulong caller, uint flags);
+
+/**
+ * malloc_trace_enter() - Start charging allocations to a new scope
+ *
+ * @name:	Name of the scope, which must remain valid (normally the
+ *		command name)
+ * @return the previous scope, to pass to malloc_trace_leave()
+ */
+int malloc_trace_enter(const char *name);
+
+/**
+ * malloc_trace_leave() - Go back to the previous scope
+ *
+ * @prev:	Value returned by malloc_trace_enter()
+ */
+void malloc_trace_leave(int prev);
+
+/**
+ * malloc_trace_mark() - Get a mark to check for leaks after
+ *
+ * @return the sequence number that the next allocation will have
+ */
+uint malloc_trace_mark(void);
+
+/**
+ * malloc_trace_outstanding() - Find allocations which have not been freed
+ *
+ * @since:	Only count allocations made at or after this mark, from
+ *		malloc_trace_mark(). Use 0 for all allocations.
+ * @scope:	Only count allocations in this scope, or NULL for all
+ * @show:	true to print each allocation, oldest first
+ * @bytesp:	Returns the number of bytes outstanding, if not NULL
+ * @return number of allocations outstanding, or -ENOMEM if @show is true
+ *	and there was not enough memory to sort them
+ */
+int malloc_trace_outstanding(uint since, const char *scope, bool show,
+			     ulong *bytesp);
+
+/**
+ * malloc_trace_get_scope() - Get heap use by a scope
+ *
+ * @index:	Scope number, starting from 0
+ * @return the scope, or NULL if @index is not in use
+ */
+const struct malloc_trace_scope *malloc_trace_get_scope(int index);
+
+/**
+ * malloc_trace_get_stats() - Get overall heap use
+ *
+ * @stats:	Returns the information
+ */
+void malloc_trace_get_stats(struct malloc_trace_stats *stats);
+#else
+static inline void malloc_trace_alloc(void *ptr, size_t size, ulong caller)
+{
+}
+
+static inline void malloc_trace_realloc(void *oldptr, void *ptr, size_t size,
+					ulong caller)
+{
+}
+
+static inline void malloc_trace_free(void *ptr)
+{
+}
+
+static inline void malloc_trace_set_caller(void *ptr, ulong caller,
+					   uint flags)
+{
+}
+
+static inline int malloc_trace_enter(const char *name)
+{
+	return 0;
+}
+
+static inline void malloc_trace_leave(int prev)
+{
+}
+#endif
+
+#endif
@@ -330,4 +330,21 @@ int os_spl_to_uboot(const char *fname);
  */
 void os_localtime(struct rtc_time *rt);
 
+/**
+ * os_profile_start() - Start calling a function at regular intervals
+ *
+ * This uses the process's profiling timer, so @func is only called while
+ * U-Boot is using the CPU. It is called from a signal handler with the
+ * program counter at the time of the signal.
+ *
+ * @rate:	Number of calls per second
+ * @func:	Function to call
+ * @return 0 if OK, -ENOSYS if the program counter cannot be found on this
+ *	host, other -ve on error
+ */
+int os_profile_start(unsigned int rate, void (*func)(unsigned long pc));
+
+/* Stop calling the function set up by os_profile_start() */
+void os_profile_stop(void);
+
 #endif
@@ -0,0 +1,101 @@
+/*
+ * Sampling profiler
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+/**
+ * struct profile_stats - Information about the samples taken
+ *
+ * @rate:	Sample rate in Hz
+ * @total:	Total number of samples taken since the profiler was started
+ * @count:	Number of samples in the buffer. Once the buffer is full, each
+ *		new sample replaces the oldest one.
+ * @size:	Size of the sample buffer, in samples
+ * @running:	true if the profiler is running
+ */
+struct profile_stats {
+	uint rate;
+	ulong total;
+	uint count;
+	uint size;
+	bool running;
+};
+
+/**
+ * profile_start() - Start taking samples
+ *
+ * Any previous samples are discarded.
+ *
+ * @rate:	Sample rate in Hz
+ * @size:	Number of samples to keep
+ * @return 0 if OK, -ENOMEM if the buffer could not be allocated, -ENOSYS if
+ *	the architecture cannot take samples, other -ve on error
+ */
+int profile_start(uint rate, uint size);
+
+/**
+ * profile_stop() - Stop taking samples
+ *
+ * The samples are kept until the profiler is started again.
+ */
+void profile_stop(void);
+
+/**
+ * profile_sample() - Record a sample
+ *
+ * This is called by the architecture code, usually from an interrupt or
+ * signal handler, so must not do anything more than store the sample.
+ *
+ * @pc:		Program counter at the time of the sample
+ */
+void profile_sample(ulong pc);
+
+/**
+ * profile_get_stats() - Get information about the samples taken
+ *
+ * @stats:	Returns the information
+ */
+void profile_get_stats(struct profile_stats *stats);
+
+/**
+ * profile_report() - Print the addresses which took the most samples
+ *
+ * Addresses are link addresses, as in System.map. Use proftool on the
+ * output of profile_dump() to see function names.
+ *
+ * @max_lines:	Maximum number of addresses to show
+ */
+void profile_report(int max_lines);
+
+/**
+ * profile_dump() - Write the samples to a buffer for proftool
+ *
+ * This writes a struct trace_output_hdr with type TRACE_CHUNK_SAMPLES,
+ * followed by a uint32_t offset into the code for each sample.
+ *
+ * @buf:	Buffer to write to
+ * @size:	Size of buffer in bytes
+ * @needed:	Returns the number of bytes needed for all the samples
+ * @return 0 if OK, -ENOSPC if the buffer is too small, in which case as
+ *	many samples as fit are written
+ */
+int profile_dump(void *buf, int size, int *needed);
+
+/**
+ * arch_profile_start() - Start calling profile_sample() periodically
+ *
+ * @rate:	Sample rate in Hz
+ * @return 0 if OK, -ENOSYS if not supported
+ */
+int arch_profile_start(uint rate);
+
+/* Stop calling profile_sample() */
+void arch_profile_stop(void);
+
+#endif
@@ -62,6 +62,12 @@ struct hsearch_data {
  */
 	int (*change_ok)(const ENTRY *__item, const char *newval, enum env_op,
 		int flag);
+/*
+ * All entries sorted by key as of the last hexport_r(), so that a later
+ * export only needs to sort the entries which were added since then.
+ */
+	ENTRY **sorted;
+	unsigned int nsorted;
 };
 
 /* Create a new hash table which will contain at most "__nel" elements.  */
@@ -120,5 +126,6 @@ extern int hwalk_r(struct hsearch_data *__htab, int (*callback)(ENTRY *));
 #define H_MATCH_METHOD	(H_MATCH_IDENT | H_MATCH_SUBSTR | H_MATCH_REGEX)
 #define H_PROGRAMMATIC	(1 << 9) /* indicate that an import is from setenv() */
 #define H_ORIGIN_FLAGS	(H_INTERACTIVE | H_PROGRAMMATIC)
+#define H_MERGE		(1 << 10) /* update existing table in place on import */
 
 #endif /* _SEARCH_H_ */
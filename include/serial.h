@@ -160,9 +160,23 @@ struct dm_serial_ops {
  * struct serial_dev_priv - information about a device used by the uclass
  *
  * @sdev: stdio device attached to this uart
+ * @tx_buf: output waiting for the uart (CONFIG_SERIAL_TX_BUFFER), or NULL
+ *	to write synchronously
+ * @tx_head: count of characters put in @tx_buf
+ * @tx_tail: count of characters taken out of @tx_buf
+ * @tx_busy: @tx_buf is being drained
+ * @tx_sync: write synchronously, leaving @tx_buf empty, from
+ *	serial_tx_flush() until serial_tx_resume()
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	char *tx_buf;
+	uint tx_head;
+	uint tx_tail;
+	bool tx_busy;
+	bool tx_sync;
+#endif
 };
 
 /* Access the serial operations for a device */
@@ -29,6 +29,7 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,	/* uint32_t code offset of each sample */
 };
 
 /* A trace record for a function, as written to the profile output file */
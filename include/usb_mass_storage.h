@@ -15,15 +15,20 @@
 /* Wait at maximum 60 seconds for cable connection */
 #define UMS_CABLE_READY_TIMEOUT	60
 
+struct ums_cache;
+
 struct ums {
 	int (*read_sector)(struct ums *ums_dev,
 			   ulong start, lbaint_t blkcnt, void *buf);
 	int (*write_sector)(struct ums *ums_dev,
 			    ulong start, lbaint_t blkcnt, const void *buf);
+	/* Optional: write back cached data, returns 0 on success */
+	int (*flush)(struct ums *ums_dev);
 	unsigned int start_sector;
 	unsigned int num_sectors;
 	const char *name;
 	struct blk_desc block_dev;
+	struct ums_cache *cache;
 };
 
 int fsg_init(struct ums *ums_devs, int count);
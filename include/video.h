@@ -67,6 +67,11 @@ enum video_log2_bpp {
  * @flush_dcache:	true to enable flushing of the data cache after
  *		the LCD is updated
  * @cmap:	Colour map for 8-bit-per-pixel displays
+ * @damage_xstart:	Left of the area written since the last sync, in pixels
+ * @damage_ystart:	Top of that area
+ * @damage_xend:	Right of that area (exclusive), 0 if nothing was
+ *		written
+ * @damage_yend:	Bottom of that area (exclusive)
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -88,6 +93,10 @@ struct video_priv {
 	int colour_bg;
 	bool flush_dcache;
 	ushort *cmap;
+	int damage_xstart;
+	int damage_ystart;
+	int damage_xend;
+	int damage_yend;
 };
 
 /* Placeholder - there are no video operations at present */
@@ -114,12 +123,29 @@ struct video_ops {
  */
 int video_reserve(ulong *addrp);
 
+/**
+ * video_damage() - Note that part of the frame buffer has been written
+ *
+ * Anything writing to the frame buffer must call this before video_sync(),
+ * which only syncs the areas given here. The area is clipped to the
+ * display.
+ *
+ * @vid:	Device written to
+ * @x:		X position of the area in pixels from the left
+ * @y:		Y position of the area in pixels from the top
+ * @width:	Width of the area in pixels
+ * @height:	Height of the area in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+
 /**
  * video_sync() - Sync a device's frame buffer with its hardware
  *
  * Some frame buffers are cached or have a secondary frame buffer. This
  * function syncs these up so that the current contents of the U-Boot frame
- * buffer are displayed to the user.
+ * buffer are displayed to the user. Only the area passed to video_damage()
+ * since the last sync is handled, so this does nothing if the frame buffer
+ * has not been written.
  *
  * @dev:	Device to sync
  */
@@ -185,4 +185,32 @@ int vidconsole_put_char(struct udevice *dev, char ch);
 void vidconsole_position_cursor(struct udevice *dev, unsigned col,
 				unsigned row);
 
+/**
+ * struct console_tt_cache_stats - Statistics of the TrueType character cache
+ *
+ * @hits:	Number of characters found in the cache
+ * @misses:	Number of characters which had to be rendered
+ * @evictions:	Number of characters dropped to make space for another
+ * @glyphs:	Number of characters currently in the cache
+ * @bytes:	Memory used by the images of those characters
+ */
+struct console_tt_cache_stats {
+	ulong hits;
+	ulong misses;
+	ulong evictions;
+	uint glyphs;
+	ulong bytes;
+};
+
+/**
+ * console_truetype_get_cache_stats() - Get the statistics of the cache
+ *
+ * @dev:	TrueType console device
+ * @stats:	Returns the statistics
+ * @return 0 if OK, -ENOSYS if @dev is not a TrueType console or the cache
+ *	is not enabled
+ */
+int console_truetype_get_cache_stats(struct udevice *dev,
+				     struct console_tt_cache_stats *stats);
+
 #endif
@@ -91,6 +91,13 @@
 #define BCH_ECC_WORDS(_p)      DIV_ROUND_UP(GF_M(_p)*GF_T(_p), 32)
 #define BCH_ECC_BYTES(_p)      DIV_ROUND_UP(GF_M(_p)*GF_T(_p), 8)
 
+/* largest syndrome tables worth their memory, see build_syn_tables() */
+#ifdef CONFIG_SPL_BUILD
+#define BCH_SYN_TAB_MAX        0
+#else
+#define BCH_SYN_TAB_MAX        (64*1024)
+#endif
+
 #ifndef dbg
 #define dbg(_fmt, args...)     do {} while (0)
 #endif
@@ -365,6 +372,34 @@ static inline int a_ilog(struct bch_control *bch, unsigned int x)
 	return mod_s(bch, GF_N(bch)-bch->a_log_tab[x]);
 }
 
+/*
+ * compute odd syndromes of ecc polynomial one byte at a time, using the
+ * tables built by build_syn_tables()
+ */
+static void compute_syndromes_tab(struct bch_control *bch, const uint32_t *ecc,
+				  unsigned int *syn)
+{
+	const int t = GF_T(bch);
+	const int words = DIV_ROUND_UP(bch->ecc_bits, 32);
+	const uint16_t *tab = bch->syn_tab;
+	const uint16_t *p;
+	unsigned int v;
+	uint32_t poly;
+	int i, j, k;
+
+	for (i = 0; i < words; i++) {
+		poly = ecc[i];
+		for (k = 0; k < 4; k++, tab += 256*t) {
+			v = (poly >> (8*k)) & 0xff;
+			if (!v)
+				continue;
+			p = tab + v*t;
+			for (j = 0; j < t; j++)
+				syn[2*j] ^= p[j];
+		}
+	}
+}
+
 /*
  * compute 2t syndromes of ecc polynomial, i.e. ecc(a^j) for j=1..2t
  */
@@ -385,17 +420,21 @@ static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 	memset(syn, 0, 2*t*sizeof(*syn));
 
 	/* compute v(a^j) for j=1 .. 2t-1 */
-	do {
-		poly = *ecc++;
-		s -= 32;
-		while (poly) {
-			i = deg(poly);
-			for (j = 0; j < 2*t; j += 2)
-				syn[j] ^= a_pow(bch, (j+1)*(i+s));
-
-			poly ^= (1 << i);
-		}
-	} while (s > 0);
+	if (bch->syn_tab) {
+		compute_syndromes_tab(bch, ecc, syn);
+	} else {
+		do {
+			poly = *ecc++;
+			s -= 32;
+			while (poly) {
+				i = deg(poly);
+				for (j = 0; j < 2*t; j += 2)
+					syn[j] ^= a_pow(bch, (j+1)*(i+s));
+
+				poly ^= (1 << i);
+			}
+		} while (s > 0);
+	}
 
 	/* v(a^(2j)) = v(a^j)^2 */
 	for (j = 0; j < t; j++)
@@ -1045,16 +1084,21 @@ int decode_bch(struct bch_control *bch, const uint8_t *data, unsigned int len,
 		if (recv_ecc) {
 			load_ecc8(bch, bch->ecc_buf2, recv_ecc);
 			/* XOR received and calculated ecc */
-			for (i = 0, sum = 0; i < (int)ecc_words; i++) {
+			for (i = 0; i < (int)ecc_words; i++)
 				bch->ecc_buf[i] ^= bch->ecc_buf2[i];
-				sum |= bch->ecc_buf[i];
-			}
-			if (!sum)
-				/* no error found */
-				return 0;
 		}
+		for (i = 0, sum = 0; i < (int)ecc_words; i++)
+			sum |= bch->ecc_buf[i];
+		if (!sum)
+			/* no error found */
+			return 0;
 		compute_syndromes(bch, bch->ecc_buf, bch->syn);
 		syn = bch->syn;
+	} else {
+		for (i = 0, sum = 0; i < 2*(int)GF_T(bch); i++)
+			sum |= syn[i];
+		if (!sum)
+			return 0;
 	}
 
 	err = compute_error_locator_polynomial(bch, syn);
@@ -1140,6 +1184,45 @@ static void build_mod8_tables(struct bch_control *bch, const uint32_t *g)
 	}
 }
 
+/*
+ * build syndrome tables for compute_syndromes_tab(): for every byte of the
+ * ecc words and every value of that byte, the contributions to the t odd
+ * syndromes. They are skipped when too large, compute_syndromes() then
+ * works one bit at a time.
+ */
+static int build_syn_tables(struct bch_control *bch)
+{
+	const int t = GF_T(bch);
+	const int bytes = DIV_ROUND_UP(bch->ecc_bits, 32)*4;
+	const size_t size = bytes*256*t*sizeof(*bch->syn_tab);
+	uint16_t *tab;
+	int b, i, j, e, v;
+
+	if (size > BCH_SYN_TAB_MAX)
+		return 0;
+
+	bch->syn_tab = kmalloc(size, GFP_KERNEL);
+	if (bch->syn_tab == NULL)
+		return -ENOMEM;
+
+	for (b = 0; b < bytes; b++) {
+		/* exponent of the lowest bit of byte b */
+		e = 8*(b % 4)+bch->ecc_bits-32*(b/4+1);
+		tab = bch->syn_tab + b*256*t;
+		memset(tab, 0, t*sizeof(*tab));
+		for (v = 1; v < 256; v++) {
+			/* add the lowest set bit to the entry without it */
+			for (i = 0; !(v & (1 << i)); i++)
+				;
+			for (j = 0; j < t; j++)
+				tab[v*t+j] = tab[(v & (v-1))*t+j] ^
+					((e+i < 0) ? 0 :
+					 a_pow(bch, (2*j+1)*(e+i)));
+		}
+	}
+	return 0;
+}
+
 /*
  * build a base for factoring degree 2 polynomials
  */
@@ -1357,6 +1440,10 @@ struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
 	build_mod8_tables(bch, genpoly);
 	kfree(genpoly);
 
+	err = build_syn_tables(bch);
+	if (err)
+		goto fail;
+
 	err = build_deg2_base(bch);
 	if (err)
 		goto fail;
@@ -1380,6 +1467,7 @@ void free_bch(struct bch_control *bch)
 		kfree(bch->a_pow_tab);
 		kfree(bch->a_log_tab);
 		kfree(bch->mod8_tab);
+		kfree(bch->syn_tab);
 		kfree(bch->ecc_buf);
 		kfree(bch->ecc_buf2);
 		kfree(bch->xi_tab);
@@ -266,9 +266,16 @@ static efi_status_t EFIAPI efi_wait_for_event(unsigned long num_events,
 	return EFI_EXIT(EFI_SUCCESS);
 }
 
+void efi_notify_event(void *event)
+{
+	if (event == &efi_event && efi_event.notify_function)
+		efi_event.notify_function(&efi_event, efi_event.notify_context);
+}
+
 static efi_status_t EFIAPI efi_signal_event(void *event)
 {
 	EFI_ENTRY("%p", event);
+	efi_notify_event(event);
 	return EFI_EXIT(EFI_SUCCESS);
 }
 
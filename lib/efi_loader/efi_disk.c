@@ -13,14 +13,41 @@
 #include <inttypes.h>
 #include <part.h>
 #include <malloc.h>
+#include <memalign.h>
 
 static const efi_guid_t efi_block_io_guid = BLOCK_IO_GUID;
+static const efi_guid_t efi_block_io2_guid = BLOCK_IO2_GUID;
+
+/*
+ * Read-ahead window, shared by all EFI disk objects on a block device.
+ * Reads smaller than the window are rounded up to a full window, so
+ * payloads reading a file in small chunks hit the device once per window.
+ */
+struct efi_disk_window {
+	/* Block device this window caches */
+	const struct blk_desc *desc;
+	/* Size of the window in blocks */
+	lbaint_t size;
+	/* First block and number of valid blocks in the buffer */
+	lbaint_t start;
+	lbaint_t blocks;
+};
+
+/*
+ * All windows share one DMA-aligned buffer, allocated on first use and kept
+ * for later bootefi runs. Only the window which filled it last has data.
+ */
+static void *efi_disk_window_buf;
+static size_t efi_disk_window_buf_size;
+static struct efi_disk_window *efi_disk_window_owner;
 
 struct efi_disk_obj {
 	/* Generic EFI object parent class data */
 	struct efi_object parent;
 	/* EFI Interface callback struct for block I/O */
 	struct efi_block_io ops;
+	/* EFI Interface callback struct for block I/O 2 */
+	struct efi_block_io2 ops2;
 	/* U-Boot ifname for block device */
 	const char *ifname;
 	/* U-Boot dev_index for block device */
@@ -33,6 +60,8 @@ struct efi_disk_obj {
 	lbaint_t offset;
 	/* Internal block device */
 	const struct blk_desc *desc;
+	/* Read-ahead window, NULL if disabled */
+	struct efi_disk_window *window;
 };
 
 static efi_status_t EFIAPI efi_disk_open_block(void *handle,
@@ -47,6 +76,18 @@ static efi_status_t EFIAPI efi_disk_open_block(void *handle,
 	return EFI_SUCCESS;
 }
 
+static efi_status_t EFIAPI efi_disk_open_block2(void *handle,
+			efi_guid_t *protocol, void **protocol_interface,
+			void *agent_handle, void *controller_handle,
+			uint32_t attributes)
+{
+	struct efi_disk_obj *diskobj = handle;
+
+	*protocol_interface = &diskobj->ops2;
+
+	return EFI_SUCCESS;
+}
+
 static efi_status_t EFIAPI efi_disk_open_dp(void *handle, efi_guid_t *protocol,
 			void **protocol_interface, void *agent_handle,
 			void *controller_handle, uint32_t attributes)
@@ -70,17 +111,86 @@ enum efi_disk_direction {
 	EFI_DISK_WRITE,
 };
 
-static efi_status_t EFIAPI efi_disk_rw_blocks(struct efi_block_io *this,
-			u32 media_id, u64 lba, unsigned long buffer_size,
-			void *buffer, enum efi_disk_direction direction)
+/* Take over the shared window buffer, returning NULL if out of memory */
+static void *efi_disk_window_claim(struct efi_disk_window *win, int blksz)
 {
-	struct efi_disk_obj *diskobj;
+	size_t size = win->size * blksz;
+
+	if (efi_disk_window_owner && efi_disk_window_owner != win)
+		efi_disk_window_owner->blocks = 0;
+	efi_disk_window_owner = win;
+	if (size > efi_disk_window_buf_size) {
+		free(efi_disk_window_buf);
+		efi_disk_window_buf = memalign(ARCH_DMA_MINALIGN, size);
+		efi_disk_window_buf_size = efi_disk_window_buf ? size : 0;
+	}
+
+	return efi_disk_window_buf;
+}
+
+/*
+ * Read blocks through the read-ahead window of the disk. Returns the
+ * number of blocks read.
+ */
+static lbaint_t efi_disk_read_window(struct efi_disk_obj *diskobj,
+				     lbaint_t lba, lbaint_t blocks,
+				     void *buffer)
+{
+	struct efi_disk_window *win = diskobj->window;
+	struct blk_desc *desc = (struct blk_desc *)diskobj->desc;
+	int blksz = desc->blksz;
+	lbaint_t done = 0;
+	lbaint_t cur, left, n;
+	void *buf;
+
+	while (done < blocks) {
+		cur = lba + done;
+		left = blocks - done;
+
+		/* Serve what we can from the window */
+		if (win->blocks && cur >= win->start &&
+		    cur < win->start + win->blocks) {
+			n = min(left, win->start + win->blocks - cur);
+			memcpy(buffer + done * blksz,
+			       efi_disk_window_buf + (cur - win->start) * blksz,
+			       n * blksz);
+			done += n;
+			continue;
+		}
+
+		/*
+		 * Large reads go straight to the caller, which is zero-copy
+		 * if its buffer is aligned for DMA. So does anything we
+		 * cannot get through the window.
+		 */
+		n = cur < desc->lba ? min(win->size, desc->lba - cur) : 0;
+		buf = n && left < win->size ?
+			efi_disk_window_claim(win, blksz) : NULL;
+		if (!buf)
+			return done + blk_dread(desc, cur, left,
+						buffer + done * blksz);
+
+		win->blocks = 0;
+		if (blk_dread(desc, cur, n, buf) != n)
+			return done + blk_dread(desc, cur, left,
+						buffer + done * blksz);
+		win->start = cur;
+		win->blocks = n;
+	}
+
+	return done;
+}
+
+static efi_status_t efi_disk_rw_blocks(struct efi_disk_obj *diskobj,
+			u64 lba, unsigned long buffer_size, void *buffer,
+			enum efi_disk_direction direction)
+{
+	struct efi_disk_window *win = diskobj->window;
 	struct blk_desc *desc;
 	int blksz;
 	int blocks;
 	unsigned long n;
 
-	diskobj = container_of(this, struct efi_disk_obj, ops);
 	desc = (struct blk_desc *) diskobj->desc;
 	blksz = desc->blksz;
 	blocks = buffer_size / blksz;
@@ -91,12 +201,20 @@ static efi_status_t EFIAPI efi_disk_rw_blocks(struct efi_block_io *this,
 
 	/* We only support full block access */
 	if (buffer_size & (blksz - 1))
-		return EFI_EXIT(EFI_DEVICE_ERROR);
-
-	if (direction == EFI_DISK_READ)
-		n = blk_dread(desc, lba, blocks, buffer);
-	else
+		return EFI_DEVICE_ERROR;
+
+	if (direction == EFI_DISK_READ) {
+		if (win)
+			n = efi_disk_read_window(diskobj, lba, blocks, buffer);
+		else
+			n = blk_dread(desc, lba, blocks, buffer);
+	} else {
+		/* Drop read-ahead data which this write makes stale */
+		if (win && win->blocks && lba < win->start + win->blocks &&
+		    lba + blocks > win->start)
+			win->blocks = 0;
 		n = blk_dwrite(desc, lba, blocks, buffer);
+	}
 
 	/* We don't do interrupts, so check for timers cooperatively */
 	efi_timer_check();
@@ -104,26 +222,25 @@ static efi_status_t EFIAPI efi_disk_rw_blocks(struct efi_block_io *this,
 	debug("EFI: %s:%d n=%lx blocks=%x\n", __func__, __LINE__, n, blocks);
 
 	if (n != blocks)
-		return EFI_EXIT(EFI_DEVICE_ERROR);
+		return EFI_DEVICE_ERROR;
 
-	return EFI_EXIT(EFI_SUCCESS);
+	return EFI_SUCCESS;
 }
 
-static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
-			u32 media_id, u64 lba, unsigned long buffer_size,
-			void *buffer)
+static efi_status_t efi_disk_read(struct efi_disk_obj *diskobj, u64 lba,
+				  unsigned long buffer_size, void *buffer)
 {
 	void *real_buffer = buffer;
 	efi_status_t r;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_read_blocks(this, media_id, lba,
+		r = efi_disk_read(diskobj, lba,
 			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
 		if (r != EFI_SUCCESS)
 			return r;
-		return efi_disk_read_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
+		return efi_disk_read(diskobj, lba +
+			EFI_LOADER_BOUNCE_BUFFER_SIZE / diskobj->media.block_size,
 			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
 			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
 	}
@@ -131,34 +248,30 @@ static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
 	real_buffer = efi_bounce_buffer;
 #endif
 
-	EFI_ENTRY("%p, %x, %"PRIx64", %lx, %p", this, media_id, lba,
-		  buffer_size, buffer);
-
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
+	r = efi_disk_rw_blocks(diskobj, lba, buffer_size, real_buffer,
 			       EFI_DISK_READ);
 
 	/* Copy from bounce buffer to real buffer if necessary */
 	if ((r == EFI_SUCCESS) && (real_buffer != buffer))
 		memcpy(buffer, real_buffer, buffer_size);
 
-	return EFI_EXIT(r);
+	return r;
 }
 
-static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
-			u32 media_id, u64 lba, unsigned long buffer_size,
-			void *buffer)
+static efi_status_t efi_disk_write(struct efi_disk_obj *diskobj, u64 lba,
+				   unsigned long buffer_size, void *buffer)
 {
 	void *real_buffer = buffer;
 	efi_status_t r;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_write_blocks(this, media_id, lba,
+		r = efi_disk_write(diskobj, lba,
 			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
 		if (r != EFI_SUCCESS)
 			return r;
-		return efi_disk_write_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
+		return efi_disk_write(diskobj, lba +
+			EFI_LOADER_BOUNCE_BUFFER_SIZE / diskobj->media.block_size,
 			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
 			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
 	}
@@ -166,16 +279,45 @@ static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 	real_buffer = efi_bounce_buffer;
 #endif
 
-	EFI_ENTRY("%p, %x, %"PRIx64", %lx, %p", this, media_id, lba,
-		  buffer_size, buffer);
-
 	/* Populate bounce buffer if necessary */
 	if (real_buffer != buffer)
 		memcpy(real_buffer, buffer, buffer_size);
 
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
+	r = efi_disk_rw_blocks(diskobj, lba, buffer_size, real_buffer,
 			       EFI_DISK_WRITE);
 
+	return r;
+}
+
+static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
+			u32 media_id, u64 lba, unsigned long buffer_size,
+			void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t r;
+
+	EFI_ENTRY("%p, %x, %"PRIx64", %lx, %p", this, media_id, lba,
+		  buffer_size, buffer);
+
+	diskobj = container_of(this, struct efi_disk_obj, ops);
+	r = efi_disk_read(diskobj, lba, buffer_size, buffer);
+
+	return EFI_EXIT(r);
+}
+
+static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
+			u32 media_id, u64 lba, unsigned long buffer_size,
+			void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t r;
+
+	EFI_ENTRY("%p, %x, %"PRIx64", %lx, %p", this, media_id, lba,
+		  buffer_size, buffer);
+
+	diskobj = container_of(this, struct efi_disk_obj, ops);
+	r = efi_disk_write(diskobj, lba, buffer_size, buffer);
+
 	return EFI_EXIT(r);
 }
 
@@ -193,6 +335,114 @@ static const struct efi_block_io block_io_disk_template = {
 	.flush_blocks = &efi_disk_flush_blocks,
 };
 
+/*
+ * We don't do interrupts, so Block I/O 2 requests have always completed
+ * by the time they return. For non-blocking requests we still report the
+ * result in the token and signal its event, as the payload waits for it.
+ */
+static efi_status_t efi_disk_complete(struct efi_block_io2_token *token,
+				      efi_status_t r)
+{
+	if (!token || !token->event)
+		return r;
+
+	token->transaction_status = r;
+	efi_notify_event(token->event);
+
+	return EFI_SUCCESS;
+}
+
+static efi_status_t EFIAPI efi_disk_reset_ex(struct efi_block_io2 *this,
+			char extended_verification)
+{
+	EFI_ENTRY("%p, %x", this, extended_verification);
+	return EFI_EXIT(EFI_DEVICE_ERROR);
+}
+
+static efi_status_t EFIAPI efi_disk_read_blocks_ex(struct efi_block_io2 *this,
+			u32 media_id, u64 lba,
+			struct efi_block_io2_token *token,
+			unsigned long buffer_size, void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t r;
+
+	EFI_ENTRY("%p, %x, %"PRIx64", %p, %lx, %p", this, media_id, lba,
+		  token, buffer_size, buffer);
+
+	diskobj = container_of(this, struct efi_disk_obj, ops2);
+	r = efi_disk_read(diskobj, lba, buffer_size, buffer);
+
+	return EFI_EXIT(efi_disk_complete(token, r));
+}
+
+static efi_status_t EFIAPI efi_disk_write_blocks_ex(struct efi_block_io2 *this,
+			u32 media_id, u64 lba,
+			struct efi_block_io2_token *token,
+			unsigned long buffer_size, void *buffer)
+{
+	struct efi_disk_obj *diskobj;
+	efi_status_t r;
+
+	EFI_ENTRY("%p, %x, %"PRIx64", %p, %lx, %p", this, media_id, lba,
+		  token, buffer_size, buffer);
+
+	diskobj = container_of(this, struct efi_disk_obj, ops2);
+	r = efi_disk_write(diskobj, lba, buffer_size, buffer);
+
+	return EFI_EXIT(efi_disk_complete(token, r));
+}
+
+static efi_status_t EFIAPI efi_disk_flush_blocks_ex(struct efi_block_io2 *this,
+			struct efi_block_io2_token *token)
+{
+	/* We always write synchronously */
+	EFI_ENTRY("%p, %p", this, token);
+	return EFI_EXIT(efi_disk_complete(token, EFI_SUCCESS));
+}
+
+static const struct efi_block_io2 block_io2_disk_template = {
+	.reset = &efi_disk_reset_ex,
+	.read_blocks_ex = &efi_disk_read_blocks_ex,
+	.write_blocks_ex = &efi_disk_write_blocks_ex,
+	.flush_blocks_ex = &efi_disk_flush_blocks_ex,
+};
+
+/*
+ * Find the read-ahead window for a block device. El Torito partitions show
+ * up as separate EFI disks on the same device, so they share one window
+ * and a write through either one drops stale data.
+ */
+static struct efi_disk_window *efi_disk_get_window(const struct blk_desc *desc)
+{
+	struct efi_disk_window *win;
+	struct list_head *lhandle;
+
+	if (!CONFIG_EFI_LOADER_DISK_READ_AHEAD)
+		return NULL;
+
+	list_for_each(lhandle, &efi_obj_list) {
+		struct efi_object *efiobj;
+		struct efi_disk_obj *diskobj;
+
+		efiobj = list_entry(lhandle, struct efi_object, link);
+		if (efiobj->protocols[0].open != efi_disk_open_block)
+			continue;
+		diskobj = container_of(efiobj, struct efi_disk_obj, parent);
+		if (diskobj->desc == desc)
+			return diskobj->window;
+	}
+
+	win = calloc(1, sizeof(*win));
+	if (!win)
+		return NULL;
+	win->desc = desc;
+	win->size = max_t(lbaint_t, 1,
+			  CONFIG_EFI_LOADER_DISK_READ_AHEAD * 1024 / desc->blksz);
+
+	return win;
+}
+
 static void efi_disk_add_dev(const char *name,
 			     const char *if_typename,
 			     const struct blk_desc *desc,
@@ -214,12 +464,16 @@ static void efi_disk_add_dev(const char *name,
 	diskobj->parent.protocols[0].open = efi_disk_open_block;
 	diskobj->parent.protocols[1].guid = &efi_guid_device_path;
 	diskobj->parent.protocols[1].open = efi_disk_open_dp;
+	diskobj->parent.protocols[2].guid = &efi_block_io2_guid;
+	diskobj->parent.protocols[2].open = efi_disk_open_block2;
 	diskobj->parent.handle = diskobj;
 	diskobj->ops = block_io_disk_template;
+	diskobj->ops2 = block_io2_disk_template;
 	diskobj->ifname = if_typename;
 	diskobj->dev_index = dev_index;
 	diskobj->offset = offset;
 	diskobj->desc = desc;
+	diskobj->window = efi_disk_get_window(desc);
 
 	/* Fill in EFI IO Media info (for read/write callbacks) */
 	diskobj->media.removable_media = desc->removable;
@@ -228,6 +482,7 @@ static void efi_disk_add_dev(const char *name,
 	diskobj->media.io_align = desc->blksz;
 	diskobj->media.last_block = desc->lba - offset;
 	diskobj->ops.media = &diskobj->media;
+	diskobj->ops2.media = &diskobj->media;
 
 	/* Fill in device path */
 	dp = (void*)&diskobj[1];
@@ -64,6 +64,9 @@ static efi_status_t EFIAPI gop_blt(struct efi_gop *this, void *buffer,
 	struct efi_gop_obj *gopobj = container_of(this, struct efi_gop_obj, ops);
 	int i, j, line_len16, line_len32;
 	void *fb;
+#ifdef CONFIG_DM_VIDEO
+	struct udevice *vdev;
+#endif
 
 	EFI_ENTRY("%p, %p, %lx, %lx, %lx, %lx, %lx, %lx, %lx, %lx", this,
 		  buffer, operation, sx, sy, dx, dy, width, height, delta);
@@ -116,6 +119,8 @@ static efi_status_t EFIAPI gop_blt(struct efi_gop *this, void *buffer,
 	}
 
 #ifdef CONFIG_DM_VIDEO
+	if (!uclass_first_device(UCLASS_VIDEO, &vdev) && vdev)
+		video_damage(vdev, dx, dy, width, height);
 	video_sync_all();
 #else
 	lcd_sync();
@@ -11,35 +11,40 @@
 #include <malloc.h>
 #include <asm/global_data.h>
 #include <libfdt_env.h>
-#include <linux/list_sort.h>
+#include <linux/list.h>
+#include <linux/rbtree_augmented.h>
 #include <inttypes.h>
 #include <watchdog.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/*
+ * The memory map is kept in a red-black tree sorted by address. Entries
+ * never overlap, so lookups by address are O(log n). Each node also
+ * tracks the size of the largest block of free RAM in its subtree, which
+ * lets efi_find_free_memory() skip subtrees that cannot fit a request.
+ */
 struct efi_mem_list {
-	struct list_head link;
+	struct rb_node node;
 	struct efi_mem_desc desc;
+	u64 subtree_free;
 };
 
-#define EFI_CARVE_NO_OVERLAP		-1
-#define EFI_CARVE_LOOP_AGAIN		-2
-#define EFI_CARVE_OVERLAPS_NONRAM	-3
-
-/* This list contains all memory map items */
-LIST_HEAD(efi_mem);
+/* This tree contains all memory map items */
+static struct rb_root efi_mem = RB_ROOT;
+static int efi_mem_count;
 
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 void *efi_bounce_buffer;
 #endif
 
 /*
- * U-Boot services each EFI AllocatePool request as a separate
- * (multiple) page allocation.  We have to track the number of pages
- * to be able to free the correct amount later.
- * EFI requires 8 byte alignment for pool allocations, so we can
- * prepend each allocation with an 64 bit header tracking the
- * allocation size, and hand out the remainder to the caller.
+ * Each EFI AllocatePool request is prepended with a 64 bit header, since
+ * EFI requires 8 byte alignment for pool allocations. Large requests are
+ * serviced as a separate (multiple) page allocation and the header tracks
+ * the number of pages, so that we can free the correct amount later.
+ * Small requests are carved out of pool pages (see below) and have
+ * num_pages set to 0.
  */
 struct efi_pool_allocation {
 	u64 num_pages;
@@ -47,112 +52,204 @@ struct efi_pool_allocation {
 };
 
 /*
- * Sorts the memory list from highest address to lowest address
- *
- * When allocating memory we should always start from the highest
- * address chunk, so sort the memory list such that the first list
- * iterator gets the highest address and goes lower from there.
+ * Pool pages hold small allocations of a single size class and memory
+ * type. GRUB and the Linux EFI stub make a great many small pool
+ * allocations, which would otherwise each use a page and a memory map
+ * entry of their own.
  */
-static int efi_mem_cmp(void *priv, struct list_head *a, struct list_head *b)
+#define EFI_POOL_MIN_SHIFT	5
+#define EFI_POOL_CLASSES	6	/* 32 to 1024 byte slots */
+
+struct efi_pool_page {
+	struct list_head link;
+	int memory_type;
+	unsigned int class;
+	unsigned int used;
+	void *free;
+};
+
+/* Pool pages with free slots, per size class */
+static struct list_head efi_pool_pages[EFI_POOL_CLASSES];
+
+static u64 efi_mem_end(struct efi_mem_list *lmem)
 {
-	struct efi_mem_list *mema = list_entry(a, struct efi_mem_list, link);
-	struct efi_mem_list *memb = list_entry(b, struct efi_mem_list, link);
+	return lmem->desc.physical_start +
+	       (lmem->desc.num_pages << EFI_PAGE_SHIFT);
+}
 
-	if (mema->desc.physical_start == memb->desc.physical_start)
-		return 0;
-	else if (mema->desc.physical_start < memb->desc.physical_start)
-		return 1;
-	else
-		return -1;
+static u64 efi_mem_compute_free(struct efi_mem_list *lmem)
+{
+	u64 max = 0;
+	struct efi_mem_list *child;
+
+	if (lmem->desc.type == EFI_CONVENTIONAL_MEMORY)
+		max = lmem->desc.num_pages;
+	if (lmem->node.rb_left) {
+		child = rb_entry(lmem->node.rb_left, struct efi_mem_list, node);
+		max = max(max, child->subtree_free);
+	}
+	if (lmem->node.rb_right) {
+		child = rb_entry(lmem->node.rb_right, struct efi_mem_list, node);
+		max = max(max, child->subtree_free);
+	}
+
+	return max;
 }
 
-static void efi_mem_sort(void)
+RB_DECLARE_CALLBACKS(static, efi_mem_augment, struct efi_mem_list, node,
+		     u64, subtree_free, efi_mem_compute_free)
+
+static void efi_mem_insert(struct efi_mem_list *newmap)
 {
-	list_sort(NULL, &efi_mem, efi_mem_cmp);
+	struct rb_node **link = &efi_mem.rb_node;
+	struct rb_node *parent = NULL;
+
+	while (*link) {
+		struct efi_mem_list *lmem;
+
+		parent = *link;
+		lmem = rb_entry(parent, struct efi_mem_list, node);
+		if (newmap->desc.physical_start < lmem->desc.physical_start)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+
+	rb_link_node(&newmap->node, parent, link);
+	newmap->subtree_free = efi_mem_compute_free(newmap);
+	efi_mem_augment.propagate(parent, NULL);
+	rb_insert_augmented(&newmap->node, &efi_mem, &efi_mem_augment);
+	efi_mem_count++;
+}
+
+static void efi_mem_remove(struct efi_mem_list *lmem)
+{
+	rb_erase_augmented(&lmem->node, &efi_mem, &efi_mem_augment);
+	free(lmem);
+	efi_mem_count--;
+}
+
+/* Must be called after changing the size or type of a map in the tree */
+static void efi_mem_update(struct efi_mem_list *lmem)
+{
+	efi_mem_augment.propagate(&lmem->node, NULL);
+}
+
+static struct efi_mem_list *efi_mem_prev(struct efi_mem_list *lmem)
+{
+	struct rb_node *rb = rb_prev(&lmem->node);
+
+	return rb ? rb_entry(rb, struct efi_mem_list, node) : NULL;
+}
+
+static struct efi_mem_list *efi_mem_next(struct efi_mem_list *lmem)
+{
+	struct rb_node *rb = rb_next(&lmem->node);
+
+	return rb ? rb_entry(rb, struct efi_mem_list, node) : NULL;
+}
+
+/* Find the map with the highest start address below addr */
+static struct efi_mem_list *efi_mem_find_below(uint64_t addr)
+{
+	struct rb_node *rb = efi_mem.rb_node;
+	struct efi_mem_list *found = NULL;
+
+	while (rb) {
+		struct efi_mem_list *lmem;
+
+		lmem = rb_entry(rb, struct efi_mem_list, node);
+		if (lmem->desc.physical_start < addr) {
+			found = lmem;
+			rb = rb->rb_right;
+		} else {
+			rb = rb->rb_left;
+		}
+	}
+
+	return found;
 }
 
 /*
- * Unmaps all memory occupied by the carve_desc region from the
- * list entry pointed to by map.
- *
- * Returns EFI_CARVE_NO_OVERLAP if the regions don't overlap.
- * Returns EFI_CARVE_OVERLAPS_NONRAM if the carve and map overlap,
- *    and the map contains anything but free ram.
- *    (only when overlap_only_ram is true)
- * Returns EFI_CARVE_LOOP_AGAIN if the mapping list should be traversed
- *    again, as it has been altered
- * Returns the number of overlapping pages. The pages are removed from
- *     the mapping list.
- *
- * In case of EFI_CARVE_OVERLAPS_NONRAM it is the callers responsibility
- * to readd the already carved out pages to the mapping.
+ * Unmaps all memory occupied by [carve_start, carve_end) from map, which
+ * must overlap it. If the carved area lies strictly inside the map, the
+ * map is split and the upper part is stored in *spare, which is then set
+ * to NULL.
  */
-static int efi_mem_carve_out(struct efi_mem_list *map,
-			     struct efi_mem_desc *carve_desc,
-			     bool overlap_only_ram)
+static void efi_mem_carve_out(struct efi_mem_list *map, uint64_t carve_start,
+			      uint64_t carve_end, struct efi_mem_list **spare)
 {
+	uint64_t map_start = map->desc.physical_start;
+	uint64_t map_end = efi_mem_end(map);
 	struct efi_mem_list *newmap;
-	struct efi_mem_desc *map_desc = &map->desc;
-	uint64_t map_start = map_desc->physical_start;
-	uint64_t map_end = map_start + (map_desc->num_pages << EFI_PAGE_SHIFT);
-	uint64_t carve_start = carve_desc->physical_start;
-	uint64_t carve_end = carve_start +
-			     (carve_desc->num_pages << EFI_PAGE_SHIFT);
-
-	/* check whether we're overlapping */
-	if ((carve_end <= map_start) || (carve_start >= map_end))
-		return EFI_CARVE_NO_OVERLAP;
-
-	/* We're overlapping with non-RAM, warn the caller if desired */
-	if (overlap_only_ram && (map_desc->type != EFI_CONVENTIONAL_MEMORY))
-		return EFI_CARVE_OVERLAPS_NONRAM;
-
-	/* Sanitize carve_start and carve_end to lie within our bounds */
-	carve_start = max(carve_start, map_start);
-	carve_end = min(carve_end, map_end);
-
-	/* Carving at the beginning of our map? Just move it! */
-	if (carve_start == map_start) {
-		if (map_end == carve_end) {
+
+	if (carve_start <= map_start) {
+		if (carve_end >= map_end) {
 			/* Full overlap, just remove map */
-			list_del(&map->link);
-			free(map);
+			efi_mem_remove(map);
 		} else {
+			/* Carving at the beginning of our map, move it */
 			map->desc.physical_start = carve_end;
+			map->desc.virtual_start = carve_end;
 			map->desc.num_pages = (map_end - carve_end)
 					      >> EFI_PAGE_SHIFT;
+			efi_mem_update(map);
 		}
-
-		return (carve_end - carve_start) >> EFI_PAGE_SHIFT;
+		return;
 	}
 
-	/*
-	 * Overlapping maps, just split the list map at carve_start,
-	 * it will get moved or removed in the next iteration.
-	 *
-	 * [ map_desc |__carve_start__| newmap ]
-	 */
-
-	/* Create a new map from [ carve_start ... map_end ] */
-	newmap = calloc(1, sizeof(*newmap));
+	/* Shrink the map to [ map_start ... carve_start ] */
+	map->desc.num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
+	efi_mem_update(map);
+	if (carve_end >= map_end)
+		return;
+
+	/* Create a new map from [ carve_end ... map_end ] */
+	newmap = *spare;
+	*spare = NULL;
 	newmap->desc = map->desc;
-	newmap->desc.physical_start = carve_start;
-	newmap->desc.num_pages = (map_end - carve_start) >> EFI_PAGE_SHIFT;
-	/* Insert before current entry (descending address order) */
-	list_add_tail(&newmap->link, &map->link);
+	newmap->desc.physical_start = carve_end;
+	newmap->desc.virtual_start = carve_end;
+	newmap->desc.num_pages = (map_end - carve_end) >> EFI_PAGE_SHIFT;
+	efi_mem_insert(newmap);
+}
 
-	/* Shrink the map to [ map_start ... carve_start ] */
-	map_desc->num_pages = (carve_start - map_start) >> EFI_PAGE_SHIFT;
+/* Merge a map with its neighbours if they are adjacent and alike */
+static void efi_mem_merge(struct efi_mem_list *lmem)
+{
+	struct efi_mem_list *prev = efi_mem_prev(lmem);
+	struct efi_mem_list *next = efi_mem_next(lmem);
+
+	u64 pages;
 
-	return EFI_CARVE_LOOP_AGAIN;
+	/*
+	 * Remove the absorbed map before growing the other one, so that the
+	 * erase recomputes subtree_free from values which are still correct
+	 */
+	if (next && efi_mem_end(lmem) == next->desc.physical_start &&
+	    next->desc.type == lmem->desc.type &&
+	    next->desc.attribute == lmem->desc.attribute) {
+		pages = next->desc.num_pages;
+		efi_mem_remove(next);
+		lmem->desc.num_pages += pages;
+		efi_mem_update(lmem);
+	}
+
+	if (prev && efi_mem_end(prev) == lmem->desc.physical_start &&
+	    prev->desc.type == lmem->desc.type &&
+	    prev->desc.attribute == lmem->desc.attribute) {
+		pages = lmem->desc.num_pages;
+		efi_mem_remove(lmem);
+		prev->desc.num_pages += pages;
+		efi_mem_update(prev);
+	}
 }
 
 uint64_t efi_add_memory_map(uint64_t start, uint64_t pages, int memory_type,
 			    bool overlap_only_ram)
 {
-	struct list_head *lhandle;
-	struct efi_mem_list *newlist;
-	bool carve_again;
+	struct efi_mem_list *newlist, *spare, *lmem, *prev;
+	uint64_t end = start + (pages << EFI_PAGE_SHIFT);
 	uint64_t carved_pages = 0;
 
 	debug("%s: 0x%" PRIx64 " 0x%" PRIx64 " %d %s\n", __func__,
@@ -161,7 +258,37 @@ uint64_t efi_add_memory_map(uint64_t start, uint64_t pages, int memory_type,
 	if (!pages)
 		return start;
 
+	if (overlap_only_ram) {
+		for (lmem = efi_mem_find_below(end);
+		     lmem && efi_mem_end(lmem) > start;
+		     lmem = efi_mem_prev(lmem)) {
+			/*
+			 * The user requested to only have RAM overlaps,
+			 * but we hit a non-RAM region. Error out.
+			 */
+			if (lmem->desc.type != EFI_CONVENTIONAL_MEMORY)
+				return 0;
+			carved_pages += (min(end, efi_mem_end(lmem)) -
+					 max(start, lmem->desc.physical_start))
+					>> EFI_PAGE_SHIFT;
+		}
+
+		/*
+		 * The payload wanted to have RAM overlaps, but we overlapped
+		 * with an unallocated region. Error out.
+		 */
+		if (carved_pages != pages)
+			return 0;
+	}
+
 	newlist = calloc(1, sizeof(*newlist));
+	spare = calloc(1, sizeof(*spare));
+	if (!newlist || !spare) {
+		free(newlist);
+		free(spare);
+		return 0;
+	}
+
 	newlist->desc.type = memory_type;
 	newlist->desc.physical_start = start;
 	newlist->desc.virtual_start = start;
@@ -181,98 +308,58 @@ uint64_t efi_add_memory_map(uint64_t start, uint64_t pages, int memory_type,
 		break;
 	}
 
-	/* Add our new map */
-	do {
-		carve_again = false;
-		list_for_each(lhandle, &efi_mem) {
-			struct efi_mem_list *lmem;
-			int r;
-
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
-			r = efi_mem_carve_out(lmem, &newlist->desc,
-					      overlap_only_ram);
-			switch (r) {
-			case EFI_CARVE_OVERLAPS_NONRAM:
-				/*
-				 * The user requested to only have RAM overlaps,
-				 * but we hit a non-RAM region. Error out.
-				 */
-				return 0;
-			case EFI_CARVE_NO_OVERLAP:
-				/* Just ignore this list entry */
-				break;
-			case EFI_CARVE_LOOP_AGAIN:
-				/*
-				 * We split an entry, but need to loop through
-				 * the list again to actually carve it.
-				 */
-				carve_again = true;
-				break;
-			default:
-				/* We carved a number of pages */
-				carved_pages += r;
-				carve_again = true;
-				break;
-			}
-
-			if (carve_again) {
-				/* The list changed, we need to start over */
-				break;
-			}
-		}
-	} while (carve_again);
-
-	if (overlap_only_ram && (carved_pages != pages)) {
-		/*
-		 * The payload wanted to have RAM overlaps, but we overlapped
-		 * with an unallocated region. Error out.
-		 */
-		return 0;
+	/* Carve our new map out of all maps it overlaps */
+	lmem = efi_mem_find_below(end);
+	while (lmem && efi_mem_end(lmem) > start) {
+		prev = efi_mem_prev(lmem);
+		efi_mem_carve_out(lmem, start, end, &spare);
+		lmem = prev;
 	}
+	free(spare);
 
 	/* Add our new map */
-        list_add_tail(&newlist->link, &efi_mem);
-
-	/* And make sure memory is listed in descending order */
-	efi_mem_sort();
+	efi_mem_insert(newlist);
+	efi_mem_merge(newlist);
 
 	return start;
 }
 
-static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
+static uint64_t efi_find_free_in(struct rb_node *rb, uint64_t len,
+				 uint64_t max_addr)
 {
-	struct list_head *lhandle;
-
-	list_for_each(lhandle, &efi_mem) {
-		struct efi_mem_list *lmem = list_entry(lhandle,
-			struct efi_mem_list, link);
-		struct efi_mem_desc *desc = &lmem->desc;
-		uint64_t desc_len = desc->num_pages << EFI_PAGE_SHIFT;
-		uint64_t desc_end = desc->physical_start + desc_len;
-		uint64_t curmax = min(max_addr, desc_end);
-		uint64_t ret = curmax - len;
+	struct efi_mem_list *lmem;
+	uint64_t ret;
 
-		/* We only take memory from free RAM */
-		if (desc->type != EFI_CONVENTIONAL_MEMORY)
-			continue;
+	if (!rb)
+		return 0;
+	lmem = rb_entry(rb, struct efi_mem_list, node);
 
-		/* Out of bounds for max_addr */
-		if ((ret + len) > max_addr)
-			continue;
+	/* Nothing in this subtree is large enough */
+	if ((lmem->subtree_free << EFI_PAGE_SHIFT) < len)
+		return 0;
 
-		/* Out of bounds for upper map limit */
-		if ((ret + len) > desc_end)
-			continue;
+	if (lmem->desc.physical_start < max_addr) {
+		/* Prefer the highest address */
+		ret = efi_find_free_in(rb->rb_right, len, max_addr);
+		if (ret)
+			return ret;
 
-		/* Out of bounds for lower map limit */
-		if (ret < desc->physical_start)
-			continue;
+		/* We only take memory from free RAM */
+		if (lmem->desc.type == EFI_CONVENTIONAL_MEMORY) {
+			uint64_t curmax = min(max_addr, efi_mem_end(lmem));
 
-		/* Return the highest address in this map within bounds */
-		return ret;
+			if (curmax - lmem->desc.physical_start >= len)
+				return curmax - len;
+		}
 	}
 
-	return 0;
+	return efi_find_free_in(rb->rb_left, len, max_addr);
+}
+
+static uint64_t efi_find_free_memory(uint64_t len, uint64_t max_addr)
+{
+	/* Return the highest address within bounds */
+	return efi_find_free_in(efi_mem.rb_node, len, max_addr);
 }
 
 efi_status_t efi_allocate_pages(int type, int memory_type,
@@ -343,7 +430,6 @@ efi_status_t efi_free_pages(uint64_t memory, unsigned long pages)
 	uint64_t r = 0;
 
 	r = efi_add_memory_map(memory, pages, EFI_CONVENTIONAL_MEMORY, false);
-	/* Merging of adjacent free regions is missing */
 
 	if (r == memory)
 		return EFI_SUCCESS;
@@ -351,18 +437,95 @@ efi_status_t efi_free_pages(uint64_t memory, unsigned long pages)
 	return EFI_NOT_FOUND;
 }
 
+static efi_status_t efi_pool_alloc_small(int pool_type, unsigned int class,
+					 void **buffer)
+{
+	struct list_head *pages = &efi_pool_pages[class];
+	unsigned int slot_size = 1 << (class + EFI_POOL_MIN_SHIFT);
+	struct efi_pool_allocation *alloc;
+	struct efi_pool_page *page;
+	efi_physical_addr_t t;
+	efi_status_t r;
+	char *slot;
+
+	if (!pages->next)
+		INIT_LIST_HEAD(pages);
+
+	list_for_each_entry(page, pages, link) {
+		if (page->memory_type == pool_type)
+			goto found;
+	}
+
+	/* No free slots of this type, so set up a new pool page */
+	r = efi_allocate_pages(0, pool_type, 1, &t);
+	if (r != EFI_SUCCESS)
+		return r;
+
+	page = (void *)(uintptr_t)t;
+	page->memory_type = pool_type;
+	page->class = class;
+	page->used = 0;
+	page->free = NULL;
+	for (slot = (char *)page + ALIGN(sizeof(*page), sizeof(u64));
+	     slot + slot_size <= (char *)page + EFI_PAGE_SIZE;
+	     slot += slot_size) {
+		*(void **)slot = page->free;
+		page->free = slot;
+	}
+	list_add(&page->link, pages);
+
+found:
+	alloc = page->free;
+	page->free = *(void **)alloc;
+	page->used++;
+	if (!page->free)
+		list_del_init(&page->link);
+
+	alloc->num_pages = 0;
+	*buffer = alloc->data;
+
+	return EFI_SUCCESS;
+}
+
+static efi_status_t efi_pool_free_small(struct efi_pool_allocation *alloc)
+{
+	struct efi_pool_page *page;
+
+	page = (void *)((uintptr_t)alloc & ~EFI_PAGE_MASK);
+
+	/* The page has a free slot again */
+	if (!page->free)
+		list_add(&page->link, &efi_pool_pages[page->class]);
+
+	*(void **)alloc = page->free;
+	page->free = alloc;
+	if (--page->used)
+		return EFI_SUCCESS;
+
+	/* Give back pool pages which are no longer used */
+	list_del(&page->link);
+
+	return efi_free_pages((uintptr_t)page, 1);
+}
+
 efi_status_t efi_allocate_pool(int pool_type, unsigned long size,
 			       void **buffer)
 {
 	efi_status_t r;
 	efi_physical_addr_t t;
 	u64 num_pages = (size + sizeof(u64) + EFI_PAGE_MASK) >> EFI_PAGE_SHIFT;
+	unsigned int class;
 
 	if (size == 0) {
 		*buffer = NULL;
 		return EFI_SUCCESS;
 	}
 
+	for (class = 0; class < EFI_POOL_CLASSES; class++) {
+		if (size + sizeof(u64) <= 1 << (class + EFI_POOL_MIN_SHIFT))
+			return efi_pool_alloc_small(pool_type, class, buffer);
+	}
+
 	r = efi_allocate_pages(0, pool_type, num_pages, &t);
 
 	if (r == EFI_SUCCESS) {
@@ -380,8 +543,12 @@ efi_status_t efi_free_pool(void *buffer)
 	struct efi_pool_allocation *alloc;
 
 	alloc = container_of(buffer, struct efi_pool_allocation, data);
-	/* Sanity check, was the supplied address returned by allocate_pool */
-	assert(((uintptr_t)alloc & EFI_PAGE_MASK) == 0);
+
+	/* Small allocations live inside a pool page */
+	if ((uintptr_t)alloc & EFI_PAGE_MASK) {
+		assert(!alloc->num_pages);
+		return efi_pool_free_small(alloc);
+	}
 
 	r = efi_free_pages((uintptr_t)alloc, alloc->num_pages);
 
@@ -395,13 +562,10 @@ efi_status_t efi_get_memory_map(unsigned long *memory_map_size,
 			       uint32_t *descriptor_version)
 {
 	ulong map_size = 0;
-	int map_entries = 0;
-	struct list_head *lhandle;
+	int map_entries = efi_mem_count;
+	struct rb_node *rb;
 	unsigned long provided_map_size = *memory_map_size;
 
-	list_for_each(lhandle, &efi_mem)
-		map_entries++;
-
 	map_size = map_entries * sizeof(struct efi_mem_desc);
 
 	*memory_map_size = map_size;
@@ -418,19 +582,69 @@ efi_status_t efi_get_memory_map(unsigned long *memory_map_size,
 	/* Copy list into array */
 	if (memory_map) {
 		/* Return the list in ascending order */
-		memory_map = &memory_map[map_entries - 1];
-		list_for_each(lhandle, &efi_mem) {
+		for (rb = rb_first(&efi_mem); rb; rb = rb_next(rb)) {
 			struct efi_mem_list *lmem;
 
-			lmem = list_entry(lhandle, struct efi_mem_list, link);
+			lmem = rb_entry(rb, struct efi_mem_list, node);
 			*memory_map = lmem->desc;
-			memory_map--;
+			memory_map++;
 		}
 	}
 
 	return EFI_SUCCESS;
 }
 
+#ifdef CONFIG_UNIT_TEST
+/* Find the largest free block in a subtree, without using subtree_free */
+static int efi_mem_check_subtree(struct rb_node *rb, u64 *freep)
+{
+	struct efi_mem_list *lmem;
+	u64 left, right, max = 0;
+
+	*freep = 0;
+	if (!rb)
+		return 0;
+	if (efi_mem_check_subtree(rb->rb_left, &left) ||
+	    efi_mem_check_subtree(rb->rb_right, &right))
+		return -EINVAL;
+
+	lmem = rb_entry(rb, struct efi_mem_list, node);
+	if (lmem->desc.type == EFI_CONVENTIONAL_MEMORY)
+		max = lmem->desc.num_pages;
+	max = max(max, max(left, right));
+	if (lmem->subtree_free != max)
+		return -EINVAL;
+	*freep = max;
+
+	return 0;
+}
+
+int efi_memory_check(void)
+{
+	struct efi_mem_list *lmem, *prev = NULL;
+	u64 largest = 0, free;
+	struct rb_node *rb;
+	int count = 0;
+
+	for (rb = rb_first(&efi_mem); rb; rb = rb_next(rb)) {
+		lmem = rb_entry(rb, struct efi_mem_list, node);
+		if (!lmem->desc.num_pages ||
+		    (prev && efi_mem_end(prev) > lmem->desc.physical_start))
+			return -EINVAL;
+		if (lmem->desc.type == EFI_CONVENTIONAL_MEMORY)
+			largest = max(largest, lmem->desc.num_pages);
+		prev = lmem;
+		count++;
+	}
+	if (count != efi_mem_count)
+		return -EINVAL;
+	if (efi_mem_check_subtree(efi_mem.rb_node, &free) || free != largest)
+		return -EINVAL;
+
+	return 0;
+}
+#endif
+
 __weak void efi_add_known_memory(void)
 {
 	int i;
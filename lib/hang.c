@@ -26,6 +26,7 @@ void hang(void)
 	puts("### ERROR ### Please RESET the board ###\n");
 #endif
 	bootstage_error(BOOTSTAGE_ID_NEED_RESET);
+	serial_tx_flush();
 	for (;;)
 		;
 }
@@ -156,9 +156,12 @@ void hdestroy_r(struct hsearch_data *htab)
 		}
 	}
 	free(htab->table);
+	free(htab->sorted);
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
+	htab->sorted = NULL;
+	htab->nsorted = 0;
 }
 
 /*
@@ -528,6 +531,74 @@ static int cmpkey(const void *p1, const void *p2)
 	return (strcmp(e1->key, e2->key));
 }
 
+/*
+ * Collect all entries of the table in "list", sorted by key.
+ *
+ * The order from the previous export is kept in the table: the entries from
+ * it which are still present and still in order make up a sorted run, so
+ * only the entries added since then have to be sorted before both are
+ * merged. Exporting an unchanged environment needs no sorting at all.
+ */
+static int hexport_sort(struct hsearch_data *htab, ENTRY **list)
+{
+	ENTRY **added, **sorted;
+	unsigned char *seen;
+	int i, n, nrun, nadded;
+
+	added = malloc(htab->size * sizeof(ENTRY *) + htab->size + 1);
+	if (!added) {
+		__set_errno(ENOMEM);
+		return -1;
+	}
+	seen = (unsigned char *)(added + htab->size);
+	memset(seen, 0, htab->size + 1);
+
+	for (i = 0, nrun = 0; i < htab->nsorted; ++i) {
+		ENTRY *ep = htab->sorted[i];
+		_ENTRY *hp = (_ENTRY *)((char *)ep - offsetof(_ENTRY, entry));
+
+		if (hp->used <= 0)
+			continue;
+		if (nrun && strcmp(list[nrun - 1]->key, ep->key) >= 0)
+			continue;
+		seen[hp - htab->table] = 1;
+		list[nrun++] = ep;
+	}
+
+	for (i = 1, nadded = 0; i <= htab->size; ++i) {
+		if (htab->table[i].used > 0 && !seen[i])
+			added[nadded++] = &htab->table[i].entry;
+	}
+
+	/* Sort the new entries and merge them in, from the end backwards */
+	qsort(added, nadded, sizeof(ENTRY *), cmpkey);
+	n = nrun + nadded;
+	for (i = n; nadded; ) {
+		if (nrun && strcmp(list[nrun - 1]->key,
+				   added[nadded - 1]->key) > 0)
+			list[--i] = list[--nrun];
+		else
+			list[--i] = added[--nadded];
+	}
+	free(added);
+
+	/* Remember the order for the next export */
+	if (!n) {
+		free(htab->sorted);
+		htab->sorted = NULL;
+		htab->nsorted = 0;
+	} else {
+		sorted = realloc(htab->sorted, n * sizeof(ENTRY *));
+		if (sorted) {
+			memcpy(sorted, list, n * sizeof(ENTRY *));
+			htab->sorted = sorted;
+			htab->nsorted = n;
+		}
+	}
+
+	return n;
+}
+
 static int match_string(int flag, const char *str, const char *pat, void *priv)
 {
 	switch (flag & H_MATCH_METHOD) {
@@ -594,7 +665,7 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	ENTRY *list[htab->size];
 	char *res, *p;
 	size_t totlen;
-	int i, n;
+	int i, n, count;
 
 	/* Test for correct arguments.  */
 	if ((resp == NULL) || (htab == NULL)) {
@@ -604,56 +675,54 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	debug("EXPORT  table = %p, htab.size = %d, htab.filled = %d, size = %lu\n",
 	      htab, htab->size, htab->filled, (ulong)size);
+	/* Get all entries sorted by keys */
+	count = hexport_sort(htab, list);
+	if (count < 0)
+		return (-1);
+
 	/*
 	 * Pass 1:
-	 * search used entries,
-	 * save addresses and compute total length
+	 * select matching entries and compute total length
 	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
-
-		if (htab->table[i].used > 0) {
-			ENTRY *ep = &htab->table[i].entry;
-			int found = match_entry(ep, flag, argc, argv);
+	for (i = 0, n = 0, totlen = 0; i < count; ++i) {
+		ENTRY *ep = list[i];
+		int found = match_entry(ep, flag, argc, argv);
 
-			if ((argc > 0) && (found == 0))
-				continue;
+		if ((argc > 0) && (found == 0))
+			continue;
 
-			if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
-				continue;
+		if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
+			continue;
 
-			list[n++] = ep;
+		list[n++] = ep;
 
-			totlen += strlen(ep->key) + 2;
+		totlen += strlen(ep->key) + 2;
 
-			if (sep == '\0') {
-				totlen += strlen(ep->data);
-			} else {	/* check if escapes are needed */
-				char *s = ep->data;
+		if (sep == '\0') {
+			totlen += strlen(ep->data);
+		} else {	/* check if escapes are needed */
+			char *s = ep->data;
 
-				while (*s) {
+			while (*s) {
+				++totlen;
+				/* add room for needed escape chars */
+				if ((*s == sep) || (*s == '\\'))
 					++totlen;
-					/* add room for needed escape chars */
-					if ((*s == sep) || (*s == '\\'))
-						++totlen;
-					++s;
-				}
+				++s;
 			}
-			totlen += 2;	/* for '=' and 'sep' char */
 		}
+		totlen += 2;	/* for '=' and 'sep' char */
 	}
 
 #ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
+	/* Pass 1a: print selected list */
+	printf("Selected: n=%d\n", n);
 	for (i = 0; i < n; ++i) {
 		printf("\t%3d: %p ==> %-10s => %s\n",
 		       i, list[i], list[i]->key, list[i]->data);
 	}
 #endif
 
-	/* Sort list by keys */
-	qsort(list, n, sizeof(ENTRY *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
@@ -739,6 +808,45 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
 	return res;
 }
 
+/*
+ * Give an entry which is kept by a merging import the new value, checking
+ * and notifying the change as if the entry had been created afresh, which
+ * is what happens when the table is rebuilt instead.
+ */
+static int _hmerge_entry(struct hsearch_data *htab, int idx,
+	const char *value, int flag)
+{
+	ENTRY *ep = &htab->table[idx].entry;
+	char *data;
+
+	/* check for permission */
+	if (htab->change_ok != NULL &&
+	    htab->change_ok(ep, value, env_op_create, flag)) {
+		debug("change_ok() rejected setting variable "
+			"%s, skipping it!\n", ep->key);
+		__set_errno(EPERM);
+		return 0;
+	}
+
+	/* If there is a callback, call it */
+	if (ep->callback && ep->callback(ep->key, value, env_op_create, flag)) {
+		debug("callback() rejected setting variable "
+			"%s, skipping it!\n", ep->key);
+		__set_errno(EINVAL);
+		return 0;
+	}
+
+	data = strdup(value);
+	if (!data) {
+		__set_errno(ENOMEM);
+		return 0;
+	}
+	free(ep->data);
+	ep->data = data;
+
+	return idx;
+}
+
 /*
  * Import linearized data into hash table.
  *
@@ -753,6 +861,12 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
  * new data will be added to an existing hash table; otherwise, old
  * data will be discarded and a new hash table will be created.
  *
+ * With H_MERGE (and without H_NOCLEAR) the result is the same as with a
+ * new hash table, but an existing table is updated in place instead:
+ * entries whose value does not change are left alone (no checks and no
+ * callbacks are run for them), changed entries are treated as newly
+ * created, and entries missing from the imported data are removed.
+ *
  * The separator character for the "name=value" pairs can be selected,
  * so we both support importing from externally stored environment
  * data (separated by NUL characters) and from plain text files
@@ -780,6 +894,8 @@ int himport_r(struct hsearch_data *htab,
 {
 	char *data, *sp, *dp, *name, *value;
 	char *localvars[nvars];
+	unsigned char *stale = NULL;
+	int nent = CONFIG_ENV_MIN_ENTRIES + size / 8;
 	int i;
 
 	/* Test for correct arguments.  */
@@ -802,7 +918,18 @@ int himport_r(struct hsearch_data *htab,
 	if (nvars)
 		memcpy(localvars, vars, sizeof(vars[0]) * nvars);
 
-	if ((flag & H_NOCLEAR) == 0) {
+	if (nent > CONFIG_ENV_MAX_ENTRIES)
+		nent = CONFIG_ENV_MAX_ENTRIES;
+
+	if ((flag & (H_NOCLEAR | H_MERGE)) == H_MERGE && htab->table &&
+	    htab->size >= nent && size) {
+		/* Note the current entries; those not imported get removed */
+		stale = calloc(htab->size + 1, 1);
+		for (i = 1; stale && i <= htab->size; ++i)
+			stale[i] = htab->table[i].used > 0;
+	}
+
+	if ((flag & H_NOCLEAR) == 0 && !stale) {
 		/* Destroy old hash table if one exists */
 		debug("Destroy Hash Table: %p table = %p\n", htab,
 		       htab->table);
@@ -829,11 +956,6 @@ int himport_r(struct hsearch_data *htab,
 	 */
 
 	if (!htab->table) {
-		int nent = CONFIG_ENV_MIN_ENTRIES + size / 8;
-
-		if (nent > CONFIG_ENV_MAX_ENTRIES)
-			nent = CONFIG_ENV_MAX_ENTRIES;
-
 		debug("Create Hash Table: N=%d\n", nent);
 
 		if (hcreate_r(nent, htab) == 0) {
@@ -862,6 +984,7 @@ int himport_r(struct hsearch_data *htab,
 	/* Parse environment; allow for '\0' and 'sep' as separators */
 	do {
 		ENTRY e, *rv;
+		int idx;
 
 		/* skip leading white space */
 		while (isblank(*dp))
@@ -890,6 +1013,17 @@ int himport_r(struct hsearch_data *htab,
 			if (!drop_var_from_set(name, nvars, localvars))
 				continue;
 
+			if (stale) {
+				/* not imported yet, so already gone */
+				e.key = name;
+				idx = hsearch_r(e, FIND, &rv, htab, 0);
+				if (idx && stale[idx]) {
+					stale[idx] = 0;
+					_hdelete(name, htab, rv, idx);
+					continue;
+				}
+			}
+
 			if (hdelete_r(name, htab, flag) == 0)
 				debug("DELETE ERROR ##############################\n");
 
@@ -909,6 +1043,7 @@ int himport_r(struct hsearch_data *htab,
 		if (*name == 0) {
 			debug("INSERT: unable to use an empty key\n");
 			__set_errno(EINVAL);
+			free(stale);
 			free(data);
 			return 0;
 		}
@@ -921,7 +1056,23 @@ int himport_r(struct hsearch_data *htab,
 		e.key = name;
 		e.data = value;
 
-		hsearch_r(e, ENTER, &rv, htab, flag);
+		idx = 0;
+		if (stale) {
+			idx = hsearch_r(e, FIND, &rv, htab, 0);
+			if (idx && !stale[idx])
+				idx = 0;
+		}
+		if (idx) {
+			/* keep the entry if its value is unchanged */
+			stale[idx] = 0;
+			if (strcmp(rv->data, value) &&
+			    !_hmerge_entry(htab, idx, value, flag)) {
+				_hdelete(name, htab, rv, idx);
+				rv = NULL;
+			}
+		} else {
+			hsearch_r(e, ENTER, &rv, htab, flag);
+		}
 		if (rv == NULL)
 			printf("himport_r: can't insert \"%s=%s\" into hash table\n",
 				name, value);
@@ -934,6 +1085,16 @@ int himport_r(struct hsearch_data *htab,
 	debug("INSERT: free(data = %p)\n", data);
 	free(data);
 
+	/* remove the entries which were not in the imported data */
+	if (stale) {
+		for (i = 1; i <= htab->size; ++i) {
+			if (stale[i] && htab->table[i].used > 0)
+				_hdelete(htab->table[i].entry.key, htab,
+					 &htab->table[i].entry, i);
+		}
+		free(stale);
+	}
+
 	/* process variables which were not considered */
 	for (i = 0; i < nvars; i++) {
 		if (localvars[i] == NULL)
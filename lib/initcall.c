@@ -7,9 +7,36 @@
 #include <common.h>
 #include <initcall.h>
 #include <efi.h>
+#include <asm/sections.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#ifdef CONFIG_BOOTSTAGE_SPANS
+static int initcall_call(init_fnc_t func, unsigned long reloc_ofs)
+{
+	char name[24];
+	int span;
+	int ret;
+
+#ifdef CONFIG_SANDBOX
+	/* Sandbox is position-independent and linked at address 0 */
+	reloc_ofs = (unsigned long)__executable_start;
+#endif
+	/* Name the span by its address in System.map */
+	snprintf(name, sizeof(name), "%p", (char *)func - reloc_ofs);
+	span = bootstage_span_start(BOOTSTAGE_SPAN_INITCALL, name);
+	ret = func();
+	bootstage_span_end(span);
+
+	return ret;
+}
+#else
+static inline int initcall_call(init_fnc_t func, unsigned long reloc_ofs)
+{
+	return func();
+}
+#endif
+
 int initcall_run_list(const init_fnc_t init_sequence[])
 {
 	const init_fnc_t *init_fnc_ptr;
@@ -28,7 +55,7 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 			debug(" (relocated to %p)\n", (char *)*init_fnc_ptr);
 		else
 			debug("\n");
-		ret = (*init_fnc_ptr)();
+		ret = initcall_call(*init_fnc_ptr, reloc_ofs);
 		if (ret) {
 			printf("initcall sequence %p failed at call %p (err=%d)\n",
 			       init_sequence,
@@ -1,5 +1,6 @@
 
 #include <common.h>
+#include <malloc_trace.h>
 #include <linux/compat.h>
 
 struct p_current cur = {
@@ -19,6 +20,7 @@ void *kmalloc(size_t size, int flags)
 	void *p;
 
 	p = memalign(ARCH_DMA_MINALIGN, size);
+	malloc_trace_set_caller(p, _RET_IP_, 0);
 	if (flags & __GFP_ZERO)
 		memset(p, 0, size);
 
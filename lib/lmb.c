@@ -9,6 +9,7 @@
 
 #include <common.h>
 #include <lmb.h>
+#include <malloc.h>
 
 #define LMB_ALLOC_ANYWHERE	0
 
@@ -41,135 +42,143 @@ void lmb_dump_all(struct lmb *lmb)
 #endif /* DEBUG */
 }
 
-static long lmb_addrs_overlap(phys_addr_t base1,
-		phys_size_t size1, phys_addr_t base2, phys_size_t size2)
+/*
+ * Region ends are handled as the address of the last byte so that a region
+ * reaching the top of the address space does not overflow.
+ */
+static phys_addr_t lmb_last(const struct lmb_property *prop)
+{
+	return prop->base + prop->size - 1;
+}
+
+/* Find the first region which ends at or above addr */
+static unsigned long lmb_find(struct lmb_region *rgn, phys_addr_t addr)
 {
-	return ((base1 < (base2+size2)) && (base2 < (base1+size1)));
+	unsigned long lo = 0, hi = rgn->cnt;
+
+	while (lo < hi) {
+		unsigned long mid = (lo + hi) / 2;
+
+		if (lmb_last(&rgn->region[mid]) < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
 }
 
-static long lmb_addrs_adjacent(phys_addr_t base1, phys_size_t size1,
-		phys_addr_t base2, phys_size_t size2)
+/* Make room for one more region, moving the table to the heap if needed */
+static long lmb_grow(struct lmb_region *rgn)
 {
-	if (base2 == base1 + size1)
-		return 1;
-	else if (base1 == base2 + size2)
+	struct lmb_property *region;
+	unsigned long max;
+
+	if (rgn->cnt < rgn->max)
+		return 0;
+
+	max = rgn->max * 2;
+	region = malloc(max * sizeof(*region));
+	if (!region)
 		return -1;
+	memcpy(region, rgn->region, rgn->cnt * sizeof(*region));
+	if (rgn->region != rgn->initial)
+		free(rgn->region);
+	rgn->region = region;
+	rgn->max = max;
 
 	return 0;
 }
 
-static long lmb_regions_adjacent(struct lmb_region *rgn,
-		unsigned long r1, unsigned long r2)
+static long lmb_insert_region(struct lmb_region *rgn, unsigned long r,
+			      phys_addr_t base, phys_size_t size)
 {
-	phys_addr_t base1 = rgn->region[r1].base;
-	phys_size_t size1 = rgn->region[r1].size;
-	phys_addr_t base2 = rgn->region[r2].base;
-	phys_size_t size2 = rgn->region[r2].size;
+	if (lmb_grow(rgn) < 0)
+		return -1;
+
+	memmove(&rgn->region[r + 1], &rgn->region[r],
+		(rgn->cnt - r) * sizeof(*rgn->region));
+	rgn->region[r].base = base;
+	rgn->region[r].size = size;
+	rgn->cnt++;
 
-	return lmb_addrs_adjacent(base1, size1, base2, size2);
+	return 0;
 }
 
-static void lmb_remove_region(struct lmb_region *rgn, unsigned long r)
+/* Remove the regions r to r + count - 1 */
+static void lmb_remove_regions(struct lmb_region *rgn, unsigned long r,
+			       unsigned long count)
 {
-	unsigned long i;
-
-	for (i = r; i < rgn->cnt - 1; i++) {
-		rgn->region[i].base = rgn->region[i + 1].base;
-		rgn->region[i].size = rgn->region[i + 1].size;
-	}
-	rgn->cnt--;
+	memmove(&rgn->region[r], &rgn->region[r + count],
+		(rgn->cnt - r - count) * sizeof(*rgn->region));
+	rgn->cnt -= count;
 }
 
-/* Assumption: base addr of region 1 < base addr of region 2 */
-static void lmb_coalesce_regions(struct lmb_region *rgn,
-		unsigned long r1, unsigned long r2)
+static void lmb_init_region(struct lmb_region *rgn)
 {
-	rgn->region[r1].size += rgn->region[r2].size;
-	lmb_remove_region(rgn, r2);
+	rgn->cnt = 0;
+	rgn->max = ARRAY_SIZE(rgn->initial);
+	rgn->size = 0;
+	rgn->region = rgn->initial;
 }
 
 void lmb_init(struct lmb *lmb)
 {
-	/* Create a dummy zero size LMB which will get coalesced away later.
-	 * This simplifies the lmb_add() code below...
-	 */
-	lmb->memory.region[0].base = 0;
-	lmb->memory.region[0].size = 0;
-	lmb->memory.cnt = 1;
-	lmb->memory.size = 0;
-
-	/* Ditto. */
-	lmb->reserved.region[0].base = 0;
-	lmb->reserved.region[0].size = 0;
-	lmb->reserved.cnt = 1;
-	lmb->reserved.size = 0;
+	lmb_init_region(&lmb->memory);
+	lmb_init_region(&lmb->reserved);
+	lmb->policy = LMB_ALLOC_TOP_DOWN;
 }
 
-/* This routine called with relocation disabled. */
+/*
+ * Free any region tables which were moved to the heap. The lmb must have
+ * been set up with lmb_init() or be all zeroes.
+ */
+void lmb_release(struct lmb *lmb)
+{
+	if (lmb->memory.region && lmb->memory.region != lmb->memory.initial)
+		free(lmb->memory.region);
+	if (lmb->reserved.region &&
+	    lmb->reserved.region != lmb->reserved.initial)
+		free(lmb->reserved.region);
+	lmb_init(lmb);
+}
+
+/*
+ * Add a region, merging it with all regions it overlaps or touches.
+ * Returns the number of regions it was merged with, or -1 on error.
+ */
 static long lmb_add_region(struct lmb_region *rgn, phys_addr_t base, phys_size_t size)
 {
-	unsigned long coalesced = 0;
-	long adjacent, i;
+	phys_addr_t last, rgnbase, rgnlast;
+	unsigned long i, j;
 
-	if ((rgn->cnt == 1) && (rgn->region[0].size == 0)) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
+	if (!size)
 		return 0;
-	}
-
-	/* First try and coalesce this LMB with another. */
-	for (i=0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-
-		if ((rgnbase == base) && (rgnsize == size))
-			/* Already have this region, so we're done */
-			return 0;
+	last = base + size - 1;
 
-		adjacent = lmb_addrs_adjacent(base,size,rgnbase,rgnsize);
-		if ( adjacent > 0 ) {
-			rgn->region[i].base -= size;
-			rgn->region[i].size += size;
-			coalesced++;
+	/* Find the regions which overlap or are adjacent to the new one */
+	i = lmb_find(rgn, base ? base - 1 : 0);
+	for (j = i; j < rgn->cnt; j++) {
+		if (last != (phys_addr_t)-1 && rgn->region[j].base > last + 1)
 			break;
-		}
-		else if ( adjacent < 0 ) {
-			rgn->region[i].size += size;
-			coalesced++;
-			break;
-		}
 	}
 
-	if ((i < rgn->cnt-1) && lmb_regions_adjacent(rgn, i, i+1) ) {
-		lmb_coalesce_regions(rgn, i, i+1);
-		coalesced++;
-	}
-
-	if (coalesced)
-		return coalesced;
-	if (rgn->cnt >= MAX_LMB_REGIONS)
-		return -1;
+	/* Nothing to coalesce with, so add it to the sorted table. */
+	if (i == j)
+		return lmb_insert_region(rgn, i, base, size);
 
-	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = rgn->cnt-1; i >= 0; i--) {
-		if (base < rgn->region[i].base) {
-			rgn->region[i+1].base = rgn->region[i].base;
-			rgn->region[i+1].size = rgn->region[i].size;
-		} else {
-			rgn->region[i+1].base = base;
-			rgn->region[i+1].size = size;
-			break;
-		}
-	}
+	if (j == i + 1 && rgn->region[i].base == base &&
+	    rgn->region[i].size == size)
+		/* Already have this region, so we're done */
+		return 0;
 
-	if (base < rgn->region[0].base) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-	}
+	rgnbase = min(base, rgn->region[i].base);
+	rgnlast = max(last, lmb_last(&rgn->region[j - 1]));
+	rgn->region[i].base = rgnbase;
+	rgn->region[i].size = rgnlast - rgnbase + 1;
+	lmb_remove_regions(rgn, i + 1, j - i - 1);
 
-	rgn->cnt++;
-
-	return 0;
+	return j - i;
 }
 
 /* This routine may be called with relocation disabled. */
@@ -183,40 +192,39 @@ long lmb_add(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 {
 	struct lmb_region *rgn = &(lmb->reserved);
-	phys_addr_t rgnbegin, rgnend;
-	phys_addr_t end = base + size;
-	int i;
+	phys_addr_t rgnbegin, rgnlast;
+	phys_addr_t last = base + size - 1;
+	unsigned long i;
 
-	rgnbegin = rgnend = 0; /* supress gcc warnings */
+	if (!size)
+		return 0;
 
 	/* Find the region where (base, size) belongs to */
-	for (i=0; i < rgn->cnt; i++) {
-		rgnbegin = rgn->region[i].base;
-		rgnend = rgnbegin + rgn->region[i].size;
-
-		if ((rgnbegin <= base) && (end <= rgnend))
-			break;
-	}
+	i = lmb_find(rgn, base);
 
 	/* Didn't find the region */
 	if (i == rgn->cnt)
 		return -1;
+	rgnbegin = rgn->region[i].base;
+	rgnlast = lmb_last(&rgn->region[i]);
+	if (rgnbegin > base || rgnlast < last)
+		return -1;
 
 	/* Check to see if we are removing entire region */
-	if ((rgnbegin == base) && (rgnend == end)) {
-		lmb_remove_region(rgn, i);
+	if ((rgnbegin == base) && (rgnlast == last)) {
+		lmb_remove_regions(rgn, i, 1);
 		return 0;
 	}
 
 	/* Check to see if region is matching at the front */
 	if (rgnbegin == base) {
-		rgn->region[i].base = end;
+		rgn->region[i].base = last + 1;
 		rgn->region[i].size -= size;
 		return 0;
 	}
 
 	/* Check to see if the region is matching at the end */
-	if (rgnend == end) {
+	if (rgnlast == last) {
 		rgn->region[i].size -= size;
 		return 0;
 	}
@@ -225,8 +233,8 @@ long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 	 * We need to split the entry -  adjust the current one to the
 	 * beginging of the hole and add the region after hole.
 	 */
-	rgn->region[i].size = base - rgn->region[i].base;
-	return lmb_add_region(rgn, end, rgnend - end);
+	rgn->region[i].size = base - rgnbegin;
+	return lmb_insert_region(rgn, i + 1, last + 1, rgnlast - last);
 }
 
 long lmb_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size)
@@ -241,15 +249,14 @@ static long lmb_overlaps_region(struct lmb_region *rgn, phys_addr_t base,
 {
 	unsigned long i;
 
-	for (i=0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-		if ( lmb_addrs_overlap(base,size,rgnbase,rgnsize) ) {
-			break;
-		}
-	}
+	if (!size)
+		return -1;
+
+	i = lmb_find(rgn, base);
+	if (i < rgn->cnt && rgn->region[i].base <= base + size - 1)
+		return i;
 
-	return (i < rgn->cnt) ? i : -1;
+	return -1;
 }
 
 phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align)
@@ -280,59 +287,131 @@ static phys_addr_t lmb_align_up(phys_addr_t addr, ulong size)
 	return (addr + (size - 1)) & ~(size - 1);
 }
 
-phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align, phys_addr_t max_addr)
+/*
+ * Find the highest aligned address at which size bytes fit in the memory
+ * region [lmbbase, lmbbase + lmbsize) below max_addr without overlapping a
+ * reserved region. Returns 0 if there is none.
+ */
+static phys_addr_t lmb_alloc_top_down(struct lmb *lmb, phys_addr_t lmbbase,
+				      phys_size_t lmbsize, phys_size_t size,
+				      ulong align, phys_addr_t max_addr)
 {
-	long i, j;
-	phys_addr_t base = 0;
-	phys_addr_t res_base;
-
-	for (i = lmb->memory.cnt-1; i >= 0; i--) {
-		phys_addr_t lmbbase = lmb->memory.region[i].base;
-		phys_size_t lmbsize = lmb->memory.region[i].size;
-
-		if (lmbsize < size)
-			continue;
-		if (max_addr == LMB_ALLOC_ANYWHERE)
-			base = lmb_align_down(lmbbase + lmbsize - size, align);
-		else if (lmbbase < max_addr) {
-			base = lmbbase + lmbsize;
-			if (base < lmbbase)
-				base = -1;
-			base = min(base, max_addr);
-			base = lmb_align_down(base - size, align);
-		} else
-			continue;
-
-		while (base && lmbbase <= base) {
-			j = lmb_overlaps_region(&lmb->reserved, base, size);
-			if (j < 0) {
-				/* This area isn't reserved, take it */
-				if (lmb_add_region(&lmb->reserved, base,
-							lmb_align_up(size,
-								align)) < 0)
-					return 0;
-				return base;
+	phys_addr_t base, res_base;
+	long j;
+
+	if (max_addr == LMB_ALLOC_ANYWHERE)
+		base = lmb_align_down(lmbbase + lmbsize - size, align);
+	else if (lmbbase < max_addr) {
+		base = lmbbase + lmbsize;
+		if (base < lmbbase)
+			base = -1;
+		base = min(base, max_addr);
+		base = lmb_align_down(base - size, align);
+	} else
+		return 0;
+
+	while (base && lmbbase <= base) {
+		j = lmb_overlaps_region(&lmb->reserved, base, size);
+		if (j < 0)
+			/* This area isn't reserved, take it */
+			return base;
+		res_base = lmb->reserved.region[j].base;
+		if (res_base < size)
+			break;
+		base = lmb_align_down(res_base - size, align);
+	}
+
+	return 0;
+}
+
+/*
+ * Find the smallest free area which can hold size bytes at an aligned
+ * address below max_addr and return the highest such address in it.
+ * Returns 0 if there is none.
+ */
+static phys_addr_t lmb_alloc_best_fit(struct lmb *lmb, phys_size_t size,
+				      ulong align, phys_addr_t max_addr)
+{
+	struct lmb_region *res = &lmb->reserved;
+	phys_addr_t best = 0, gap_start, gap_last, mem_last, base;
+	phys_size_t best_size = 0;
+	unsigned long i, j;
+
+	for (i = 0; i < lmb->memory.cnt; i++) {
+		gap_start = lmb->memory.region[i].base;
+		mem_last = lmb_last(&lmb->memory.region[i]);
+		if (max_addr != LMB_ALLOC_ANYWHERE) {
+			if (gap_start >= max_addr)
+				break;
+			mem_last = min(mem_last, max_addr - 1);
+		}
+
+		/* Walk the free areas between the reserved regions */
+		for (j = lmb_find(res, gap_start); ; j++) {
+			bool more = j < res->cnt && res->region[j].base <= mem_last;
+
+			gap_last = mem_last;
+			if (more) {
+				if (res->region[j].base <= gap_start)
+					goto next;
+				gap_last = res->region[j].base - 1;
+			}
+			if (gap_last - gap_start + 1 >= size) {
+				base = lmb_align_down(gap_last - size + 1,
+						      align);
+				if (base && base >= gap_start &&
+				    (!best || gap_last - gap_start <
+					      best_size)) {
+					best = base;
+					best_size = gap_last - gap_start;
+				}
 			}
-			res_base = lmb->reserved.region[j].base;
-			if (res_base < size)
+next:
+			if (!more || lmb_last(&res->region[j]) >= mem_last)
 				break;
-			base = lmb_align_down(res_base - size, align);
+			gap_start = lmb_last(&res->region[j]) + 1;
 		}
 	}
-	return 0;
+
+	return best;
 }
 
-int lmb_is_reserved(struct lmb *lmb, phys_addr_t addr)
+phys_addr_t __lmb_alloc_base(struct lmb *lmb, phys_size_t size, ulong align, phys_addr_t max_addr)
 {
-	int i;
+	phys_addr_t base = 0;
+	long i;
+
+	if (!size)
+		return 0;
 
-	for (i = 0; i < lmb->reserved.cnt; i++) {
-		phys_addr_t upper = lmb->reserved.region[i].base +
-			lmb->reserved.region[i].size - 1;
-		if ((addr >= lmb->reserved.region[i].base) && (addr <= upper))
-			return 1;
+	if (lmb->policy == LMB_ALLOC_BEST_FIT) {
+		base = lmb_alloc_best_fit(lmb, size, align, max_addr);
+	} else {
+		for (i = lmb->memory.cnt - 1; i >= 0; i--) {
+			phys_addr_t lmbbase = lmb->memory.region[i].base;
+			phys_size_t lmbsize = lmb->memory.region[i].size;
+
+			if (lmbsize < size)
+				continue;
+			base = lmb_alloc_top_down(lmb, lmbbase, lmbsize, size,
+						  align, max_addr);
+			if (base)
+				break;
+		}
 	}
-	return 0;
+
+	if (!base)
+		return 0;
+	if (lmb_add_region(&lmb->reserved, base,
+			   lmb_align_up(size, align)) < 0)
+		return 0;
+
+	return base;
+}
+
+int lmb_is_reserved(struct lmb *lmb, phys_addr_t addr)
+{
+	return lmb_overlaps_region(&lmb->reserved, addr, 1) >= 0;
 }
 
 __weak void board_lmb_reserve(struct lmb *lmb)
@@ -0,0 +1,216 @@
+/*
+ * Sampling profiler
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * The architecture calls profile_sample() from a timer interrupt or signal
+ * handler, passing the interrupted program counter. The samples are kept in
+ * a ring buffer so that the most recent ones are available however long the
+ * profiler runs. Unlike the function tracer this needs no special build and
+ * costs nothing between samples.
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <profile.h>
+#include <trace.h>
+#include <asm/sections.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct profile_count - Number of samples seen at an address
+ *
+ * @addr:	Link address of the sample
+ * @count:	Number of samples
+ */
+struct profile_count {
+	ulong addr;
+	uint count;
+};
+
+static ulong *samples;		/* Ring buffer of program counters */
+static uint sample_size;	/* Size of ring buffer */
+static uint sample_head;	/* Next position to write */
+static ulong sample_total;	/* Total samples taken */
+static uint sample_rate;
+static bool running;
+
+void profile_sample(ulong pc)
+{
+	if (!running)
+		return;
+	samples[sample_head] = pc;
+	if (++sample_head == sample_size)
+		sample_head = 0;
+	sample_total++;
+}
+
+int __weak arch_profile_start(uint rate)
+{
+	return -ENOSYS;
+}
+
+void __weak arch_profile_stop(void)
+{
+}
+
+int profile_start(uint rate, uint size)
+{
+	int ret;
+
+	profile_stop();
+	if (size != sample_size) {
+		free(samples);
+		sample_size = 0;
+		samples = malloc(size * sizeof(*samples));
+		if (!samples)
+			return -ENOMEM;
+		sample_size = size;
+	}
+	sample_head = 0;
+	sample_total = 0;
+	sample_rate = rate;
+	running = true;
+	ret = arch_profile_start(rate);
+	if (ret)
+		running = false;
+
+	return ret;
+}
+
+void profile_stop(void)
+{
+	if (!running)
+		return;
+	arch_profile_stop();
+	running = false;
+}
+
+void profile_get_stats(struct profile_stats *stats)
+{
+	stats->rate = sample_rate;
+	stats->total = sample_total;
+	stats->count = min(sample_total, (ulong)sample_size);
+	stats->size = sample_size;
+	stats->running = running;
+}
+
+/* Convert a program counter to an offset from the start of the code */
+static ulong profile_pc_to_offset(ulong pc)
+{
+#ifdef CONFIG_SANDBOX
+	return pc - (ulong)&_init;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		return pc - gd->relocaddr;
+	return pc - CONFIG_SYS_TEXT_BASE;
+#endif
+}
+
+/* Convert a program counter to the address it has in the symbol table */
+static ulong profile_pc_to_link(ulong pc)
+{
+#ifdef CONFIG_SANDBOX
+	/* Sandbox is position-independent and linked at address 0 */
+	return pc - (ulong)__executable_start;
+#else
+	if (gd->flags & GD_FLG_RELOC)
+		return pc - gd->reloc_off;
+	return pc;
+#endif
+}
+
+static int h_cmp_addr(const void *v1, const void *v2)
+{
+	const struct profile_count *c1 = v1, *c2 = v2;
+
+	return c1->addr < c2->addr ? -1 : c1->addr > c2->addr;
+}
+
+static int h_cmp_count(const void *v1, const void *v2)
+{
+	const struct profile_count *c1 = v1, *c2 = v2;
+
+	if (c1->count != c2->count)
+		return c1->count < c2->count ? 1 : -1;
+	return h_cmp_addr(v1, v2);
+}
+
+void profile_report(int max_lines)
+{
+	struct profile_count *counts, *out;
+	struct profile_stats stats;
+	int num_addrs;
+	uint i;
+
+	profile_get_stats(&stats);
+	printf("%lu samples at %u Hz%s", stats.total, stats.rate,
+	       stats.running ? " (running)" : "");
+	if (stats.total > stats.count)
+		printf(", %u most recent shown", stats.count);
+	printf("\n");
+	if (!stats.count)
+		return;
+
+	counts = malloc(stats.count * sizeof(*counts));
+	if (!counts) {
+		printf("Out of memory\n");
+		return;
+	}
+	for (i = 0; i < stats.count; i++) {
+		counts[i].addr = profile_pc_to_link(samples[i]);
+		counts[i].count = 1;
+	}
+
+	/* Merge samples at the same address, then put the busiest first */
+	qsort(counts, stats.count, sizeof(*counts), h_cmp_addr);
+	for (i = 1, out = counts; i < stats.count; i++) {
+		if (counts[i].addr == out->addr)
+			out->count++;
+		else
+			*++out = counts[i];
+	}
+	num_addrs = out - counts + 1;
+	qsort(counts, num_addrs, sizeof(*counts), h_cmp_count);
+
+	printf("%8s %6s  %s\n", "Samples", "%", "Address");
+	for (i = 0; i < min(num_addrs, max_lines); i++) {
+		uint pct = counts[i].count * 1000 / stats.count;
+
+		printf("%8u %4u.%u  %0*lx\n", counts[i].count, pct / 10,
+		       pct % 10, 2 * (int)sizeof(ulong), counts[i].addr);
+	}
+	free(counts);
+}
+
+int profile_dump(void *buf, int size, int *needed)
+{
+	struct trace_output_hdr *hdr = buf;
+	struct profile_stats stats;
+	uint32_t *out;
+	uint i, count;
+
+	profile_get_stats(&stats);
+	*needed = sizeof(*hdr) + stats.count * sizeof(uint32_t);
+	if (size < sizeof(*hdr))
+		return -ENOSPC;
+	count = min(stats.count, (uint)((size - sizeof(*hdr)) /
+					sizeof(uint32_t)));
+	hdr->type = TRACE_CHUNK_SAMPLES;
+	hdr->rec_count = count;
+
+	/* Oldest first, so that a truncated dump has the earliest samples */
+	out = (uint32_t *)(hdr + 1);
+	for (i = 0; i < count; i++) {
+		uint pos = stats.total > stats.size ?
+			(sample_head + i) % stats.size : i;
+
+		out[i] = profile_pc_to_offset(samples[pos]);
+	}
+
+	return count < stats.count ? -ENOSPC : 0;
+}
@@ -425,6 +425,14 @@ char *strswab(const char *s)
 }
 #endif
 
+/*
+ * The memory functions below move whole words once the destination is
+ * aligned, and only fall back to bytes for the ends of the area. Areas
+ * shorter than two words are not worth the setup.
+ */
+#define WSIZE		sizeof(unsigned long)
+#define WMASK		(WSIZE - 1)
+
 #ifndef __HAVE_ARCH_MEMSET
 /**
  * memset - Fill a region of memory with the given value
@@ -436,26 +444,36 @@ char *strswab(const char *s)
  */
 void * memset(void * s,int c,size_t count)
 {
-	unsigned long *sl = (unsigned long *) s;
-	char *s8;
+	unsigned long *sl;
+	char *s8 = s;
 
 #if !CONFIG_IS_ENABLED(TINY_MEMSET)
-	unsigned long cl = 0;
-	int i;
-
-	/* do it one word at a time (32 bits or 64 bits) while possible */
-	if ( ((ulong)s & (sizeof(*sl) - 1)) == 0) {
-		for (i = 0; i < sizeof(*sl); i++) {
-			cl <<= 8;
-			cl |= c & 0xff;
+	unsigned long cl = (unsigned char)c;
+
+	if (count >= 2 * WSIZE) {
+		cl |= cl << 8;
+		cl |= cl << 16;
+		if (WSIZE > 4)
+			cl |= (cl << 16) << 16;
+
+		while ((ulong)s8 & WMASK) {
+			*s8++ = c;
+			count--;
 		}
-		while (count >= sizeof(*sl)) {
-			*sl++ = cl;
-			count -= sizeof(*sl);
+
+		/* fill 4 words at a time (16 or 32 bytes), then single words */
+		sl = (unsigned long *)s8;
+		for (; count >= 4 * WSIZE; count -= 4 * WSIZE, sl += 4) {
+			sl[0] = cl;
+			sl[1] = cl;
+			sl[2] = cl;
+			sl[3] = cl;
 		}
+		for (; count >= WSIZE; count -= WSIZE)
+			*sl++ = cl;
+		s8 = (char *)sl;
 	}
 #endif	/* fill 8 bits at a time */
-	s8 = (char *)sl;
 	while (count--)
 		*s8++ = c;
 
@@ -463,6 +481,82 @@ void * memset(void * s,int c,size_t count)
 }
 #endif
 
+#if !defined(__HAVE_ARCH_MEMCPY) || !defined(__HAVE_ARCH_MEMMOVE)
+#ifndef CONFIG_SPL_BUILD
+/*
+ * Copy @words words to the aligned @dl from the unaligned @s8, building each
+ * one from the two aligned source words it straddles. Only aligned words
+ * holding at least one source byte are read.
+ */
+static void copy_words_shifted(unsigned long *dl, const char *s8,
+			       size_t words)
+{
+	unsigned int shift = 8 * ((ulong)s8 & WMASK);
+	const unsigned long *sl = (const unsigned long *)((ulong)s8 & ~WMASK);
+	unsigned long a = *sl++, b;
+
+	while (words--) {
+		b = *sl++;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		*dl++ = (a << shift) | (b >> (8 * WSIZE - shift));
+#else
+		*dl++ = (a >> shift) | (b << (8 * WSIZE - shift));
+#endif
+		a = b;
+	}
+}
+#endif
+
+/*
+ * Copy from the lowest address up. Every source word is read before the
+ * destination word at the same position is written, so this is also fine
+ * for overlapping areas with @dest below @src.
+ */
+static void copy_forward(void *dest, const void *src, size_t count)
+{
+	unsigned long *dl;
+	const unsigned long *sl;
+	char *d8 = dest;
+	const char *s8 = src;
+
+	if (count >= 2 * WSIZE) {
+		while ((ulong)d8 & WMASK) {
+			*d8++ = *s8++;
+			count--;
+		}
+
+		dl = (unsigned long *)d8;
+		if (!((ulong)s8 & WMASK)) {
+			sl = (const unsigned long *)s8;
+			for (; count >= 4 * WSIZE; count -= 4 * WSIZE) {
+				dl[0] = sl[0];
+				dl[1] = sl[1];
+				dl[2] = sl[2];
+				dl[3] = sl[3];
+				dl += 4;
+				sl += 4;
+			}
+			for (; count >= WSIZE; count -= WSIZE)
+				*dl++ = *sl++;
+			d8 = (char *)dl;
+			s8 = (const char *)sl;
+		}
+#ifndef CONFIG_SPL_BUILD
+		else {
+			copy_words_shifted(dl, s8, count / WSIZE);
+			d8 += count & ~WMASK;
+			s8 += count & ~WMASK;
+			count &= WMASK;
+		}
+#endif
+	}
+
+	/* copy the rest one byte at a time */
+	while (count--)
+		*d8++ = *s8++;
+}
+#endif
+
 #ifndef __HAVE_ARCH_MEMCPY
 /**
  * memcpy - Copy one area of memory to another
@@ -475,24 +569,8 @@ void * memset(void * s,int c,size_t count)
  */
 void * memcpy(void *dest, const void *src, size_t count)
 {
-	unsigned long *dl = (unsigned long *)dest, *sl = (unsigned long *)src;
-	char *d8, *s8;
-
-	if (src == dest)
-		return dest;
-
-	/* while all data is aligned (common case), copy a word at a time */
-	if ( (((ulong)dest | (ulong)src) & (sizeof(*dl) - 1)) == 0) {
-		while (count >= sizeof(*dl)) {
-			*dl++ = *sl++;
-			count -= sizeof(*dl);
-		}
-	}
-	/* copy the reset one byte at a time */
-	d8 = (char *)dl;
-	s8 = (char *)sl;
-	while (count--)
-		*d8++ = *s8++;
+	if (src != dest)
+		copy_forward(dest, src, count);
 
 	return dest;
 }
@@ -509,23 +587,35 @@ void * memcpy(void *dest, const void *src, size_t count)
  */
 void * memmove(void * dest,const void *src,size_t count)
 {
+	unsigned long *dl;
+	const unsigned long *sl;
 	char *tmp, *s;
 
 	if (src == dest)
 		return dest;
 
-	if (dest <= src) {
-		tmp = (char *) dest;
-		s = (char *) src;
-		while (count--)
-			*tmp++ = *s++;
-		}
-	else {
-		tmp = (char *) dest + count;
-		s = (char *) src + count;
-		while (count--)
+	if (dest < src || (char *)dest >= (char *)src + count) {
+		copy_forward(dest, src, count);
+		return dest;
+	}
+
+	/* overlapping with dest above src: copy from the end down */
+	tmp = (char *) dest + count;
+	s = (char *) src + count;
+	if (count >= 2 * WSIZE && !(((ulong)tmp ^ (ulong)s) & WMASK)) {
+		while ((ulong)tmp & WMASK) {
 			*--tmp = *--s;
+			count--;
 		}
+		dl = (unsigned long *)tmp;
+		sl = (const unsigned long *)s;
+		for (; count >= WSIZE; count -= WSIZE)
+			*--dl = *--sl;
+		tmp = (char *)dl;
+		s = (char *)sl;
+	}
+	while (count--)
+		*--tmp = *--s;
 
 	return dest;
 }
@@ -540,10 +630,25 @@ void * memmove(void * dest,const void *src,size_t count)
  */
 int memcmp(const void * cs,const void * ct,size_t count)
 {
-	const unsigned char *su1, *su2;
+	const unsigned char *su1 = cs, *su2 = ct;
+	const unsigned long *l1, *l2;
 	int res = 0;
 
-	for( su1 = cs, su2 = ct; 0 < count; ++su1, ++su2, count--)
+	/* skip equal words while both areas are aligned alike */
+	if (count >= 2 * WSIZE && !(((ulong)su1 ^ (ulong)su2) & WMASK)) {
+		for (; (ulong)su1 & WMASK; ++su1, ++su2, count--)
+			if (*su1 != *su2)
+				return *su1 - *su2;
+
+		l1 = (const unsigned long *)su1;
+		l2 = (const unsigned long *)su2;
+		for (; count >= WSIZE && *l1 == *l2; l1++, l2++)
+			count -= WSIZE;
+		su1 = (const unsigned char *)l1;
+		su2 = (const unsigned char *)l2;
+	}
+
+	for (; 0 < count; ++su1, ++su2, count--)
 		if ((res = *su1 - *su2) != 0)
 			break;
 	return res;
@@ -149,6 +149,7 @@ void udelay(unsigned long usec)
 
 	do {
 		WATCHDOG_RESET();
+		serial_tx_poll();
 		kv = usec > CONFIG_WD_PERIOD ? CONFIG_WD_PERIOD : usec;
 		__udelay (kv);
 		usec -= kv;
@@ -50,6 +50,27 @@ static int do_ut_cmd(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	assert(!strcmp("1", getenv("black")));
 	assert(getenv("adder") != NULL);
 	assert(!strcmp("2", getenv("adder")));
+
+	/* running a variable again must see its new value */
+	run_command("setenv foo 'setenv black 3'", 0);
+	run_command("run foo", 0);
+	assert(!strcmp("3", getenv("black")));
+
+	/* a loop which is left early can still be run again */
+	run_command("setenv foo 'for i in 1 2 3; do setenv black ${i}; "
+		    "if test ${i} = 2; then exit; fi; done'", 0);
+	assert(run_command("run foo; run foo", 0) == 0);
+	assert(!strcmp("2", getenv("black")));
+	assert(run_command("run foo", 0) == 0);
+	assert(!strcmp("2", getenv("black")));
+
+	/* a script which runs itself must not disturb the outer run */
+	run_command("setenv n 0; setenv black", 0);
+	run_command("setenv foo 'for p in a b; do setenv black ${black}${p}; "
+		    "if test ${n} = 0; then setenv n 1; run foo; fi; done'", 0);
+	run_command("run foo", 0);
+	assert(!strcmp("aabb", getenv("black")));
+	run_command("setenv n", 0);
 #endif
 
 	assert(run_command("", 0) == 0);
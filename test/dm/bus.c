@@ -6,6 +6,7 @@
 
 #include <common.h>
 #include <dm.h>
+#include <malloc.h>
 #include <dm/device-internal.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
@@ -519,3 +520,43 @@ static int dm_test_bus_child_pre_probe_uclass(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_bus_child_pre_probe_uclass,
 	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_BOOTSTAGE_SPANS
+/* Test that probing a device records a span for it */
+static int dm_test_bus_probe_spans(struct unit_test_state *uts)
+{
+	struct udevice *bus;
+	char expect[40];
+	char *buf, *ptr;
+	int span;
+	int len;
+
+	/* Boot and earlier tests may have used up the span table */
+	bootstage_span_reset();
+	span = bootstage_span_start(BOOTSTAGE_SPAN_OTHER, "dm_test");
+	ut_assert(span >= 0);
+	ut_assertok(uclass_get_device(UCLASS_TEST_BUS, 0, &bus));
+	bootstage_span_end(span);
+
+	len = bootstage_span_json(NULL, 0);
+	buf = malloc(len + 1);
+	ut_assertnonnull(buf);
+	ut_asserteq(len, bootstage_span_json(buf, len + 1));
+	ut_asserteq('\0', buf[len]);
+
+	/* The probe span is nested inside ours, so follows it */
+	ptr = strstr(buf, "{\"name\":\"dm_test\",\"cat\":\"other\"");
+	ut_assertnonnull(ptr);
+	snprintf(expect, sizeof(expect), "{\"name\":\"%s\",\"cat\":\"dm\"",
+		 bus->name);
+	ut_assertnonnull(strstr(ptr, expect));
+
+	/* A short buffer is truncated but still terminated */
+	ut_asserteq(len, bootstage_span_json(buf, 10));
+	ut_asserteq(9, strlen(buf));
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_bus_probe_spans, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
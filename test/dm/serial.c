@@ -0,0 +1,75 @@
+/*
+ * Tests for the serial uclass
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <serial.h>
+#include <asm/test.h>
+#include <dm/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static int serial_tx_check(struct unit_test_state *uts, struct udevice *dev,
+			   char *buf, int size)
+{
+	/* While the uart is full, output waits in the buffer */
+	sandbox_serial_set_busy(dev, -1);
+	serial_puts("one\n");
+	ut_asserteq_str("", buf);
+
+	/* It comes out in order once there is room */
+	sandbox_serial_set_busy(dev, 0);
+	serial_putc('2');
+	ut_asserteq_str("one\r\n2", buf);
+
+	/* Flushing writes everything out, then output is not buffered */
+	sandbox_serial_capture(dev, buf, size);
+	sandbox_serial_set_busy(dev, -1);
+	serial_puts("three");
+	ut_asserteq_str("", buf);
+	sandbox_serial_set_busy(dev, 0);
+	serial_tx_flush();
+	ut_asserteq_str("three", buf);
+	sandbox_serial_set_busy(dev, 2);
+	serial_putc('4');
+	ut_asserteq_str("three4", buf);
+
+	/* The buffer is kept, and used again once output is resumed */
+	serial_tx_resume();
+	sandbox_serial_set_busy(dev, 1);
+	serial_putc('5');
+	ut_asserteq_str("three4", buf);
+	serial_tx_poll();
+	ut_asserteq_str("three45", buf);
+
+	return 0;
+}
+
+/* Test that output is buffered while the uart is busy */
+static int dm_test_serial_tx_buffer(struct unit_test_state *uts)
+{
+	struct udevice *dev, *old;
+	char buf[40];
+	int ret;
+
+	ut_assertok(uclass_get_device(UCLASS_SERIAL, 0, &dev));
+
+	/* Console output still goes to the stdio device, not this one */
+	old = gd->cur_serial_dev;
+	gd->cur_serial_dev = dev;
+	sandbox_serial_capture(dev, buf, sizeof(buf));
+	ret = serial_tx_check(uts, dev, buf, sizeof(buf));
+	sandbox_serial_set_busy(dev, 0);
+	sandbox_serial_capture(dev, NULL, 0);
+	serial_tx_resume();
+	gd->cur_serial_dev = old;
+
+	return ret;
+}
+DM_TEST(dm_test_serial_tx_buffer, DM_TESTF_SCAN_FDT);
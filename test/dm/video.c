@@ -12,6 +12,7 @@
 #include <os.h>
 #include <video.h>
 #include <video_console.h>
+#include <asm/unaligned.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <test/ut.h>
@@ -235,6 +236,130 @@ static int dm_test_video_rotation3(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_rotation3, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+/* Forget what has been written so far, without syncing it */
+static void clear_damage(struct video_priv *priv)
+{
+	priv->damage_xstart = priv->xsize;
+	priv->damage_ystart = priv->ysize;
+	priv->damage_xend = 0;
+	priv->damage_yend = 0;
+}
+
+/**
+ * check_damage() - Check that console output is within the damaged area
+ *
+ * This writes enough lines to scroll the console, checking after each
+ * character that all pixels which changed are within the area recorded by
+ * video_damage(), so that video_sync() does not miss them.
+ *
+ * @uts:	Test state
+ * @rot:	Console rotation (0, 90, 180, 270)
+ * @drv_name:	Console driver to use, NULL for the default
+ * @return 0 on success
+ */
+static int check_damage(struct unit_test_state *uts, int rot,
+			const char *drv_name)
+{
+	struct sandbox_sdl_plat *plat;
+	struct udevice *dev, *con;
+	struct video_priv *priv;
+	u16 *fb, *old;
+	int i, x, y;
+
+	ut_assertok(uclass_find_device(UCLASS_VIDEO, 0, &dev));
+	ut_assert(!device_active(dev));
+	plat = dev_get_platdata(dev);
+	plat->rot = rot;
+	plat->vidconsole_drv_name = drv_name;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	fb = priv->fb;
+	old = malloc(priv->fb_size);
+	ut_assertnonnull(old);
+
+	for (i = 0; i < 3 * 100; i++) {
+		memcpy(old, fb, priv->fb_size);
+		clear_damage(priv);
+		vidconsole_put_char(con, i % 3 == 2 ? '\n' : 'A' + i % 50);
+		for (y = 0; y < priv->ysize; y++) {
+			for (x = 0; x < priv->xsize; x++) {
+				if (fb[y * priv->xsize + x] ==
+				    old[y * priv->xsize + x])
+					continue;
+				ut_assert(x >= priv->damage_xstart);
+				ut_assert(x < priv->damage_xend);
+				ut_assert(y >= priv->damage_ystart);
+				ut_assert(y < priv->damage_yend);
+			}
+		}
+	}
+	free(old);
+
+	return 0;
+}
+
+/* Test that the console records what it writes */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+
+	ut_assertok(check_damage(uts, 0, "vidconsole0"));
+
+	/* A character only damages its own cell */
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	clear_damage(priv);
+	vidconsole_putc_xy(con, VID_TO_POS(16), 32, 'a');
+	ut_asserteq(16, priv->damage_xstart);
+	ut_asserteq(32, priv->damage_ystart);
+	ut_asserteq(24, priv->damage_xend);
+	ut_asserteq(48, priv->damage_yend);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test that the rotated consoles record what they write */
+static int dm_test_video_damage_rotation1(struct unit_test_state *uts)
+{
+	ut_assertok(check_damage(uts, 1, NULL));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage_rotation1,
+	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+static int dm_test_video_damage_rotation2(struct unit_test_state *uts)
+{
+	ut_assertok(check_damage(uts, 2, NULL));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage_rotation2,
+	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+static int dm_test_video_damage_rotation3(struct unit_test_state *uts)
+{
+	ut_assertok(check_damage(uts, 3, NULL));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage_rotation3,
+	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test that the TrueType console records what it writes */
+static int dm_test_video_damage_truetype(struct unit_test_state *uts)
+{
+	ut_assertok(check_damage(uts, 0, NULL));
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage_truetype, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 /* Read a file into memory and return a pointer to it */
 static int read_file(struct unit_test_state *uts, const char *fname,
 		     ulong *addrp)
@@ -289,6 +414,58 @@ static int dm_test_video_bmp_comp(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_bmp_comp, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+#ifdef CONFIG_VIDEO_BMP_GZIP
+/* Read a bitmap file and gzip it, returning the address of the result */
+static int read_file_gzip(struct unit_test_state *uts, const char *fname,
+			  ulong *addrp)
+{
+	const ulong gz_addr = 0x200000;
+	ulong addr, len = 100000;
+	void *buf;
+
+	ut_assertok(read_file(uts, fname, &addr));
+	buf = map_sysmem(addr, 0);
+	ut_assertok(gzip(map_sysmem(gz_addr, len), &len, buf,
+			 get_unaligned_le32(buf + 2)));
+	*addrp = gz_addr;
+
+	return 0;
+}
+
+/* Test drawing a gzipped bitmap file, which is decompressed row by row */
+static int dm_test_video_bmp_gzip(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	ulong addr;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(read_file_gzip(uts, "tools/logos/denx.bmp", &addr));
+
+	ut_assertok(video_bmp_display(dev, addr, 0, 0, false));
+	ut_asserteq(1368, compress_frame_buffer(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_bmp_gzip, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/* Test drawing a gzipped RLE8 bitmap file */
+static int dm_test_video_bmp_gzip_comp(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	ulong addr;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(read_file_gzip(uts, "tools/logos/denx-comp.bmp", &addr));
+
+	ut_assertok(video_bmp_display(dev, addr, 0, 0, false));
+	ut_asserteq(1368, compress_frame_buffer(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_video_bmp_gzip_comp, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#endif
+
 /* Test TrueType console */
 static int dm_test_video_truetype(struct unit_test_state *uts)
 {
@@ -300,7 +477,9 @@ static int dm_test_video_truetype(struct unit_test_state *uts)
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	for (s = test_string; *s; s++)
 		vidconsole_put_char(con, *s);
-	ut_asserteq(12619, compress_frame_buffer(dev));
+	/* The cache renders characters at quarter-pixel positions */
+	ut_asserteq(IS_ENABLED(CONFIG_CONSOLE_TRUETYPE_CACHE) ? 9735 : 12619,
+		    compress_frame_buffer(dev));
 
 	return 0;
 }
@@ -323,7 +502,9 @@ static int dm_test_video_truetype_scroll(struct unit_test_state *uts)
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	for (s = test_string; *s; s++)
 		vidconsole_put_char(con, *s);
-	ut_asserteq(33849, compress_frame_buffer(dev));
+	/* The cache renders characters at quarter-pixel positions */
+	ut_asserteq(IS_ENABLED(CONFIG_CONSOLE_TRUETYPE_CACHE) ? 29118 : 33849,
+		    compress_frame_buffer(dev));
 
 	return 0;
 }
@@ -346,8 +527,47 @@ static int dm_test_video_truetype_bs(struct unit_test_state *uts)
 	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
 	for (s = test_string; *s; s++)
 		vidconsole_put_char(con, *s);
-	ut_asserteq(34871, compress_frame_buffer(dev));
+	/* The cache renders characters at quarter-pixel positions */
+	ut_asserteq(IS_ENABLED(CONFIG_CONSOLE_TRUETYPE_CACHE) ? 30111 : 34871,
+		    compress_frame_buffer(dev));
 
 	return 0;
 }
 DM_TEST(dm_test_video_truetype_bs, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_CONSOLE_TRUETYPE_CACHE
+/* Test the TrueType character cache */
+static int dm_test_video_truetype_cache(struct unit_test_state *uts)
+{
+	const char *test_string = "Criticism may not be agreeable, but it is necessary.\n";
+	struct console_tt_cache_stats stats;
+	struct udevice *dev, *con;
+	int i, drawn = 0;
+	const char *s;
+	ulong misses;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	for (i = 0; i < 10; i++) {
+		for (s = test_string; *s; s++, drawn++)
+			vidconsole_put_char(con, *s);
+		drawn--;
+	}
+	ut_assertok(console_truetype_get_cache_stats(con, &stats));
+	ut_asserteq(drawn, stats.hits + stats.misses);
+	ut_assert(stats.hits >= 9 * stats.misses);
+	ut_asserteq(stats.misses - stats.evictions, stats.glyphs);
+	ut_assert(stats.glyphs <= CONFIG_CONSOLE_TRUETYPE_CACHE_SIZE);
+	ut_assert(stats.bytes > 0);
+
+	/* Every line starts at the left, so nothing new is rendered */
+	misses = stats.misses;
+	for (s = test_string; *s; s++)
+		vidconsole_put_char(con, *s);
+	ut_assertok(console_truetype_get_cache_stats(con, &stats));
+	ut_asserteq(misses, stats.misses);
+
+	return 0;
+}
+DM_TEST(dm_test_video_truetype_cache, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
@@ -87,3 +87,70 @@ static int env_test_attrs_lookup_regex(struct unit_test_state *uts)
 }
 ENV_TEST(env_test_attrs_lookup_regex, 0);
 #endif
+
+static unsigned long attr_to_value(const char *attributes)
+{
+	return simple_strtoul(attributes, NULL, 10);
+}
+
+static int env_test_attrs_map(struct unit_test_state *uts)
+{
+	const char * const lists[] = {
+		"foo:1,bar:2,baz",
+		" bar : 3 ,goo:4,,",
+	};
+	struct env_attr_map map = { 0 };
+	unsigned long value;
+
+	ut_assertok(env_attr_map_build(&map, lists, ARRAY_SIZE(lists),
+				       attr_to_value));
+
+	ut_assertok(env_attr_map_lookup(&map, "foo", &value));
+	ut_asserteq(1, value);
+	ut_assertok(env_attr_map_lookup(&map, "bar", &value));
+	ut_asserteq(3, value);
+	ut_assertok(env_attr_map_lookup(&map, "baz", &value));
+	ut_asserteq(0, value);
+	ut_assertok(env_attr_map_lookup(&map, "goo", &value));
+	ut_asserteq(4, value);
+	ut_asserteq(-ENOENT, env_attr_map_lookup(&map, "fo", &value));
+	ut_asserteq(-ENOENT, env_attr_map_lookup(&map, "food", &value));
+
+	env_attr_map_free(&map);
+	ut_asserteq(-ENOENT, env_attr_map_lookup(&map, "foo", &value));
+
+	return 0;
+}
+ENV_TEST(env_test_attrs_map, 0);
+
+#ifdef CONFIG_REGEX
+static int env_test_attrs_map_regex(struct unit_test_state *uts)
+{
+	const char * const lists[] = {
+		"\\.foo:1,foo\\d?:2,foo3:3",
+		"foo2:4",
+	};
+	struct env_attr_map map = { 0 };
+	unsigned long value;
+
+	ut_assertok(env_attr_map_build(&map, lists, ARRAY_SIZE(lists),
+				       attr_to_value));
+
+	ut_assertok(env_attr_map_lookup(&map, ".foo", &value));
+	ut_asserteq(1, value);
+	ut_asserteq(-ENOENT, env_attr_map_lookup(&map, "ufoo", &value));
+	ut_assertok(env_attr_map_lookup(&map, "foo", &value));
+	ut_asserteq(2, value);
+	ut_assertok(env_attr_map_lookup(&map, "foo1", &value));
+	ut_asserteq(2, value);
+	ut_assertok(env_attr_map_lookup(&map, "foo2", &value));
+	ut_asserteq(4, value);
+	ut_assertok(env_attr_map_lookup(&map, "foo3", &value));
+	ut_asserteq(3, value);
+
+	env_attr_map_free(&map);
+
+	return 0;
+}
+ENV_TEST(env_test_attrs_map_regex, 0);
+#endif
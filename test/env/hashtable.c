@@ -0,0 +1,89 @@
+/*
+ * Tests for the environment hash table
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <search.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+static const char htab_env1[] = "c=3\0a=1\0b=2\0";
+static const char htab_env2[] = "d=4\0b=2\0c=30\0";
+
+static int htab_export(struct hsearch_data *htab, char *buf, size_t size)
+{
+	return hexport_r(htab, ' ', 0, &buf, size, 0, NULL);
+}
+
+static int env_test_htab_export_sorted(struct unit_test_state *uts)
+{
+	struct hsearch_data htab = { 0 };
+	char buf[64];
+	ENTRY e, *ep;
+
+	ut_assert(himport_r(&htab, htab_env1, sizeof(htab_env1), '\0', 0, 0,
+			    0, NULL));
+	ut_assert(htab_export(&htab, buf, sizeof(buf)) > 0);
+	ut_asserteq_str("a=1 b=2 c=3 ", buf);
+
+	/* New entries must be merged into the remembered order */
+	e.key = "bb";
+	e.data = "5";
+	ut_assert(hsearch_r(e, ENTER, &ep, &htab, 0));
+	e.key = "0";
+	ut_assert(hsearch_r(e, ENTER, &ep, &htab, 0));
+	ut_assert(hdelete_r("a", &htab, 0));
+	ut_assert(htab_export(&htab, buf, sizeof(buf)) > 0);
+	ut_asserteq_str("0=5 b=2 bb=5 c=3 ", buf);
+
+	/* A freed slot can be reused by a key sorting elsewhere */
+	ut_assert(hdelete_r("c", &htab, 0));
+	e.key = "00";
+	ut_assert(hsearch_r(e, ENTER, &ep, &htab, 0));
+	ut_assert(htab_export(&htab, buf, sizeof(buf)) > 0);
+	ut_asserteq_str("0=5 00=5 b=2 bb=5 ", buf);
+
+	hdestroy_r(&htab);
+
+	return 0;
+}
+ENV_TEST(env_test_htab_export_sorted, 0);
+
+static int env_test_htab_import_merge(struct unit_test_state *uts)
+{
+	struct hsearch_data htab = { 0 };
+	char buf[64];
+	ENTRY e, *ep;
+	char *data;
+
+	ut_assert(himport_r(&htab, htab_env1, sizeof(htab_env1), '\0', 0, 0,
+			    0, NULL));
+	e.key = "b";
+	ut_assert(hsearch_r(e, FIND, &ep, &htab, 0));
+	data = ep->data;
+
+	ut_assert(himport_r(&htab, htab_env2, sizeof(htab_env2), '\0',
+			    H_MERGE, 0, 0, NULL));
+	ut_assert(htab_export(&htab, buf, sizeof(buf)) > 0);
+	ut_asserteq_str("b=2 c=30 d=4 ", buf);
+
+	/* The unchanged entry must have been kept as it was */
+	ut_assert(hsearch_r(e, FIND, &ep, &htab, 0));
+	ut_asserteq_ptr(data, ep->data);
+
+	/* Deleting an entry which was not imported yet */
+	ut_assert(himport_r(&htab, "b\0a=1\0", 6, '\0', H_MERGE, 0, 0, NULL));
+	ut_assert(htab_export(&htab, buf, sizeof(buf)) > 0);
+	ut_asserteq_str("a=1 ", buf);
+
+	hdestroy_r(&htab);
+
+	return 0;
+}
+ENV_TEST(env_test_htab_import_merge, 0);
@@ -0,0 +1,132 @@
+/*
+ * Tests for the BCH encoder/decoder
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <linux/bch.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+#define BCH_LEN		512
+
+struct bch_test {
+	struct bch_control *bch;
+	u8 data[BCH_LEN];
+	u8 ecc[32];
+	u8 rdata[BCH_LEN];
+	u8 recc[32];
+	unsigned int loc[32];
+	unsigned int errloc[32];
+	unsigned int seed;
+};
+
+static unsigned int bch_test_rand(struct bch_test *bt)
+{
+	bt->seed = bt->seed * 1103515245 + 12345;
+	return bt->seed >> 8;
+}
+
+/* Encode random data, then flip @nerr distinct bits of data or ecc */
+static void bch_test_prepare(struct bch_test *bt, int nerr)
+{
+	/* only whole ecc bytes, the padding bits are not decoded */
+	unsigned int nbits = 8 * BCH_LEN + (bt->bch->ecc_bits & ~7);
+	unsigned int p;
+	int i, j;
+
+	for (i = 0; i < BCH_LEN; i++)
+		bt->data[i] = bch_test_rand(bt);
+	memset(bt->ecc, 0, sizeof(bt->ecc));
+	encode_bch(bt->bch, bt->data, BCH_LEN, bt->ecc);
+
+	memcpy(bt->rdata, bt->data, BCH_LEN);
+	memcpy(bt->recc, bt->ecc, sizeof(bt->ecc));
+	for (i = 0; i < nerr; i++) {
+		do {
+			p = bch_test_rand(bt) % nbits;
+			for (j = 0; j < i && bt->loc[j] != p; j++)
+				;
+		} while (j < i);
+		bt->loc[i] = p;
+		if (p < 8 * BCH_LEN)
+			bt->rdata[p / 8] ^= 1 << (p % 8);
+		else
+			bt->recc[p / 8 - BCH_LEN] ^= 1 << (p % 8);
+	}
+}
+
+/* Check that the decoder reports exactly the flipped bits */
+static int bch_test_check(struct unit_test_state *uts, struct bch_test *bt,
+			  int nerr)
+{
+	int n, i, j;
+
+	n = decode_bch(bt->bch, bt->rdata, BCH_LEN, bt->recc, NULL, NULL,
+		       bt->errloc);
+	ut_asserteq(nerr, n);
+	for (i = 0; i < nerr; i++) {
+		for (j = 0; j < nerr && bt->errloc[j] != bt->loc[i]; j++)
+			;
+		ut_assert(j < nerr);
+	}
+
+	return 0;
+}
+
+static int bch_test_params(struct unit_test_state *uts, int m, int t)
+{
+	struct bch_test *bt;
+	uint16_t *syn_tab;
+	int nerr, round;
+
+	bt = calloc(1, sizeof(*bt));
+	ut_assertnonnull(bt);
+	bt->bch = init_bch(m, t, 0);
+	ut_assertnonnull(bt->bch);
+	bt->seed = m * 100 + t;
+
+	syn_tab = bt->bch->syn_tab;
+	for (round = 0; round < 20; round++) {
+		for (nerr = 0; nerr <= t; nerr++) {
+			bch_test_prepare(bt, nerr);
+			ut_assertok(bch_test_check(uts, bt, nerr));
+
+			/* The bitwise syndromes must agree with the tables */
+			bt->bch->syn_tab = NULL;
+			ut_assertok(bch_test_check(uts, bt, nerr));
+			bt->bch->syn_tab = syn_tab;
+		}
+	}
+
+	/* Errors reported through the XORed ecc only */
+	bch_test_prepare(bt, t);
+	memset(bt->ecc, 0, sizeof(bt->ecc));
+	encode_bch(bt->bch, bt->rdata, BCH_LEN, bt->ecc);
+	for (round = 0; round < bt->bch->ecc_bytes; round++)
+		bt->ecc[round] ^= bt->recc[round];
+	ut_asserteq(t, decode_bch(bt->bch, NULL, BCH_LEN, NULL, bt->ecc,
+				  NULL, bt->errloc));
+	memset(bt->ecc, 0, sizeof(bt->ecc));
+	ut_asserteq(0, decode_bch(bt->bch, NULL, BCH_LEN, NULL, bt->ecc,
+				  NULL, bt->errloc));
+
+	free_bch(bt->bch);
+	free(bt);
+
+	return 0;
+}
+
+static int lib_test_bch_decode(struct unit_test_state *uts)
+{
+	ut_assertok(bch_test_params(uts, 13, 4));
+	ut_assertok(bch_test_params(uts, 13, 8));
+	ut_assertok(bch_test_params(uts, 14, 16));
+
+	return 0;
+}
+LIB_TEST(lib_test_bch_decode, 0);
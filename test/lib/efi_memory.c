@@ -0,0 +1,93 @@
+/*
+ * Tests for the EFI memory map
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <efi_loader.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+enum {
+	EFI_TEST_PAGES	= 16,
+	EFI_TEST_POOLS	= 40,
+};
+
+static int efi_test_map_count(void)
+{
+	unsigned long size = 0;
+
+	efi_get_memory_map(&size, NULL, NULL, NULL, NULL);
+
+	return size / sizeof(struct efi_mem_desc);
+}
+
+/* Splitting and merging maps keeps the free sizes in the tree right */
+static int lib_test_efi_memory_merge(struct unit_test_state *uts)
+{
+	u64 page = EFI_PAGE_SIZE;
+	int count;
+	u64 base;
+
+	ut_assertok(efi_memory_check());
+	count = efi_test_map_count();
+	ut_asserteq(EFI_SUCCESS, efi_allocate_pages(0, EFI_LOADER_DATA,
+						    EFI_TEST_PAGES, &base));
+	ut_assertok(efi_memory_check());
+
+	/* Split the block into three, then merge it back */
+	ut_asserteq(base + 4 * page,
+		    efi_add_memory_map(base + 4 * page, 4,
+				       EFI_BOOT_SERVICES_DATA, false));
+	ut_assertok(efi_memory_check());
+	ut_asserteq(base + 4 * page,
+		    efi_add_memory_map(base + 4 * page, 4, EFI_LOADER_DATA,
+				       false));
+	ut_assertok(efi_memory_check());
+
+	/* Free the middle, then each end, so both neighbours are merged */
+	ut_asserteq(EFI_SUCCESS, efi_free_pages(base + 4 * page, 8));
+	ut_assertok(efi_memory_check());
+	ut_asserteq(EFI_SUCCESS, efi_free_pages(base + 12 * page, 4));
+	ut_assertok(efi_memory_check());
+	ut_asserteq(EFI_SUCCESS, efi_free_pages(base, 4));
+	ut_assertok(efi_memory_check());
+	ut_asserteq(count, efi_test_map_count());
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_memory_merge, 0);
+
+/* Small pool allocations share pages, which are given back when empty */
+static int lib_test_efi_memory_pool(struct unit_test_state *uts)
+{
+	void *ptrs[EFI_TEST_POOLS];
+	int count, i;
+
+	count = efi_test_map_count();
+	for (i = 0; i < EFI_TEST_POOLS; i++) {
+		/* Cover each size class and a few page allocations */
+		ut_asserteq(EFI_SUCCESS,
+			    efi_allocate_pool(EFI_LOADER_DATA, 1 + i * 100,
+					      &ptrs[i]));
+		memset(ptrs[i], i, 1 + i * 100);
+		ut_assertok(efi_memory_check());
+	}
+	for (i = 0; i < EFI_TEST_POOLS; i += 2) {
+		ut_asserteq(i, *(u8 *)ptrs[i]);
+		ut_asserteq(EFI_SUCCESS, efi_free_pool(ptrs[i]));
+		ut_assertok(efi_memory_check());
+	}
+	for (i = 1; i < EFI_TEST_POOLS; i += 2) {
+		ut_asserteq(i, *(u8 *)ptrs[i]);
+		ut_asserteq(EFI_SUCCESS, efi_free_pool(ptrs[i]));
+		ut_assertok(efi_memory_check());
+	}
+	ut_asserteq(count, efi_test_map_count());
+
+	return 0;
+}
+LIB_TEST(lib_test_efi_memory_pool, 0);
@@ -0,0 +1,183 @@
+/*
+ * Tests for the logical memory block allocator
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <lmb.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+#define RAM_BASE	0x40000000
+#define RAM_SIZE	0x08000000
+
+static int lib_test_lmb_simple(struct unit_test_state *uts)
+{
+	struct lmb lmb;
+	phys_addr_t a, b;
+
+	lmb_init(&lmb);
+	ut_assert(lmb_add(&lmb, RAM_BASE, RAM_SIZE) >= 0);
+
+	/* Allocations come from the top of memory */
+	a = lmb_alloc(&lmb, 0x1000, 0x1000);
+	ut_asserteq(RAM_BASE + RAM_SIZE - 0x1000, a);
+	b = lmb_alloc(&lmb, 0x1000, 0x1000);
+	ut_asserteq(a - 0x1000, b);
+
+	/* Both are merged into a single reserved region */
+	ut_asserteq(1, lmb.reserved.cnt);
+	ut_assert(lmb_is_reserved(&lmb, a));
+	ut_assert(lmb_is_reserved(&lmb, b + 0xfff));
+	ut_assert(!lmb_is_reserved(&lmb, b - 1));
+
+	/* Freeing the first leaves the second */
+	ut_assertok(lmb_free(&lmb, a, 0x1000));
+	ut_asserteq(1, lmb.reserved.cnt);
+	ut_assert(!lmb_is_reserved(&lmb, a));
+	ut_assert(lmb_is_reserved(&lmb, b));
+
+	/* Cannot free something which is not reserved */
+	ut_asserteq(-1, lmb_free(&lmb, a, 0x1000));
+
+	/* Nothing fits above max_addr */
+	ut_asserteq(0, __lmb_alloc_base(&lmb, 0x1000, 0x1000, RAM_BASE));
+	ut_asserteq(RAM_BASE, __lmb_alloc_base(&lmb, 0x1000, 0x1000,
+					       RAM_BASE + 0x1000));
+	lmb_release(&lmb);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_simple, 0);
+
+static int lib_test_lmb_merge(struct unit_test_state *uts)
+{
+	struct lmb lmb;
+
+	lmb_init(&lmb);
+	ut_assert(lmb_add(&lmb, RAM_BASE, RAM_SIZE) >= 0);
+
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x10000, 0x1000) >= 0);
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x30000, 0x1000) >= 0);
+	ut_asserteq(2, lmb.reserved.cnt);
+
+	/* The same region again changes nothing */
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x10000, 0x1000) >= 0);
+	ut_asserteq(2, lmb.reserved.cnt);
+
+	/* Adjacent to the first one */
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x11000, 0x1000) >= 0);
+	ut_asserteq(2, lmb.reserved.cnt);
+	ut_asserteq(RAM_BASE + 0x10000, lmb.reserved.region[0].base);
+	ut_asserteq(0x2000, lmb.reserved.region[0].size);
+
+	/* Overlapping both, so everything becomes one region */
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x11800, 0x20000) >= 0);
+	ut_asserteq(1, lmb.reserved.cnt);
+	ut_asserteq(RAM_BASE + 0x10000, lmb.reserved.region[0].base);
+	ut_asserteq(0x21800, lmb.reserved.region[0].size);
+
+	/* Freeing from the middle splits it again */
+	ut_assertok(lmb_free(&lmb, RAM_BASE + 0x20000, 0x1000));
+	ut_asserteq(2, lmb.reserved.cnt);
+	ut_asserteq(0x10000, lmb.reserved.region[0].size);
+	ut_asserteq(RAM_BASE + 0x21000, lmb.reserved.region[1].base);
+	ut_asserteq(0x10800, lmb.reserved.region[1].size);
+
+	/* A region which reaches the top of the address space */
+	ut_assert(lmb_add(&lmb, (phys_addr_t)-0x100000, 0x100000) >= 0);
+	ut_asserteq(2, lmb.memory.cnt);
+	ut_assert(lmb_reserve(&lmb, (phys_addr_t)-0x1000, 0x1000) >= 0);
+	ut_assert(lmb_is_reserved(&lmb, (phys_addr_t)-1));
+	ut_assert(lmb_alloc(&lmb, 0x1000, 0x1000) == (phys_addr_t)-0x2000);
+	ut_asserteq(3, lmb.reserved.cnt);
+	lmb_release(&lmb);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_merge, 0);
+
+static int lib_test_lmb_many(struct unit_test_state *uts)
+{
+	const unsigned long count = 4000;
+	struct lmb lmb;
+	unsigned long i;
+
+	lmb_init(&lmb);
+	ut_assert(lmb_add(&lmb, RAM_BASE, RAM_SIZE) >= 0);
+
+	/* Reserve every other page, working downwards */
+	for (i = count; i > 0; i--)
+		ut_assert(lmb_reserve(&lmb, RAM_BASE + (i - 1) * 0x2000,
+				      0x1000) >= 0);
+	ut_asserteq(count, lmb.reserved.cnt);
+	ut_assert(lmb.reserved.max >= count);
+
+	for (i = 1; i < count; i++)
+		ut_assert(lmb.reserved.region[i - 1].base <
+			  lmb.reserved.region[i].base);
+	ut_assert(lmb_is_reserved(&lmb, RAM_BASE + 0x2000 * 1234));
+	ut_assert(!lmb_is_reserved(&lmb, RAM_BASE + 0x2000 * 1234 + 0x1000));
+
+	/* Filling the gaps in the first half merges those regions */
+	for (i = 0; i < count / 2; i++)
+		ut_assert(lmb_reserve(&lmb, RAM_BASE + i * 0x2000 + 0x1000,
+				      0x1000) >= 0);
+	ut_asserteq(count / 2, lmb.reserved.cnt);
+	ut_asserteq(count * 0x1000 + 0x1000, lmb.reserved.region[0].size);
+
+	/* Free the second half again */
+	for (i = count / 2; i < count; i++)
+		ut_assertok(lmb_free(&lmb, RAM_BASE + i * 0x2000, 0x1000));
+	ut_asserteq(1, lmb.reserved.cnt);
+
+	/* An allocation below the reserved regions still works */
+	ut_asserteq(RAM_BASE + count * 0x2000 - 0x1000,
+		    __lmb_alloc_base(&lmb, 0x1000, 0x1000,
+				     RAM_BASE + count * 0x2000));
+	lmb_release(&lmb);
+	ut_asserteq_ptr(lmb.reserved.initial, lmb.reserved.region);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_many, 0);
+
+static int lib_test_lmb_best_fit(struct unit_test_state *uts)
+{
+	struct lmb lmb;
+
+	lmb_init(&lmb);
+	lmb.policy = LMB_ALLOC_BEST_FIT;
+	ut_assert(lmb_add(&lmb, RAM_BASE, RAM_SIZE) >= 0);
+
+	/* Leave free areas of 0x4000 and 0x2000 bytes at the bottom */
+	ut_assert(lmb_reserve(&lmb, RAM_BASE, 0x1000) >= 0);
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x5000, 0x1000) >= 0);
+	ut_assert(lmb_reserve(&lmb, RAM_BASE + 0x8000, 0x1000) >= 0);
+
+	/* The smallest area is used, from the top */
+	ut_asserteq(RAM_BASE + 0x7000, lmb_alloc(&lmb, 0x1000, 0x1000));
+	ut_asserteq(RAM_BASE + 0x6000, lmb_alloc(&lmb, 0x1000, 0x1000));
+	ut_asserteq(RAM_BASE + 0x4000, lmb_alloc(&lmb, 0x1000, 0x1000));
+
+	/* Does not fit in the remaining 0x3000 bytes */
+	ut_asserteq(RAM_BASE + RAM_SIZE - 0x4000,
+		    lmb_alloc(&lmb, 0x4000, 0x1000));
+
+	/* Alignment is taken into account */
+	ut_asserteq(RAM_BASE + RAM_SIZE - 0x20000,
+		    lmb_alloc(&lmb, 0x10000, 0x10000));
+
+	/* max_addr is respected */
+	ut_asserteq(RAM_BASE + 0x3000,
+		    __lmb_alloc_base(&lmb, 0x1000, 0x1000, RAM_BASE + 0x4000));
+	ut_asserteq(0, __lmb_alloc_base(&lmb, 0x4000, 0x1000,
+					RAM_BASE + 0x4000));
+	lmb_release(&lmb);
+
+	return 0;
+}
+LIB_TEST(lib_test_lmb_best_fit, 0);
@@ -0,0 +1,263 @@
+/*
+ * Tests for the malloc() heap
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <malloc_trace.h>
+#include <dm/device.h>
+#include <dm/root.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+#ifdef CONFIG_SYS_MALLOC_SLAB
+enum {
+	SLAB_TEST_COUNT	= 1000,
+};
+
+/* Small allocations come from the slab with their size rounded up */
+static int lib_test_malloc_slab(struct unit_test_state *uts)
+{
+	struct malloc_slab_info before, info;
+	char *ptr, *new;
+	int i;
+
+	malloc_slab_get_info(&before);
+	ptr = malloc(20);
+	ut_assertnonnull(ptr);
+	ut_asserteq(32, malloc_usable_size(ptr));
+	malloc_slab_get_info(&info);
+	ut_asserteq(before.cls[1].inuse + 1, info.cls[1].inuse);
+	ut_asserteq(before.cls[1].allocs + 1, info.cls[1].allocs);
+	ut_assert(info.pages > 0);
+	for (i = 0; i < 20; i++)
+		ptr[i] = i;
+
+	/* Growing within the object keeps it in place */
+	ut_asserteq_ptr(ptr, realloc(ptr, 32));
+
+	/* Growing beyond the largest size class moves it to the main heap */
+	new = realloc(ptr, 1000);
+	ut_assertnonnull(new);
+	ut_assert(new != ptr);
+	ut_assert(malloc_usable_size(new) >= 1000);
+	for (i = 0; i < 20; i++)
+		ut_asserteq(i, new[i]);
+	malloc_slab_get_info(&info);
+	ut_asserteq(before.cls[1].inuse, info.cls[1].inuse);
+	free(new);
+
+	/* calloc() clears an object that was used before */
+	ptr = malloc(100);
+	ut_assertnonnull(ptr);
+	memset(ptr, '\xff', 100);
+	free(ptr);
+	ptr = calloc(4, 25);
+	ut_assertnonnull(ptr);
+	ut_asserteq(128, malloc_usable_size(ptr));
+	for (i = 0; i < 100; i++)
+		ut_asserteq(0, ptr[i]);
+	free(ptr);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_slab, 0);
+
+/* Objects are packed together, so clearing one must not touch the next */
+static int lib_test_malloc_slab_bounds(struct unit_test_state *uts)
+{
+	char *ptrs[8];
+	int i, j;
+
+	for (i = 0; i < ARRAY_SIZE(ptrs); i++) {
+		ptrs[i] = malloc(16);
+		ut_assertnonnull(ptrs[i]);
+		memset(ptrs[i], i + 1, 16);
+	}
+
+	/* The object just freed is the next one handed out */
+	free(ptrs[4]);
+	ptrs[4] = calloc(1, 16);
+	ut_assertnonnull(ptrs[4]);
+	for (j = 0; j < 16; j++)
+		ut_asserteq(0, ptrs[4][j]);
+	memset(ptrs[4], 5, 16);
+	ptrs[4] = realloc(ptrs[4], 17);
+	ut_assertnonnull(ptrs[4]);
+
+	for (i = 0; i < ARRAY_SIZE(ptrs); i++) {
+		for (j = 0; j < 16; j++)
+			ut_asserteq(i + 1, ptrs[i][j]);
+		free(ptrs[i]);
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_slab_bounds, 0);
+
+/* Pages are taken as needed and given back when empty */
+static int lib_test_malloc_slab_pages(struct unit_test_state *uts)
+{
+	struct malloc_slab_info before, info;
+	void **ptrs;
+	int i;
+
+	ptrs = calloc(SLAB_TEST_COUNT, sizeof(*ptrs));
+	ut_assertnonnull(ptrs);
+	malloc_slab_get_info(&before);
+	for (i = 0; i < SLAB_TEST_COUNT; i++) {
+		ptrs[i] = malloc(64);
+		ut_assertnonnull(ptrs[i]);
+	}
+	malloc_slab_get_info(&info);
+	ut_asserteq(before.cls[3].inuse + SLAB_TEST_COUNT, info.cls[3].inuse);
+	ut_assert(info.cls[3].pages >=
+		  SLAB_TEST_COUNT * 64 / info.page_size);
+	ut_assert(info.free_pages < before.free_pages);
+
+	for (i = 0; i < SLAB_TEST_COUNT; i++)
+		free(ptrs[i]);
+	free(ptrs);
+	malloc_slab_get_info(&info);
+	ut_asserteq(before.cls[3].inuse, info.cls[3].inuse);
+	ut_assert(info.cls[3].pages <= max(before.cls[3].pages, 1U));
+	ut_assert(info.free_pages >= before.free_pages - 1);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_slab_pages, 0);
+#endif
+
+/* Freeing blocks between ones in use leaves holes in the heap */
+static int lib_test_malloc_frag(struct unit_test_state *uts)
+{
+	struct malloc_frag_info before, info;
+	void *ptrs[8];
+	ulong size;
+	uint chunks;
+	int i;
+
+	malloc_get_frag_info(&before);
+	ut_assert(before.free_bytes >= before.largest);
+	ut_assert(before.largest >= before.top_size);
+
+	/* Use blocks too large for any existing hole, so they come from top */
+	for (i = MALLOC_FRAG_BUCKETS - 1; i > 0 && !before.hist[i]; i--)
+		;
+	size = max(32UL << i, 1000UL);
+	for (i = 0; i < ARRAY_SIZE(ptrs); i++) {
+		ptrs[i] = malloc(size);
+		ut_assertnonnull(ptrs[i]);
+	}
+	for (i = 0; i < ARRAY_SIZE(ptrs); i += 2)
+		free(ptrs[i]);
+
+	/* Each hole is a separate free chunk, counted in the histogram */
+	malloc_get_frag_info(&info);
+	ut_asserteq(before.free_chunks + ARRAY_SIZE(ptrs) / 2, info.free_chunks);
+	for (i = 0, chunks = 0; i < MALLOC_FRAG_BUCKETS; i++)
+		chunks += info.hist[i];
+	ut_asserteq(info.free_chunks, chunks);
+	ut_assert(info.largest >= size);
+	ut_assert(info.free_bytes >=
+		  info.top_size + ARRAY_SIZE(ptrs) / 2 * size);
+
+	for (i = 1; i < ARRAY_SIZE(ptrs); i += 2)
+		free(ptrs[i]);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_frag, 0);
+
+#ifdef CONFIG_MALLOC_TRACE
+static const struct malloc_trace_scope *find_scope(const char *name)
+{
+	const struct malloc_trace_scope *scope;
+	int i;
+
+	for (i = 0; (scope = malloc_trace_get_scope(i)); i++) {
+		if (!strcmp(scope->name, name))
+			return scope;
+	}
+
+	return NULL;
+}
+
+/* Allocations are tracked until freed, and charged to the current scope */
+static int lib_test_malloc_trace(struct unit_test_state *uts)
+{
+	const struct malloc_trace_scope *scope;
+	struct malloc_trace_stats before, stats;
+	ulong bytes;
+	void *ptr;
+	uint mark;
+	int prev;
+
+	malloc_trace_get_stats(&before);
+	mark = malloc_trace_mark();
+	ptr = malloc(100);
+	ut_assertnonnull(ptr);
+	ut_asserteq(1, malloc_trace_outstanding(mark, NULL, false, &bytes));
+	ut_asserteq(100, bytes);
+
+	/* A resized allocation is not a new one */
+	ptr = realloc(ptr, 1000);
+	ut_assertnonnull(ptr);
+	ut_asserteq(1, malloc_trace_outstanding(mark, NULL, false, &bytes));
+	ut_asserteq(1000, bytes);
+	ut_asserteq(0, malloc_trace_outstanding(mark + 1, NULL, false, NULL));
+	free(ptr);
+	ut_asserteq(0, malloc_trace_outstanding(mark, NULL, false, NULL));
+
+	prev = malloc_trace_enter("lib_test");
+	ptr = calloc(5, 10);
+	malloc_trace_leave(prev);
+	ut_assertnonnull(ptr);
+	scope = find_scope("lib_test");
+	ut_assertnonnull(scope);
+	ut_asserteq(1, scope->count);
+	ut_asserteq(50, scope->bytes);
+	ut_assert(scope->peak >= 50);
+	ut_asserteq(1, malloc_trace_outstanding(0, "lib_test", false, NULL));
+	free(ptr);
+	ut_asserteq(0, scope->count);
+	ut_asserteq(0, scope->bytes);
+	ut_assert(scope->peak >= 50);
+
+	malloc_trace_get_stats(&stats);
+	ut_asserteq(before.count, stats.count);
+	ut_asserteq(before.bytes, stats.bytes);
+	ut_assert(stats.allocs >= before.allocs + 2);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_trace, 0);
+
+#ifdef CONFIG_DEVRES
+/* Device resources are counted separately */
+static int lib_test_malloc_trace_devres(struct unit_test_state *uts)
+{
+	struct malloc_trace_stats before, stats;
+	void *ptr;
+
+	malloc_trace_get_stats(&before);
+	ptr = devm_kmalloc(dm_root(), 64, 0);
+	ut_assertnonnull(ptr);
+	malloc_trace_get_stats(&stats);
+	ut_asserteq(before.devres_count + 1, stats.devres_count);
+	ut_assert(stats.devres_bytes >= before.devres_bytes + 64);
+
+	devm_kfree(dm_root(), ptr);
+	malloc_trace_get_stats(&stats);
+	ut_asserteq(before.devres_count, stats.devres_count);
+	ut_asserteq(before.devres_bytes, stats.devres_bytes);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_trace_devres, 0);
+#endif
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Tests for the sampling profiler
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <malloc.h>
+#include <profile.h>
+#include <trace.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+/* Keep the CPU busy for a while so that samples are taken */
+static void profile_test_spin(ulong msecs)
+{
+	ulong start = get_timer(0);
+
+	while (get_timer(start) < msecs)
+		;
+}
+
+static int lib_test_profile(struct unit_test_state *uts)
+{
+	struct trace_output_hdr *hdr;
+	struct profile_stats stats;
+	int needed, size;
+	ulong total;
+	void *buf;
+
+	ut_assertok(profile_start(2000, 0x10000));
+	profile_get_stats(&stats);
+	ut_assert(stats.running);
+	ut_asserteq(2000, stats.rate);
+	ut_asserteq(0x10000, stats.size);
+
+	profile_test_spin(200);
+	profile_stop();
+	profile_get_stats(&stats);
+	ut_assert(!stats.running);
+	ut_assert(stats.total > 0);
+	ut_asserteq(stats.total, stats.count);
+
+	/* No more samples are taken once stopped */
+	total = stats.total;
+	profile_test_spin(20);
+	profile_get_stats(&stats);
+	ut_asserteq(total, stats.total);
+
+	/* Too small a buffer gets the oldest samples */
+	size = sizeof(*hdr) + sizeof(uint32_t);
+	buf = malloc(sizeof(*hdr) + stats.count * sizeof(uint32_t));
+	ut_assertnonnull(buf);
+	ut_asserteq(stats.count > 1 ? -ENOSPC : 0,
+		    profile_dump(buf, size, &needed));
+	hdr = buf;
+	ut_asserteq(TRACE_CHUNK_SAMPLES, hdr->type);
+	ut_asserteq(1, hdr->rec_count);
+
+	ut_assertok(profile_dump(buf, needed, &needed));
+	ut_asserteq(sizeof(*hdr) + stats.count * sizeof(uint32_t), needed);
+	ut_asserteq(stats.count, hdr->rec_count);
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_profile, 0);
+
+/* Once the buffer is full the oldest samples are dropped */
+static int lib_test_profile_ring(struct unit_test_state *uts)
+{
+	struct profile_stats stats;
+
+	ut_assertok(profile_start(5000, 4));
+	profile_test_spin(100);
+	profile_stop();
+	profile_get_stats(&stats);
+	ut_assert(stats.total > 4);
+	ut_asserteq(4, stats.count);
+	ut_asserteq(4, stats.size);
+
+	return 0;
+}
+LIB_TEST(lib_test_profile_ring, 0);
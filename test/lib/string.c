@@ -0,0 +1,171 @@
+/*
+ * Tests for the generic memory functions
+ *
+ * Copyright (c) 2017 agent <agent@local>
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <test/lib.h>
+#include <test/ut.h>
+
+#define STR_BUF		256
+#define STR_ALIGN	8	/* offsets tried at each end */
+#define STR_LEN		100	/* longer than any unrolled loop */
+
+static void str_test_fill(u8 *buf, int len, unsigned int seed)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+/* Byte at a time versions to check against */
+static void ref_memmove(u8 *dest, const u8 *src, int len)
+{
+	u8 tmp[STR_BUF];
+	int i;
+
+	for (i = 0; i < len; i++)
+		tmp[i] = src[i];
+	for (i = 0; i < len; i++)
+		dest[i] = tmp[i];
+}
+
+static int ref_memcmp(const u8 *a, const u8 *b, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		if (a[i] != b[i])
+			return a[i] - b[i];
+	return 0;
+}
+
+static int lib_test_string_memcpy(struct unit_test_state *uts)
+{
+	u8 src[STR_BUF], dst[STR_BUF], exp[STR_BUF];
+	int sa, da, len;
+
+	str_test_fill(src, STR_BUF, 1);
+	for (sa = 0; sa < STR_ALIGN; sa++) {
+		for (da = 0; da < STR_ALIGN; da++) {
+			for (len = 0; len <= STR_LEN; len++) {
+				memset(dst, 0xee, STR_BUF);
+				memset(exp, 0xee, STR_BUF);
+				ref_memmove(exp + da, src + sa, len);
+				ut_asserteq_ptr(dst + da,
+						memcpy(dst + da, src + sa, len));
+				ut_assertok(ref_memcmp(dst, exp, STR_BUF));
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_string_memcpy, 0);
+
+static int lib_test_string_memmove(struct unit_test_state *uts)
+{
+	u8 buf[STR_BUF], exp[STR_BUF];
+	int sa, da, len;
+
+	/* both directions, with every distance up to the length */
+	for (sa = 0; sa < 5 * STR_ALIGN; sa++) {
+		for (da = 0; da < 5 * STR_ALIGN; da++) {
+			for (len = 0; len <= STR_LEN; len++) {
+				str_test_fill(buf, STR_BUF, len);
+				str_test_fill(exp, STR_BUF, len);
+				ref_memmove(exp + da, exp + sa, len);
+				ut_asserteq_ptr(buf + da,
+						memmove(buf + da, buf + sa, len));
+				ut_assertok(ref_memcmp(buf, exp, STR_BUF));
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_string_memmove, 0);
+
+static int lib_test_string_memset(struct unit_test_state *uts)
+{
+	u8 buf[STR_BUF], exp[STR_BUF];
+	int align, len, i;
+	const int c = 0x1a5;	/* only the low byte is used */
+
+	for (align = 0; align < STR_ALIGN; align++) {
+		for (len = 0; len <= STR_LEN; len++) {
+			memset(exp, 0xee, STR_BUF);
+			for (i = 0; i < STR_BUF; i++)
+				buf[i] = 0xee;
+			for (i = 0; i < len; i++)
+				exp[align + i] = (u8)c;
+			ut_asserteq_ptr(buf + align, memset(buf + align, c, len));
+			ut_assertok(ref_memcmp(buf, exp, STR_BUF));
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_string_memset, 0);
+
+static int lib_test_string_memcmp(struct unit_test_state *uts)
+{
+	u8 a[STR_BUF], b[STR_BUF];
+	int aa, ba, len, pos;
+
+	str_test_fill(a, STR_BUF, 2);
+	for (aa = 0; aa < STR_ALIGN; aa++) {
+		for (ba = 0; ba < STR_ALIGN; ba++) {
+			for (len = 0; len <= STR_LEN; len++) {
+				memcpy(b + ba, a + aa, len);
+				ut_asserteq(0, memcmp(a + aa, b + ba, len));
+
+				/* a single difference anywhere, both ways */
+				for (pos = 0; pos < len; pos++) {
+					b[ba + pos] ^= 0x80;
+					ut_asserteq(ref_memcmp(a + aa, b + ba,
+							       len),
+						    memcmp(a + aa, b + ba,
+							   len));
+					ut_asserteq(ref_memcmp(b + ba, a + aa,
+							       len),
+						    memcmp(b + ba, a + aa,
+							   len));
+					b[ba + pos] ^= 0x80;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_string_memcmp, 0);
+
+static int lib_test_string_memchr_inv(struct unit_test_state *uts)
+{
+	u8 buf[STR_BUF];
+	int align, len, pos;
+
+	for (align = 0; align < STR_ALIGN; align++) {
+		for (len = 0; len <= STR_LEN; len++) {
+			memset(buf, 0x5a, STR_BUF);
+			ut_asserteq_ptr(NULL, memchr_inv(buf + align, 0x5a, len));
+			for (pos = 0; pos < len; pos++) {
+				buf[align + pos] = 0;
+				ut_asserteq_ptr(buf + align + pos,
+						memchr_inv(buf + align, 0x5a,
+							   len));
+				buf[align + pos] = 0x5a;
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_string_memchr_inv, 0);
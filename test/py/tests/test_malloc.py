@@ -0,0 +1,67 @@
+# Copyright (c) 2017 U-Boot contributors
+#
+# SPDX-License-Identifier: GPL-2.0
+
+# Check that commands free the memory they allocate, using the malloc trace.
+
+import pytest
+
+# Each command is run twice by 'malloc check', and anything the second run
+# leaves allocated is reported as a leak.
+commands = (
+    'env print',
+    'setenv ut_malloc_var 1; setenv ut_malloc_var',
+    'crc32 0 100',
+    'md 0 10',
+)
+
+def check_leaks(u_boot_console, cmd):
+    """Run a command under 'malloc check' and assert that it does not leak.
+
+    Args:
+        u_boot_console: A U-Boot console.
+        cmd: The command to run, which must not contain a single quote.
+
+    Returns:
+        Nothing.
+    """
+
+    response = u_boot_console.run_command("malloc check '%s'" % cmd)
+    assert 'No leaks' in response, response
+
+@pytest.mark.buildconfigspec('cmd_malloc')
+@pytest.mark.buildconfigspec('malloc_trace')
+@pytest.mark.parametrize('cmd', commands)
+def test_malloc_check(u_boot_console, cmd):
+    """Test that a command does not leak memory."""
+
+    check_leaks(u_boot_console, cmd)
+
+@pytest.mark.buildconfigspec('cmd_malloc')
+@pytest.mark.buildconfigspec('malloc_trace')
+@pytest.mark.buildconfigspec('cmd_usb')
+def test_malloc_check_usb(u_boot_console):
+    """Test that starting and stopping USB does not leak memory."""
+
+    check_leaks(u_boot_console, 'usb start; usb stop')
+
+@pytest.mark.buildconfigspec('cmd_malloc')
+@pytest.mark.buildconfigspec('malloc_trace')
+def test_malloc_scopes(u_boot_console):
+    """Test that heap use is shown for each command that has run."""
+
+    u_boot_console.run_command('crc32 0 100')
+    response = u_boot_console.run_command('malloc scopes')
+    lines = response.splitlines()
+    assert lines[0].split()[0] == 'Scope'
+    names = [line.split()[0] for line in lines[1:] if line.split()]
+    assert 'crc32' in names
+    assert 'total' in names
+
+@pytest.mark.buildconfigspec('cmd_malloc')
+@pytest.mark.buildconfigspec('malloc_trace')
+def test_malloc_check_failure(u_boot_console):
+    """Test that a command which fails is reported, not checked."""
+
+    response = u_boot_console.run_command('malloc check false')
+    assert 'Command failed' in response, response
@@ -32,6 +32,7 @@ struct func_info {
 	const char *name;
 	unsigned long code_size;
 	unsigned long call_count;
+	unsigned long sample_count;	/* number of profile samples */
 	unsigned flags;
 	/* the section this function is in */
 	struct objsection_info *objsection;
@@ -56,6 +57,8 @@ struct func_info *func_list;
 int func_count;
 struct trace_call *call_list;
 int call_count;
+uint32_t *sample_list;
+int sample_count;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -86,6 +89,7 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-profile\t\tList functions by number of samples\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
@@ -227,6 +231,21 @@ static int read_calls(FILE *fin, int count)
 	return 0;
 }
 
+static int read_samples(FILE *fin, int count)
+{
+	notice("sample count: %d\n", count);
+	sample_list = calloc(count, sizeof(*sample_list));
+	if (!sample_list) {
+		error("Cannot allocate sample_list\n");
+		return -1;
+	}
+	sample_count = count;
+	if (!count)
+		return 0;
+
+	return read_data(fin, sample_list, count * sizeof(*sample_list));
+}
+
 static int read_profile(FILE *fin, int *not_found)
 {
 	struct trace_output_hdr hdr;
@@ -250,6 +269,11 @@ static int read_profile(FILE *fin, int *not_found)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -533,6 +557,74 @@ static int make_ftrace(void)
 	return 0;
 }
 
+static int h_cmp_samples(const void *v1, const void *v2)
+{
+	const struct func_info *f1 = *(struct func_info **)v1;
+	const struct func_info *f2 = *(struct func_info **)v2;
+
+	if (f1->sample_count != f2->sample_count)
+		return f1->sample_count < f2->sample_count ? 1 : -1;
+
+	return strcmp(f1->name, f2->name);
+}
+
+/**
+ * make_profile() - List the functions which were sampled most often
+ *
+ * Each sample from the sampling profiler is the offset of the program
+ * counter from the start of the code. This counts the samples in each
+ * function and prints them with the busiest first, e.g.:
+ *
+ * # Samples      %  Function
+ *        812   40.6  memmove
+ *        377   18.8  mem_test_alt
+ */
+static int make_profile(void)
+{
+	struct func_info **sorted, *func;
+	int missing_count = 0;
+	int i, num;
+
+	for (i = 0; i < sample_count; i++) {
+		uint32_t offset = sample_list[i];
+
+		func = func_count ? find_caller_by_offset(offset) : NULL;
+		if (func && func < func_list + func_count - 1 &&
+		    offset >= func[1].offset)
+			func++;
+		if (!func || offset < func->offset) {
+			warn("Cannot find function at %lx\n",
+			     text_offset + offset);
+			missing_count++;
+			continue;
+		}
+		func->sample_count++;
+	}
+
+	sorted = calloc(func_count, sizeof(*sorted));
+	if (!sorted) {
+		error("Cannot allocate function list\n");
+		return -1;
+	}
+	for (i = 0, num = 0; i < func_count; i++) {
+		if (func_list[i].sample_count)
+			sorted[num++] = &func_list[i];
+	}
+	qsort(sorted, num, sizeof(*sorted), h_cmp_samples);
+
+	printf("# Samples      %%  Function\n");
+	for (i = 0; i < num; i++) {
+		func = sorted[i];
+		printf("%9lu %6.1f  %s\n", func->sample_count,
+		       func->sample_count * 100.0 / sample_count, func->name);
+	}
+	free(sorted);
+	info("profile: %d samples, %d not found\n", sample_count,
+	     missing_count);
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -553,6 +645,8 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-profile"))
+			err = make_profile();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}